@@ -129,7 +129,10 @@ ges_audio_test_source_set_freq (GESAudioTestSource * self, gdouble freq)
       ges_track_element_get_element (GES_TRACK_ELEMENT (self));
 
   self->priv->freq = freq;
-  if (element) {
+  /* A released source is instantiated back, or it would get the value it
+   * had when released */
+  if (element ||
+      !_ges_track_element_is_instantiated (GES_TRACK_ELEMENT (self))) {
     GValue val = { 0 };
 
     g_value_init (&val, G_TYPE_DOUBLE);
@@ -153,7 +156,8 @@ ges_audio_test_source_set_volume (GESAudioTestSource * self, gdouble volume)
       ges_track_element_get_element (GES_TRACK_ELEMENT (self));
 
   self->priv->volume = volume;
-  if (element) {
+  if (element ||
+      !_ges_track_element_is_instantiated (GES_TRACK_ELEMENT (self))) {
     GValue val = { 0 };
 
     g_value_init (&val, G_TYPE_DOUBLE);
@@ -53,10 +53,14 @@ ges_audio_uri_source_create_source (GESTrackElement * trksrc)
 
   track = ges_track_element_get_track (trksrc);
 
-  decodebin = gst_element_factory_make ("uridecodebin", NULL);
-
-  g_object_set (decodebin, "caps", ges_track_get_caps (track),
-      "expose-all-streams", FALSE, "uri", self->uri, NULL);
+  /* Same as the video sources, see ges_video_uri_source_create_source */
+  decodebin = _ges_source_take_recycled (GES_SOURCE (trksrc), self->uri);
+  if (decodebin == NULL) {
+    decodebin = gst_element_factory_make ("uridecodebin", NULL);
+    g_object_set (decodebin, "caps", ges_track_get_caps (track),
+        "expose-all-streams", FALSE, "uri", self->uri, NULL);
+  }
+  _ges_source_set_recyclable (GES_SOURCE (trksrc), decodebin, self->uri);
 
   return decodebin;
 }
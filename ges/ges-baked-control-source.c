@@ -0,0 +1,122 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The values of the source are sampled once, at start + i * interval, and
+ * a value is then looked up by indexing the table with the timestamp, which
+ * holds the value of the last sample until the next one. Timestamps before
+ * the first sample or after the last one get the value of the closest one.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#include "ges-baked-control-source.h"
+
+G_DEFINE_TYPE (GESBakedControlSource, ges_baked_control_source,
+    GST_TYPE_CONTROL_SOURCE);
+
+static inline gdouble
+lookup_value (GESBakedControlSource * self, GstClockTime timestamp)
+{
+  guint64 index;
+
+  if (timestamp <= self->start)
+    return self->values[0];
+
+  index = (timestamp - self->start) / self->interval;
+
+  return self->values[MIN (index, self->n_values - 1)];
+}
+
+static gboolean
+get_value (GstControlSource * source, GstClockTime timestamp, gdouble * value)
+{
+  *value = lookup_value (GES_BAKED_CONTROL_SOURCE (source), timestamp);
+
+  return TRUE;
+}
+
+static gboolean
+get_value_array (GstControlSource * source, GstClockTime timestamp,
+    GstClockTime interval, guint n_values, gdouble * values)
+{
+  guint i;
+  GESBakedControlSource *self = GES_BAKED_CONTROL_SOURCE (source);
+
+  for (i = 0; i < n_values; i++) {
+    values[i] = lookup_value (self, timestamp);
+    timestamp += interval;
+  }
+
+  return TRUE;
+}
+
+static void
+ges_baked_control_source_finalize (GObject * object)
+{
+  g_free (GES_BAKED_CONTROL_SOURCE (object)->values);
+
+  G_OBJECT_CLASS (ges_baked_control_source_parent_class)->finalize (object);
+}
+
+static void
+ges_baked_control_source_class_init (GESBakedControlSourceClass * klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = ges_baked_control_source_finalize;
+}
+
+static void
+ges_baked_control_source_init (GESBakedControlSource * self)
+{
+  GstControlSource *source = GST_CONTROL_SOURCE (self);
+
+  source->get_value = get_value;
+  source->get_value_array = get_value_array;
+}
+
+/* Returns: (transfer floating): A control source giving the values @source
+ * had at @n_values timestamps starting at @start and separated by
+ * @interval, or %NULL if @source could not give all of them */
+GstControlSource *
+ges_baked_control_source_new (GstControlSource * source, GstClockTime start,
+    GstClockTime interval, guint n_values)
+{
+  GESBakedControlSource *self;
+
+  g_return_val_if_fail (GST_IS_CONTROL_SOURCE (source), NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (start), NULL);
+  g_return_val_if_fail (interval > 0 && GST_CLOCK_TIME_IS_VALID (interval),
+      NULL);
+  g_return_val_if_fail (n_values > 0, NULL);
+
+  self = g_object_new (GES_TYPE_BAKED_CONTROL_SOURCE, NULL);
+  self->start = start;
+  self->interval = interval;
+  self->n_values = n_values;
+  self->values = g_new (gdouble, n_values);
+
+  if (!gst_control_source_get_value_array (source, start, interval, n_values,
+          self->values)) {
+    gst_object_unref (gst_object_ref_sink (self));
+
+    return NULL;
+  }
+
+  return GST_CONTROL_SOURCE (self);
+}
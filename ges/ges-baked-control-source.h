@@ -0,0 +1,61 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Control source replaying the values another control source had on a
+ * regular grid of timestamps, see ges_track_set_baked_controls.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#ifndef _GES_BAKED_CONTROL_SOURCE_H_
+#define _GES_BAKED_CONTROL_SOURCE_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GES_TYPE_BAKED_CONTROL_SOURCE   (ges_baked_control_source_get_type())
+#define GES_BAKED_CONTROL_SOURCE(obj)   (G_TYPE_CHECK_INSTANCE_CAST((obj),GES_TYPE_BAKED_CONTROL_SOURCE,GESBakedControlSource))
+#define GES_IS_BAKED_CONTROL_SOURCE(obj)   (G_TYPE_CHECK_INSTANCE_TYPE((obj),GES_TYPE_BAKED_CONTROL_SOURCE))
+
+typedef struct _GESBakedControlSource GESBakedControlSource;
+typedef struct _GESBakedControlSourceClass GESBakedControlSourceClass;
+
+struct _GESBakedControlSource
+{
+  GstControlSource parent;
+
+  GstClockTime start;
+  GstClockTime interval;
+  gdouble *values;
+  guint n_values;
+};
+
+struct _GESBakedControlSourceClass
+{
+  GstControlSourceClass parent_class;
+};
+
+G_GNUC_INTERNAL GType              ges_baked_control_source_get_type (void);
+G_GNUC_INTERNAL GstControlSource * ges_baked_control_source_new      (GstControlSource *source,
+                                                                      GstClockTime start,
+                                                                      GstClockTime interval,
+                                                                      guint n_values);
+
+G_END_DECLS
+#endif /* _GES_BAKED_CONTROL_SOURCE_H_ */
@@ -49,6 +49,10 @@ typedef struct PendingBinding
   GstControlSource *source;
   gchar *propname;
   gchar *binding_type;
+
+  GstClockTime *timestamps;
+  gdouble *values;
+  guint n_keyframes;
 } PendingBinding;
 
 typedef struct PendingClip
@@ -519,6 +523,9 @@ _free_pending_binding (PendingBinding * pend)
   g_free (pend->propname);
   g_free (pend->binding_type);
   g_free (pend->track_id);
+  g_free (pend->timestamps);
+  g_free (pend->values);
+  g_slice_free (PendingBinding, pend);
 }
 
 static void
@@ -570,9 +577,12 @@ _add_pending_bindings (GESBaseXmlFormatterPrivate * priv, GList * bindings,
     PendingBinding *pbinding = tmpbinding->data;
     GESTrackElement *element =
         _get_element_by_track_id (priv, pbinding->track_id, clip);
-    if (element)
+    if (element) {
       ges_track_element_set_control_source (element,
           pbinding->source, pbinding->propname, pbinding->binding_type);
+      ges_track_element_set_keyframes (element, pbinding->propname,
+          pbinding->timestamps, pbinding->values, pbinding->n_keyframes);
+    }
   }
 }
 
@@ -960,7 +970,8 @@ void
 ges_base_xml_formatter_add_control_binding (GESBaseXmlFormatter * self,
     const gchar * binding_type, const gchar * source_type,
     const gchar * property_name, gint mode, const gchar * track_id,
-    GSList * timed_values)
+    const GstClockTime * timestamps, const gdouble * values,
+    guint n_keyframes)
 {
   GESBaseXmlFormatterPrivate *priv = _GET_PRIV (self);
   GESTrackElement *element = NULL;
@@ -974,8 +985,10 @@ ges_base_xml_formatter_add_control_binding (GESBaseXmlFormatter * self,
     pbinding = g_slice_new0 (PendingBinding);
     pbinding->source = gst_interpolation_control_source_new ();
     g_object_set (pbinding->source, "mode", mode, NULL);
-    gst_timed_value_control_source_set_from_list (GST_TIMED_VALUE_CONTROL_SOURCE
-        (pbinding->source), timed_values);
+    pbinding->timestamps = g_memdup (timestamps,
+        n_keyframes * sizeof (GstClockTime));
+    pbinding->values = g_memdup (values, n_keyframes * sizeof (gdouble));
+    pbinding->n_keyframes = n_keyframes;
     pbinding->propname = g_strdup (property_name);
     pbinding->binding_type = g_strdup (binding_type);
     pbinding->track_id = g_strdup (track_id);
@@ -1002,8 +1015,8 @@ ges_base_xml_formatter_add_control_binding (GESBaseXmlFormatter * self,
 
     g_object_set (source, "mode", mode, NULL);
 
-    gst_timed_value_control_source_set_from_list (GST_TIMED_VALUE_CONTROL_SOURCE
-        (source), timed_values);
+    ges_track_element_set_keyframes (element, property_name, timestamps,
+        values, n_keyframes);
   } else
     GST_WARNING ("This interpolation type is not supported\n");
 }
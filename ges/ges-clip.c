@@ -92,8 +92,8 @@ _get_priority_range (GESContainer * container, guint32 * min_priority,
   GESLayer *layer = GES_CLIP (container)->priv->layer;
 
   if (layer) {
-    *min_priority = layer->min_gnl_priority;
-    *max_priority = layer->max_gnl_priority;
+    *min_priority = _ges_layer_get_clips_base (layer);
+    *max_priority = *min_priority + LAYER_HEIGHT;
   } else {
     *min_priority = 0;
     *max_priority = G_MAXUINT32;
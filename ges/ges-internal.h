@@ -91,6 +91,10 @@ void
 timeline_remove_group          (GESTimeline *timeline,
                                 GESGroup *group);
 
+G_GNUC_INTERNAL void
+timeline_layer_priority_changed (GESTimeline *timeline,
+                                 GESLayer *layer);
+
 G_GNUC_INTERNAL void
 ges_asset_cache_init (void);
 
@@ -237,7 +241,9 @@ G_GNUC_INTERNAL void ges_base_xml_formatter_add_control_binding (GESBaseXmlForma
                                                                   const gchar * property_name,
                                                                   gint mode,
                                                                   const gchar *track_id,
-                                                                  GSList * timed_values);
+                                                                  const GstClockTime *timestamps,
+                                                                  const gdouble *values,
+                                                                  guint n_keyframes);
 
 G_GNUC_INTERNAL void set_property_foreach                       (GQuark field_id,
                                                                  const GValue * value,
@@ -265,6 +271,13 @@ ges_base_xml_formatter_set_timeline_properties(GESBaseXmlFormatter * self,
 G_GNUC_INTERNAL void _ges_container_sort_children         (GESContainer *container);
 G_GNUC_INTERNAL void _ges_container_sort_children_by_end  (GESContainer *container);
 
+/****************************************************
+ *                  GESLayer                        *
+ ****************************************************/
+G_GNUC_INTERNAL void _ges_layer_set_gnl_priority_base (GESLayer *layer, guint32 base);
+G_GNUC_INTERNAL guint32 _ges_layer_get_clips_base (GESLayer *layer);
+G_GNUC_INTERNAL void _ges_layer_sync_clips_base (GESLayer *layer);
+
 /****************************************************
  *                  GESClip                         *
  ****************************************************/
@@ -282,6 +295,12 @@ GList*            ges_clip_create_track_elements  (GESClip *clip, GESTrackType t
 #define         GNL_OBJECT_TRACK_ELEMENT_QUARK                  (g_quark_from_string ("gnl_object_track_element_quark"))
 G_GNUC_INTERNAL gboolean  ges_track_element_set_track           (GESTrackElement * object, GESTrack * track);
 G_GNUC_INTERNAL guint32   _ges_track_element_get_layer_priority (GESTrackElement * element);
+G_GNUC_INTERNAL gboolean  _ges_track_element_is_instantiated   (GESTrackElement * element);
+G_GNUC_INTERNAL gboolean  _ges_track_element_is_lazy             (GESTrackElement * element);
+G_GNUC_INTERNAL gboolean  _ges_track_element_instantiate        (GESTrackElement * element);
+G_GNUC_INTERNAL gboolean  _ges_track_element_release            (GESTrackElement * element);
+G_GNUC_INTERNAL gboolean  _ges_track_element_bake_controls      (GESTrackElement * element,
+                                                                 GstClockTime interval);
 G_GNUC_INTERNAL void ges_track_element_copy_properties          (GESTimelineElement * element,
                                                                  GESTimelineElement * elementcopy);
 
@@ -289,9 +308,28 @@ G_GNUC_INTERNAL void ges_track_element_split_bindings (GESTrackElement *element,
 						       GESTrackElement *new_element,
 						       guint64 position);
 
+G_GNUC_INTERNAL void ges_track_element_children_props_deinit (void);
+
 G_GNUC_INTERNAL GstElement *ges_source_create_topbin (const gchar * bin_name, GstElement * sub_element, ...);
+G_GNUC_INTERNAL void _ges_source_set_recyclable (GESSource *source, GstElement *element,
+                                                 const gchar *pool_key);
+G_GNUC_INTERNAL void _ges_source_recycle (GESSource *source);
+G_GNUC_INTERNAL GstElement *_ges_source_take_recycled (GESSource *source,
+                                                       const gchar *pool_key);
 
 G_GNUC_INTERNAL void ges_track_set_caps (GESTrack *track, const GstCaps *caps);
+G_GNUC_INTERNAL void ges_track_begin_edit (GESTrack *track);
+G_GNUC_INTERNAL void ges_track_end_edit (GESTrack *track);
+G_GNUC_INTERNAL void ges_track_layer_rebased (GESTrack *track, GESLayer *layer);
+G_GNUC_INTERNAL void ges_track_instantiate_element (GESTrack *track,
+                                                    GESTrackElement *element);
+G_GNUC_INTERNAL void ges_track_pool_source (GESTrack *track, const gchar *pool_key,
+                                            GstElement *element);
+G_GNUC_INTERNAL GstElement *ges_track_take_pooled_source (GESTrack *track,
+                                                          const gchar *pool_key);
+G_GNUC_INTERNAL const GstStructure *ges_track_get_commit_stats (GESTrack *track);
+G_GNUC_INTERNAL void ges_track_invalidate_baked_controls (GESTrack *track,
+                                                         GESTrackElement *element);
 
 
 /*********************************************
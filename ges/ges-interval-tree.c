@@ -0,0 +1,509 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The tree is a treap ordered by (start, data) where each node also keeps
+ * the biggest end of its subtree, so that "what overlaps [a, b]" queries
+ * can prune every subtree that ends before @a, and every right subtree
+ * once we passed @b. Insertion, removal and updates are O(log n) and
+ * queries are O(log n + k), k being the number of reported intervals.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#include "ges-interval-tree.h"
+
+struct _GESIntervalNode
+{
+  gpointer data;
+
+  guint64 start;
+  guint64 end;
+
+  /* Biggest end value in the subtree rooted at that node */
+  guint64 max_end;
+
+  guint32 priority;
+  GESIntervalNode *left;
+  GESIntervalNode *right;
+  GESIntervalNode *parent;
+};
+
+struct _GESIntervalTree
+{
+  GESIntervalNode *root;
+  guint size;
+
+  /* State of the xorshift generator for node priorities */
+  guint32 seed;
+
+  GDestroyNotify data_destroy;
+};
+
+static inline guint32
+next_priority (GESIntervalTree * tree)
+{
+  guint32 x = tree->seed;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+
+  return tree->seed = x;
+}
+
+static inline gint
+node_compare (const GESIntervalNode * a, const GESIntervalNode * b)
+{
+  if (a->start != b->start)
+    return a->start < b->start ? -1 : 1;
+
+  if (a->data != b->data)
+    return (guintptr) a->data < (guintptr) b->data ? -1 : 1;
+
+  return 0;
+}
+
+/* Every change to the children of a node is followed by a call to this
+ * function, which is thus where we keep parent pointers up to date */
+static inline void
+node_update (GESIntervalNode * node)
+{
+  node->max_end = node->end;
+
+  if (node->left) {
+    node->left->parent = node;
+    if (node->left->max_end > node->max_end)
+      node->max_end = node->left->max_end;
+  }
+
+  if (node->right) {
+    node->right->parent = node;
+    if (node->right->max_end > node->max_end)
+      node->max_end = node->right->max_end;
+  }
+}
+
+static inline void
+set_root (GESIntervalTree * tree, GESIntervalNode * root)
+{
+  tree->root = root;
+  if (root)
+    root->parent = NULL;
+}
+
+/* Splits @root in two treaps, @left containing the nodes strictly smaller
+ * than @key and @right all the others */
+static void
+node_split (GESIntervalNode * root, const GESIntervalNode * key,
+    GESIntervalNode ** left, GESIntervalNode ** right)
+{
+  if (root == NULL) {
+    *left = *right = NULL;
+    return;
+  }
+
+  if (node_compare (root, key) < 0) {
+    node_split (root->right, key, &root->right, right);
+    *left = root;
+  } else {
+    node_split (root->left, key, left, &root->left);
+    *right = root;
+  }
+
+  node_update (root);
+}
+
+/* All nodes of @left must be smaller than all nodes of @right */
+static GESIntervalNode *
+node_merge (GESIntervalNode * left, GESIntervalNode * right)
+{
+  if (left == NULL)
+    return right;
+  if (right == NULL)
+    return left;
+
+  if (left->priority > right->priority) {
+    left->right = node_merge (left->right, right);
+    node_update (left);
+
+    return left;
+  }
+
+  right->left = node_merge (left, right->left);
+  node_update (right);
+
+  return right;
+}
+
+static GESIntervalNode *
+node_insert (GESIntervalNode * root, GESIntervalNode * node)
+{
+  if (root == NULL)
+    return node;
+
+  if (node->priority > root->priority) {
+    node_split (root, node, &node->left, &node->right);
+    node_update (node);
+
+    return node;
+  }
+
+  if (node_compare (node, root) < 0)
+    root->left = node_insert (root->left, node);
+  else
+    root->right = node_insert (root->right, node);
+
+  node_update (root);
+
+  return root;
+}
+
+static GESIntervalNode *
+node_remove (GESIntervalNode * root, GESIntervalNode * node)
+{
+  gint cmp;
+
+  if (G_UNLIKELY (root == NULL)) {
+    g_critical ("Interval node %p is not in the tree", node);
+
+    return NULL;
+  }
+
+  cmp = node_compare (node, root);
+  if (cmp == 0)
+    return node_merge (root->left, root->right);
+
+  if (cmp < 0)
+    root->left = node_remove (root->left, node);
+  else
+    root->right = node_remove (root->right, node);
+
+  node_update (root);
+
+  return root;
+}
+
+static void
+node_free_all (GESIntervalNode * node, GDestroyNotify data_destroy)
+{
+  if (node == NULL)
+    return;
+
+  node_free_all (node->left, data_destroy);
+  node_free_all (node->right, data_destroy);
+
+  if (data_destroy)
+    data_destroy (node->data);
+
+  g_slice_free (GESIntervalNode, node);
+}
+
+static gboolean
+node_foreach (GESIntervalNode * node, GESIntervalTreeFunc func,
+    gpointer user_data)
+{
+  if (node == NULL)
+    return TRUE;
+
+  if (!node_foreach (node->left, func, user_data))
+    return FALSE;
+
+  if (!func (node->data, node->start, node->end, user_data))
+    return FALSE;
+
+  return node_foreach (node->right, func, user_data);
+}
+
+static gboolean
+node_foreach_overlapping (GESIntervalNode * node, guint64 start, guint64 end,
+    GESIntervalTreeFunc func, gpointer user_data)
+{
+  /* Nothing in that subtree reaches @start */
+  if (node == NULL || node->max_end < start)
+    return TRUE;
+
+  if (!node_foreach_overlapping (node->left, start, end, func, user_data))
+    return FALSE;
+
+  /* The right subtree only starts later */
+  if (node->start > end)
+    return TRUE;
+
+  if (node->end >= start && !func (node->data, node->start, node->end,
+          user_data))
+    return FALSE;
+
+  return node_foreach_overlapping (node->right, start, end, func, user_data);
+}
+
+/* Returns the first node of the subtree, in start order, ending after
+ * @start, or %NULL */
+static GESIntervalNode *
+node_first_ending_after (GESIntervalNode * node, guint64 start)
+{
+  if (node == NULL || node->max_end < start)
+    return NULL;
+
+  while (TRUE) {
+    if (node->left && node->left->max_end >= start)
+      node = node->left;
+    else if (node->end >= start)
+      return node;
+    else
+      node = node->right;
+  }
+}
+
+static gboolean
+node_foreach_in_range (GESIntervalNode * node, guint64 min_start,
+    guint64 max_start, GESIntervalTreeFunc func, gpointer user_data)
+{
+  if (node == NULL)
+    return TRUE;
+
+  if (node->start >= min_start && !node_foreach_in_range (node->left,
+          min_start, max_start, func, user_data))
+    return FALSE;
+
+  if (node->start > max_start)
+    return TRUE;
+
+  if (node->start >= min_start && !func (node->data, node->start, node->end,
+          user_data))
+    return FALSE;
+
+  return node_foreach_in_range (node->right, min_start, max_start, func,
+      user_data);
+}
+
+/**
+ * ges_interval_tree_new:
+ * @data_destroy: (allow-none): Function called on the data of the nodes
+ * when they are removed from the tree
+ *
+ * Returns: A new empty #GESIntervalTree
+ */
+GESIntervalTree *
+ges_interval_tree_new (GDestroyNotify data_destroy)
+{
+  GESIntervalTree *tree = g_slice_new0 (GESIntervalTree);
+
+  tree->seed = 2463534242U;
+  tree->data_destroy = data_destroy;
+
+  return tree;
+}
+
+void
+ges_interval_tree_free (GESIntervalTree * tree)
+{
+  node_free_all (tree->root, tree->data_destroy);
+  g_slice_free (GESIntervalTree, tree);
+}
+
+guint
+ges_interval_tree_get_size (GESIntervalTree * tree)
+{
+  return tree->size;
+}
+
+/**
+ * ges_interval_tree_insert:
+ * @tree: A #GESIntervalTree
+ * @data: The data to store, a same @data can only be added once
+ * @start: The start of the interval
+ * @end: The end of the interval
+ *
+ * Returns: (transfer none): The node holding @data, which stays valid until
+ * it is removed from @tree
+ */
+GESIntervalNode *
+ges_interval_tree_insert (GESIntervalTree * tree, gpointer data,
+    guint64 start, guint64 end)
+{
+  GESIntervalNode *node = g_slice_new0 (GESIntervalNode);
+
+  node->data = data;
+  node->start = start;
+  node->end = end;
+  node->max_end = end;
+  node->priority = next_priority (tree);
+
+  set_root (tree, node_insert (tree->root, node));
+  tree->size++;
+
+  return node;
+}
+
+void
+ges_interval_tree_remove (GESIntervalTree * tree, GESIntervalNode * node)
+{
+  set_root (tree, node_remove (tree->root, node));
+  tree->size--;
+
+  if (tree->data_destroy)
+    tree->data_destroy (node->data);
+
+  g_slice_free (GESIntervalNode, node);
+}
+
+/**
+ * ges_interval_tree_update:
+ * @tree: A #GESIntervalTree
+ * @node: A #GESIntervalNode of @tree
+ * @start: The new start of the interval
+ * @end: The new end of the interval
+ *
+ * Moves @node to the new interval, @node stays valid.
+ */
+void
+ges_interval_tree_update (GESIntervalTree * tree, GESIntervalNode * node,
+    guint64 start, guint64 end)
+{
+  if (node->start == start && node->end == end)
+    return;
+
+  set_root (tree, node_remove (tree->root, node));
+
+  node->start = start;
+  node->end = end;
+  node->max_end = end;
+  node->left = node->right = NULL;
+
+  set_root (tree, node_insert (tree->root, node));
+}
+
+gpointer
+ges_interval_node_get_data (GESIntervalNode * node)
+{
+  return node->data;
+}
+
+/**
+ * ges_interval_tree_foreach:
+ * @tree: A #GESIntervalTree
+ * @func: The function to call on each interval
+ * @user_data: The data to pass to @func
+ *
+ * Calls @func on every interval of @tree sorted by start.
+ *
+ * Note that @tree must not be modified from within @func.
+ */
+void
+ges_interval_tree_foreach (GESIntervalTree * tree, GESIntervalTreeFunc func,
+    gpointer user_data)
+{
+  node_foreach (tree->root, func, user_data);
+}
+
+/**
+ * ges_interval_tree_foreach_overlapping:
+ * @tree: A #GESIntervalTree
+ * @start: The start of the searched range
+ * @end: The end of the searched range
+ * @func: The function to call on each interval
+ * @user_data: The data to pass to @func
+ *
+ * Calls @func, sorted by start, on every interval touching [@start, @end],
+ * meaning that interval.start <= @end and interval.end >= @start.
+ *
+ * Note that @tree must not be modified from within @func.
+ */
+void
+ges_interval_tree_foreach_overlapping (GESIntervalTree * tree, guint64 start,
+    guint64 end, GESIntervalTreeFunc func, gpointer user_data)
+{
+  node_foreach_overlapping (tree->root, start, end, func, user_data);
+}
+
+/**
+ * ges_interval_tree_foreach_in_range:
+ * @tree: A #GESIntervalTree
+ * @min_start: The minimum start of the intervals
+ * @max_start: The maximum start of the intervals
+ * @func: The function to call on each interval
+ * @user_data: The data to pass to @func
+ *
+ * Calls @func, sorted by start, on every interval starting in
+ * [@min_start, @max_start].
+ *
+ * Note that @tree must not be modified from within @func.
+ */
+void
+ges_interval_tree_foreach_in_range (GESIntervalTree * tree, guint64 min_start,
+    guint64 max_start, GESIntervalTreeFunc func, gpointer user_data)
+{
+  node_foreach_in_range (tree->root, min_start, max_start, func, user_data);
+}
+
+/**
+ * ges_interval_tree_first_overlapping:
+ * @tree: A #GESIntervalTree
+ * @start: The start of the searched range
+ * @end: The end of the searched range
+ *
+ * Together with #ges_interval_node_next_overlapping, this allows walking
+ * the same intervals as #ges_interval_tree_foreach_overlapping one at a
+ * time, without any allocation.
+ *
+ * Returns: (transfer none) (allow-none): The first node, sorted by start,
+ * touching [@start, @end]
+ */
+GESIntervalNode *
+ges_interval_tree_first_overlapping (GESIntervalTree * tree, guint64 start,
+    guint64 end)
+{
+  GESIntervalNode *node = node_first_ending_after (tree->root, start);
+
+  return node && node->start <= end ? node : NULL;
+}
+
+/**
+ * ges_interval_node_next_overlapping:
+ * @node: The last #GESIntervalNode returned for that range
+ * @start: The start of the searched range
+ * @end: The end of the searched range
+ *
+ * Returns: (transfer none) (allow-none): The node touching [@start, @end]
+ * that comes after @node in start order
+ */
+GESIntervalNode *
+ges_interval_node_next_overlapping (GESIntervalNode * node, guint64 start,
+    guint64 end)
+{
+  GESIntervalNode *next = node_first_ending_after (node->right, start);
+
+  /* Go up until we find an ancestor coming after @node, either itself or
+   * a node of its right subtree can be the next one */
+  while (next == NULL && node->parent) {
+    while (node->parent && node->parent->right == node)
+      node = node->parent;
+
+    node = node->parent;
+    if (node == NULL)
+      break;
+
+    if (node->end >= start)
+      next = node;
+    else
+      next = node_first_ending_after (node->right, start);
+  }
+
+  /* Starts only grow from here, so we can stop as soon as we passed @end */
+  return next && next->start <= end ? next : NULL;
+}
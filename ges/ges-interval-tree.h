@@ -0,0 +1,84 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Augmented interval tree used to index timeline elements by their
+ * [start, end] span.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#ifndef _GES_INTERVAL_TREE_H_
+#define _GES_INTERVAL_TREE_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GESIntervalTree GESIntervalTree;
+typedef struct _GESIntervalNode GESIntervalNode;
+
+/**
+ * GESIntervalTreeFunc:
+ * @data: The data stored in the visited node
+ * @start: The start of the visited interval
+ * @end: The end of the visited interval
+ * @user_data: The user data passed to the foreach function
+ *
+ * Returns: %FALSE to stop the iteration, %TRUE to go on
+ */
+typedef gboolean (*GESIntervalTreeFunc) (gpointer data, guint64 start,
+                                         guint64 end, gpointer user_data);
+
+G_GNUC_INTERNAL GESIntervalTree * ges_interval_tree_new             (GDestroyNotify data_destroy);
+G_GNUC_INTERNAL void              ges_interval_tree_free            (GESIntervalTree *tree);
+G_GNUC_INTERNAL guint             ges_interval_tree_get_size        (GESIntervalTree *tree);
+
+G_GNUC_INTERNAL GESIntervalNode * ges_interval_tree_insert          (GESIntervalTree *tree,
+                                                                     gpointer data,
+                                                                     guint64 start,
+                                                                     guint64 end);
+G_GNUC_INTERNAL void              ges_interval_tree_remove          (GESIntervalTree *tree,
+                                                                     GESIntervalNode *node);
+G_GNUC_INTERNAL void              ges_interval_tree_update          (GESIntervalTree *tree,
+                                                                     GESIntervalNode *node,
+                                                                     guint64 start,
+                                                                     guint64 end);
+G_GNUC_INTERNAL gpointer          ges_interval_node_get_data        (GESIntervalNode *node);
+
+G_GNUC_INTERNAL void              ges_interval_tree_foreach         (GESIntervalTree *tree,
+                                                                     GESIntervalTreeFunc func,
+                                                                     gpointer user_data);
+G_GNUC_INTERNAL void              ges_interval_tree_foreach_overlapping (GESIntervalTree *tree,
+                                                                     guint64 start,
+                                                                     guint64 end,
+                                                                     GESIntervalTreeFunc func,
+                                                                     gpointer user_data);
+G_GNUC_INTERNAL void              ges_interval_tree_foreach_in_range (GESIntervalTree *tree,
+                                                                     guint64 min_start,
+                                                                     guint64 max_start,
+                                                                     GESIntervalTreeFunc func,
+                                                                     gpointer user_data);
+G_GNUC_INTERNAL GESIntervalNode * ges_interval_tree_first_overlapping (GESIntervalTree *tree,
+                                                                     guint64 start,
+                                                                     guint64 end);
+G_GNUC_INTERNAL GESIntervalNode * ges_interval_node_next_overlapping (GESIntervalNode *node,
+                                                                     guint64 start,
+                                                                     guint64 end);
+
+G_END_DECLS
+#endif /* _GES_INTERVAL_TREE_H_ */
@@ -0,0 +1,603 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The keyframes are kept in one contiguous array sorted by timestamp, and
+ * the control source only ever contains the slice of it that is inside the
+ * window of the element, plus interpolated keyframes on the edges of the
+ * window when there is no keyframe exactly there.
+ *
+ * Keyframes outside of the window are kept in the store, so trimming an
+ * element and extending it back does not lose them. When the window moves,
+ * the slice is found with two binary searches and only the keyframes that
+ * entered or left it are set or unset in the control source. When the
+ * control source is modified directly, only the slice of the store is
+ * reloaded from it.
+ *
+ * Direct modifications are noticed through the value-added, value-changed
+ * and value-removed signals of the control source, which bump a generation
+ * counter. With a GStreamer that does not have them, only the number of
+ * values of the control source is compared, so values changed in place have
+ * to be set with ges_track_element_set_keyframes to be kept.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#include <string.h>
+#include "ges-keyframe-store.h"
+
+#define MIN_ALLOCATED 16
+
+struct _GESKeyframeStore
+{
+  GESKeyframe *keyframes;
+  guint len;
+  guint allocated;
+
+  /* What was fed to @source: the keyframes in [fed_lo, fed_hi[ plus
+   * interpolated ones at edge_start and edge_end when they are valid */
+  GstTimedValueControlSource *source;
+  gulong signal_ids[3];
+  guint generation, fed_generation;
+  gboolean fed;
+  guint fed_lo, fed_hi;
+  GstClockTime edge_start, edge_end;
+  gdouble edge_start_value, edge_end_value;
+  GstClockTime window_end;
+};
+
+/* Returns the index of the first keyframe whose timestamp is not smaller
+ * than @timestamp, or @len */
+static inline guint
+lower_bound (const GESKeyframe * keyframes, guint len, GstClockTime timestamp)
+{
+  const GESKeyframe *base = keyframes;
+  guint half;
+
+  if (len == 0)
+    return 0;
+
+  while (len > 1) {
+    half = len / 2;
+    base = base[half].timestamp < timestamp ? base + half : base;
+    len -= half;
+  }
+
+  return (base - keyframes) + (base->timestamp < timestamp);
+}
+
+/* Returns the index of the first keyframe whose timestamp is bigger than
+ * @timestamp, or @len */
+static inline guint
+upper_bound (const GESKeyframe * keyframes, guint len, GstClockTime timestamp)
+{
+  guint i = lower_bound (keyframes, len, timestamp);
+
+  return (i < len && keyframes[i].timestamp == timestamp) ? i + 1 : i;
+}
+
+/* Same as the interpolation the track elements always did, linear between
+ * the two keyframes around @position, or extrapolated from the two first or
+ * last ones, and clamped to [0, 1] */
+static gdouble
+interpolate (const GESKeyframe * first, const GESKeyframe * second,
+    GstClockTime position)
+{
+  gdouble diff = second->value - first->value;
+  GstClockTime interval = second->timestamp - first->timestamp;
+  gdouble value;
+
+  if (position > first->timestamp)
+    value = first->value +
+        ((gdouble) (position - first->timestamp) / interval) * diff;
+  else
+    value = first->value -
+        ((gdouble) (first->timestamp - position) / interval) * diff;
+
+  return CLAMP (value, 0.0, 1.0);
+}
+
+static inline guint
+fed_count (GESKeyframeStore * store)
+{
+  return store->fed_hi - store->fed_lo +
+      GST_CLOCK_TIME_IS_VALID (store->edge_start) +
+      GST_CLOCK_TIME_IS_VALID (store->edge_end);
+}
+
+GESKeyframeStore *
+ges_keyframe_store_new (void)
+{
+  GESKeyframeStore *store = g_slice_new0 (GESKeyframeStore);
+
+  store->window_end = GST_CLOCK_TIME_NONE;
+
+  return store;
+}
+
+static void
+source_changed_cb (GstTimedValueControlSource * source, gpointer point,
+    GESKeyframeStore * store)
+{
+  store->generation++;
+}
+
+static void
+unset_source (GESKeyframeStore * store)
+{
+  guint i;
+
+  if (store->source == NULL)
+    return;
+
+  for (i = 0; i < G_N_ELEMENTS (store->signal_ids); i++) {
+    if (store->signal_ids[i])
+      g_signal_handler_disconnect (store->source, store->signal_ids[i]);
+    store->signal_ids[i] = 0;
+  }
+  gst_object_unref (store->source);
+  store->source = NULL;
+}
+
+/* Makes @source the control source @store feeds, and follows its changes
+ * when it has the signals for it */
+static void
+set_source (GESKeyframeStore * store, GstTimedValueControlSource * source)
+{
+  guint i;
+  static const gchar *signals[] =
+      { "value-added", "value-changed", "value-removed" };
+
+  if (store->source == source)
+    return;
+
+  unset_source (store);
+  store->source = gst_object_ref (source);
+  if (!g_signal_lookup (signals[0], G_OBJECT_TYPE (source)))
+    return;
+
+  for (i = 0; i < G_N_ELEMENTS (signals); i++)
+    store->signal_ids[i] = g_signal_connect (source, signals[i],
+        G_CALLBACK (source_changed_cb), store);
+}
+
+/* What @store feeds is now in sync with @source, including the changes it
+ * just made itself */
+static inline void
+set_fed (GESKeyframeStore * store, GstTimedValueControlSource * source)
+{
+  set_source (store, source);
+  store->fed = TRUE;
+  store->fed_generation = store->generation;
+}
+
+void
+ges_keyframe_store_free (GESKeyframeStore * store)
+{
+  unset_source (store);
+  g_free (store->keyframes);
+  g_slice_free (GESKeyframeStore, store);
+}
+
+guint
+ges_keyframe_store_get_size (GESKeyframeStore * store)
+{
+  return store->len;
+}
+
+/**
+ * ges_keyframe_store_get_keyframes:
+ * @store: A #GESKeyframeStore
+ *
+ * Returns: (transfer none): The keyframes sorted by timestamp, valid until
+ * @store is modified
+ */
+const GESKeyframe *
+ges_keyframe_store_get_keyframes (GESKeyframeStore * store)
+{
+  return store->keyframes;
+}
+
+/**
+ * ges_keyframe_store_interpolate:
+ * @store: A non empty #GESKeyframeStore
+ * @position: The position to get a value at
+ *
+ * Returns: The value of the keyframe at @position, or the one interpolated
+ * from the keyframes around it
+ */
+gdouble
+ges_keyframe_store_interpolate (GESKeyframeStore * store,
+    GstClockTime position)
+{
+  guint i;
+  const GESKeyframe *keyframes = store->keyframes;
+
+  g_return_val_if_fail (store->len > 0, 0.0);
+
+  i = lower_bound (keyframes, store->len, position);
+  if (i < store->len && keyframes[i].timestamp == position)
+    return keyframes[i].value;
+
+  if (store->len == 1)
+    return keyframes[0].value;
+
+  if (i == 0)
+    i = 1;
+  else if (i == store->len)
+    i = store->len - 1;
+
+  return interpolate (&keyframes[i - 1], &keyframes[i], position);
+}
+
+/* The control source is fully fed again on next ges_keyframe_store_feed */
+static inline void
+invalidate (GESKeyframeStore * store)
+{
+  store->fed = FALSE;
+}
+
+void
+ges_keyframe_store_set (GESKeyframeStore * store, GstClockTime timestamp,
+    gdouble value)
+{
+  guint i = lower_bound (store->keyframes, store->len, timestamp);
+
+  invalidate (store);
+  if (i < store->len && store->keyframes[i].timestamp == timestamp) {
+    store->keyframes[i].value = value;
+
+    return;
+  }
+
+  if (store->len == store->allocated) {
+    store->allocated = MAX (MIN_ALLOCATED, store->allocated * 2);
+    store->keyframes = g_renew (GESKeyframe, store->keyframes,
+        store->allocated);
+  }
+
+  memmove (store->keyframes + i + 1, store->keyframes + i,
+      (store->len - i) * sizeof (GESKeyframe));
+  store->keyframes[i].timestamp = timestamp;
+  store->keyframes[i].value = value;
+  store->len++;
+}
+
+gboolean
+ges_keyframe_store_unset (GESKeyframeStore * store, GstClockTime timestamp)
+{
+  guint i = lower_bound (store->keyframes, store->len, timestamp);
+
+  if (i == store->len || store->keyframes[i].timestamp != timestamp)
+    return FALSE;
+
+  invalidate (store);
+  memmove (store->keyframes + i, store->keyframes + i + 1,
+      (store->len - i - 1) * sizeof (GESKeyframe));
+  store->len--;
+
+  return TRUE;
+}
+
+void
+ges_keyframe_store_clear (GESKeyframeStore * store)
+{
+  invalidate (store);
+  store->len = 0;
+}
+
+static gint
+compare_keyframes (const GESKeyframe * a, const GESKeyframe * b,
+    gpointer unused G_GNUC_UNUSED)
+{
+  if (a->timestamp < b->timestamp)
+    return -1;
+
+  return a->timestamp > b->timestamp;
+}
+
+/**
+ * ges_keyframe_store_replace:
+ * @store: A #GESKeyframeStore
+ * @timestamps: (array length=n_keyframes): The timestamps of the keyframes
+ * @values: (array length=n_keyframes): The values of the keyframes
+ * @n_keyframes: The number of keyframes
+ *
+ * Replaces all the keyframes of @store at once. The keyframes are only
+ * sorted if they do not come sorted, and when several of them have the same
+ * timestamp, the last one wins as if they had been set one by one.
+ */
+void
+ges_keyframe_store_replace (GESKeyframeStore * store,
+    const GstClockTime * timestamps, const gdouble * values,
+    guint n_keyframes)
+{
+  guint i, j;
+  gboolean sorted = TRUE;
+
+  invalidate (store);
+  if (store->allocated < n_keyframes) {
+    store->allocated = MAX (MIN_ALLOCATED, n_keyframes);
+    store->keyframes = g_renew (GESKeyframe, store->keyframes,
+        store->allocated);
+  }
+
+  for (i = 0; i < n_keyframes; i++) {
+    store->keyframes[i].timestamp = timestamps[i];
+    store->keyframes[i].value = values[i];
+    sorted &= i == 0 || timestamps[i - 1] <= timestamps[i];
+  }
+
+  /* g_qsort_with_data is stable, so the order of the duplicates is kept */
+  if (!sorted)
+    g_qsort_with_data (store->keyframes, n_keyframes, sizeof (GESKeyframe),
+        (GCompareDataFunc) compare_keyframes, NULL);
+
+  for (i = 0, j = 0; i < n_keyframes; i++) {
+    if (j > 0 && store->keyframes[j - 1].timestamp ==
+        store->keyframes[i].timestamp)
+      j--;
+    store->keyframes[j++] = store->keyframes[i];
+  }
+  store->len = j;
+}
+
+/**
+ * ges_keyframe_store_is_fed_to:
+ * @store: A #GESKeyframeStore
+ * @source: A #GstTimedValueControlSource
+ *
+ * This does not look at the values of @source, see the top of the file for
+ * what modifications of @source are noticed.
+ *
+ * Returns: %TRUE if @source still contains what @store last fed it with,
+ * %FALSE if @source was modified behind our back, or if it is not the
+ * source @store feeds.
+ */
+gboolean
+ges_keyframe_store_is_fed_to (GESKeyframeStore * store,
+    GstTimedValueControlSource * source)
+{
+  if (store->source != source)
+    return FALSE;
+
+  if (!store->fed)
+    return TRUE;
+
+  if (store->signal_ids[0])
+    return store->generation == store->fed_generation;
+
+  return gst_timed_value_control_source_get_count (source) ==
+      fed_count (store);
+}
+
+/* Replaces the keyframes of the window @store fed to @source with the
+ * points @source has now, keeping the keyframes outside of the window. The
+ * interpolated edges only become keyframes if their value was changed */
+static void
+merge_window (GESKeyframeStore * store, GList * values)
+{
+  guint i, n = 0;
+  GList *tmp;
+  GstClockTime *timestamps;
+  gdouble *points;
+
+  i = store->len - (store->fed_hi - store->fed_lo) + g_list_length (values);
+  timestamps = g_new (GstClockTime, i);
+  points = g_new (gdouble, i);
+
+  for (i = 0; i < store->len; i++) {
+    if (i == store->fed_lo)
+      i = store->fed_hi;
+    if (i == store->len)
+      break;
+
+    timestamps[n] = store->keyframes[i].timestamp;
+    points[n++] = store->keyframes[i].value;
+  }
+
+  /* After the keyframes of the store, so that they win on equal timestamps */
+  for (tmp = values; tmp; tmp = tmp->next) {
+    GstTimedValue *value = tmp->data;
+
+    if ((value->timestamp == store->edge_start &&
+            value->value == store->edge_start_value) ||
+        (value->timestamp == store->edge_end &&
+            value->value == store->edge_end_value))
+      continue;
+
+    timestamps[n] = value->timestamp;
+    points[n++] = value->value;
+  }
+
+  ges_keyframe_store_replace (store, timestamps, points, n);
+  g_free (timestamps);
+  g_free (points);
+}
+
+/**
+ * ges_keyframe_store_load:
+ * @store: A #GESKeyframeStore
+ * @source: A #GstTimedValueControlSource
+ *
+ * Takes the keyframes of @source, which becomes the source @store feeds.
+ * If @store was feeding @source, only the keyframes of the window it fed
+ * are replaced by the ones of @source, otherwise all the keyframes of
+ * @store are.
+ */
+void
+ges_keyframe_store_load (GESKeyframeStore * store,
+    GstTimedValueControlSource * source)
+{
+  guint i;
+  GList *values, *tmp;
+
+  values = gst_timed_value_control_source_get_all (source);
+
+  if (store->source == source && store->fed) {
+    /* @source is fully fed again on next ges_keyframe_store_feed */
+    merge_window (store, values);
+    g_list_free (values);
+
+    return;
+  }
+
+  store->len = 0;
+  store->allocated = MAX (MIN_ALLOCATED,
+      gst_timed_value_control_source_get_count (source));
+  store->keyframes = g_renew (GESKeyframe, store->keyframes,
+      store->allocated);
+
+  /* The values come sorted */
+  for (tmp = values, i = 0; tmp && i < store->allocated; tmp = tmp->next) {
+    GstTimedValue *value = tmp->data;
+
+    store->keyframes[i].timestamp = value->timestamp;
+    store->keyframes[i++].value = value->value;
+  }
+  store->len = i;
+  g_list_free (values);
+
+  /* @source contains exactly our keyframes */
+  set_fed (store, source);
+  store->fed_lo = 0;
+  store->fed_hi = store->len;
+  store->edge_start = GST_CLOCK_TIME_NONE;
+  store->edge_end = GST_CLOCK_TIME_NONE;
+  store->window_end = GST_CLOCK_TIME_NONE;
+}
+
+static void
+set_range (GESKeyframeStore * store, GstTimedValueControlSource * source,
+    guint from, guint to)
+{
+  for (; from < to; from++)
+    gst_timed_value_control_source_set (source,
+        store->keyframes[from].timestamp, store->keyframes[from].value);
+}
+
+static void
+unset_range (GESKeyframeStore * store, GstTimedValueControlSource * source,
+    guint from, guint to)
+{
+  for (; from < to; from++)
+    gst_timed_value_control_source_unset (source,
+        store->keyframes[from].timestamp);
+}
+
+/**
+ * ges_keyframe_store_feed:
+ * @store: A #GESKeyframeStore
+ * @source: The #GstTimedValueControlSource to feed
+ * @start: The start of the window
+ * @end: The end of the window, #GST_CLOCK_TIME_NONE to keep the one of the
+ * previous feed
+ *
+ * Makes @source contain the keyframes of @store inside [@start, @end], and
+ * interpolated keyframes at @start and @end. If @source was already fed by
+ * @store, only the difference with the previous window is applied.
+ */
+void
+ges_keyframe_store_feed (GESKeyframeStore * store,
+    GstTimedValueControlSource * source, GstClockTime start, GstClockTime end)
+{
+  guint lo, hi;
+  GstClockTime edge_start = GST_CLOCK_TIME_NONE, edge_end = GST_CLOCK_TIME_NONE;
+
+  if (!GST_CLOCK_TIME_IS_VALID (end))
+    end = store->window_end;
+
+  lo = lower_bound (store->keyframes, store->len, start);
+  hi = GST_CLOCK_TIME_IS_VALID (end) ?
+      upper_bound (store->keyframes, store->len, end) : store->len;
+  hi = MAX (lo, hi);
+
+  if (store->len) {
+    if (lo == store->len || store->keyframes[lo].timestamp != start)
+      edge_start = start;
+    if (GST_CLOCK_TIME_IS_VALID (end) && end != start &&
+        (hi == 0 || store->keyframes[hi - 1].timestamp != end))
+      edge_end = end;
+  }
+
+  if (store->fed && store->source == source) {
+    /* Edges first, they never are at the timestamp of a keyframe */
+    if (GST_CLOCK_TIME_IS_VALID (store->edge_start))
+      gst_timed_value_control_source_unset (source, store->edge_start);
+    if (GST_CLOCK_TIME_IS_VALID (store->edge_end))
+      gst_timed_value_control_source_unset (source, store->edge_end);
+
+    /* Then what left the window, and what entered it */
+    unset_range (store, source, store->fed_lo, MIN (store->fed_hi, lo));
+    unset_range (store, source, MAX (store->fed_lo, hi), store->fed_hi);
+    set_range (store, source, lo, MIN (hi, store->fed_lo));
+    set_range (store, source, MAX (lo, store->fed_hi), hi);
+  } else {
+    gst_timed_value_control_source_unset_all (source);
+    set_range (store, source, lo, hi);
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (edge_start)) {
+    store->edge_start_value = ges_keyframe_store_interpolate (store,
+        edge_start);
+    gst_timed_value_control_source_set (source, edge_start,
+        store->edge_start_value);
+  }
+  if (GST_CLOCK_TIME_IS_VALID (edge_end)) {
+    store->edge_end_value = ges_keyframe_store_interpolate (store, edge_end);
+    gst_timed_value_control_source_set (source, edge_end,
+        store->edge_end_value);
+  }
+
+  set_fed (store, source);
+  store->fed_lo = lo;
+  store->fed_hi = hi;
+  store->edge_start = edge_start;
+  store->edge_end = edge_end;
+  store->window_end = end;
+}
+
+/* Gives all the keyframes of @store to @source, until the window of the
+ * element is set on next ges_keyframe_store_feed */
+void
+ges_keyframe_store_feed_all (GESKeyframeStore * store,
+    GstTimedValueControlSource * source)
+{
+  gst_timed_value_control_source_unset_all (source);
+  set_range (store, source, 0, store->len);
+
+  set_fed (store, source);
+  store->fed_lo = 0;
+  store->fed_hi = store->len;
+  store->edge_start = GST_CLOCK_TIME_NONE;
+  store->edge_end = GST_CLOCK_TIME_NONE;
+  store->window_end = GST_CLOCK_TIME_NONE;
+}
+
+/* Empties @source, for elements with an empty window, while keeping all
+ * the keyframes in @store */
+void
+ges_keyframe_store_feed_nothing (GESKeyframeStore * store,
+    GstTimedValueControlSource * source)
+{
+  gst_timed_value_control_source_unset_all (source);
+
+  set_fed (store, source);
+  store->fed_lo = store->fed_hi = 0;
+  store->edge_start = GST_CLOCK_TIME_NONE;
+  store->edge_end = GST_CLOCK_TIME_NONE;
+}
@@ -0,0 +1,75 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Sorted array of the keyframes of a controlled property, from which the
+ * part inside the [inpoint, inpoint + duration] window of a track element
+ * is fed to its control source.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#ifndef _GES_KEYFRAME_STORE_H_
+#define _GES_KEYFRAME_STORE_H_
+
+#include <gst/gst.h>
+#include <gst/controller/gsttimedvaluecontrolsource.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GESKeyframeStore GESKeyframeStore;
+
+typedef struct
+{
+  GstClockTime timestamp;
+  gdouble value;
+} GESKeyframe;
+
+G_GNUC_INTERNAL GESKeyframeStore * ges_keyframe_store_new           (void);
+G_GNUC_INTERNAL void               ges_keyframe_store_free          (GESKeyframeStore *store);
+
+G_GNUC_INTERNAL guint              ges_keyframe_store_get_size      (GESKeyframeStore *store);
+G_GNUC_INTERNAL const GESKeyframe *ges_keyframe_store_get_keyframes (GESKeyframeStore *store);
+G_GNUC_INTERNAL gdouble            ges_keyframe_store_interpolate   (GESKeyframeStore *store,
+                                                                     GstClockTime position);
+
+G_GNUC_INTERNAL void               ges_keyframe_store_set           (GESKeyframeStore *store,
+                                                                     GstClockTime timestamp,
+                                                                     gdouble value);
+G_GNUC_INTERNAL gboolean           ges_keyframe_store_unset         (GESKeyframeStore *store,
+                                                                     GstClockTime timestamp);
+G_GNUC_INTERNAL void               ges_keyframe_store_clear         (GESKeyframeStore *store);
+G_GNUC_INTERNAL void               ges_keyframe_store_replace       (GESKeyframeStore *store,
+                                                                     const GstClockTime *timestamps,
+                                                                     const gdouble *values,
+                                                                     guint n_keyframes);
+
+G_GNUC_INTERNAL gboolean           ges_keyframe_store_is_fed_to     (GESKeyframeStore *store,
+                                                                     GstTimedValueControlSource *source);
+G_GNUC_INTERNAL void               ges_keyframe_store_load          (GESKeyframeStore *store,
+                                                                     GstTimedValueControlSource *source);
+G_GNUC_INTERNAL void               ges_keyframe_store_feed          (GESKeyframeStore *store,
+                                                                     GstTimedValueControlSource *source,
+                                                                     GstClockTime start,
+                                                                     GstClockTime end);
+G_GNUC_INTERNAL void               ges_keyframe_store_feed_nothing  (GESKeyframeStore *store,
+                                                                     GstTimedValueControlSource *source);
+G_GNUC_INTERNAL void               ges_keyframe_store_feed_all      (GESKeyframeStore *store,
+                                                                     GstTimedValueControlSource *source);
+
+G_END_DECLS
+#endif /* _GES_KEYFRAME_STORE_H_ */
@@ -51,6 +51,9 @@ struct _GESLayerPrivate
 
   guint32 priority;             /* The priority of the layer within the
                                  * containing timeline */
+  guint32 clips_base;           /* The gnonlin priority the track elements
+                                 * of the clips are relative to, see
+                                 * _ges_layer_set_gnl_priority_base */
   gboolean auto_transition;
 };
 
@@ -211,6 +214,7 @@ ges_layer_init (GESLayer * self)
   self->priv->auto_transition = FALSE;
   self->min_gnl_priority = MIN_GNL_PRIO;
   self->max_gnl_priority = LAYER_HEIGHT + MIN_GNL_PRIO;
+  self->priv->clips_base = MIN_GNL_PRIO;
 
   _register_metas (self);
 }
@@ -230,6 +234,8 @@ ges_layer_resync_priorities (GESLayer * layer)
 
   GST_DEBUG ("Resync priorities of %p", layer);
 
+  layer->priv->clips_base = layer->min_gnl_priority;
+
   /* TODO : Inhibit composition updates while doing this.
    * Ideally we want to do it from an even higher level, but here will
    * do in the meantime. */
@@ -359,6 +365,58 @@ ges_layer_remove_clip (GESLayer * layer, GESClip * clip)
   return TRUE;
 }
 
+/* Sets the gnonlin priority the priorities of the clips of @layer are
+ * relative to.
+ *
+ * When all the tracks of the timeline use layer compositions, the track
+ * elements of @layer only have to be in order among themselves, so only the
+ * compositions of @layer follow the new base, see ges_track_layer_rebased,
+ * and this does not depend on the number of clips. Otherwise, all the track
+ * elements of @layer are moved, which is linear in its number of clips */
+void
+_ges_layer_set_gnl_priority_base (GESLayer * layer, guint32 base)
+{
+  GList *tmp;
+  gboolean nested = layer->timeline != NULL;
+
+  if (layer->min_gnl_priority == base)
+    return;
+
+  GST_DEBUG_OBJECT (layer, "Base gnonlin priority %u -> %u",
+      layer->min_gnl_priority, base);
+
+  layer->min_gnl_priority = base;
+  layer->max_gnl_priority = base + LAYER_HEIGHT;
+
+  if (layer->timeline) {
+    for (tmp = layer->timeline->tracks; tmp; tmp = tmp->next) {
+      nested &= ges_track_get_layer_compositions (tmp->data);
+      ges_track_layer_rebased (tmp->data, layer);
+    }
+  }
+
+  if (!nested)
+    ges_layer_resync_priorities (layer);
+}
+
+/* Gets the gnonlin priority the track elements of the clips of @layer are
+ * relative to, it lags behind the base of @layer while all the tracks use
+ * layer compositions */
+guint32
+_ges_layer_get_clips_base (GESLayer * layer)
+{
+  return layer->priv->clips_base;
+}
+
+/* Moves the track elements of @layer to its current base if they were left
+ * behind, for when a track does not use layer compositions anymore */
+void
+_ges_layer_sync_clips_base (GESLayer * layer)
+{
+  if (layer->priv->clips_base != layer->min_gnl_priority)
+    ges_layer_resync_priorities (layer);
+}
+
 /**
  * ges_layer_set_priority:
  * @layer: a #GESLayer
@@ -376,10 +434,14 @@ ges_layer_set_priority (GESLayer * layer, guint priority)
 
   if (priority != layer->priv->priority) {
     layer->priv->priority = priority;
-    layer->min_gnl_priority = (priority * LAYER_HEIGHT) + MIN_GNL_PRIO;
-    layer->max_gnl_priority = ((priority + 1) * LAYER_HEIGHT) + MIN_GNL_PRIO;
 
-    ges_layer_resync_priorities (layer);
+    /* In a timeline, the base gnonlin priority of the layer is chosen by
+     * the timeline, and only changes when it is not in order anymore */
+    if (layer->timeline)
+      timeline_layer_priority_changed (layer->timeline, layer);
+    else
+      _ges_layer_set_gnl_priority_base (layer,
+          (priority * LAYER_HEIGHT) + MIN_GNL_PRIO);
   }
 
   g_object_notify (G_OBJECT (layer), "priority");
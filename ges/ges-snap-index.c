@@ -0,0 +1,373 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The edges are kept in one contiguous array of (timecode, data) couples
+ * sorted by timecode, so that looking for the edges around a position is
+ * a binary search followed by a linear walk over neighbouring memory.
+ *
+ * To avoid moving the whole array around on each modification:
+ *  - Added edges are appended at the end of the array and only sorted and
+ *    merged with the rest when the index is queried.
+ *  - Removed edges are only marked as such by setting their data to %NULL,
+ *    and the array is compacted once a quarter of it has been removed.
+ *  - Moved edges are shifted to their new position, which is cheap as edges
+ *    usually only move past a few of their neighbours.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#include <string.h>
+#include "ges-snap-index.h"
+
+#define MIN_ALLOCATED 64
+
+/* When moving more edges than 1/BULK_MOVE_RATIO of the index, we update
+ * them all at once and sort the array again instead of shifting them one
+ * at a time */
+#define BULK_MOVE_RATIO 16
+
+struct _GESSnapIndex
+{
+  GESSnapEdge *edges;
+  guint len;
+  guint allocated;
+
+  /* edges[0, sorted_len[ are sorted, others were added since last query */
+  guint sorted_len;
+
+  /* Number of removed edges that are still in edges[0, sorted_len[ */
+  guint n_removed;
+};
+
+/* Returns the index of the first edge of @edges whose timecode is not
+ * smaller than @timecode, or @len */
+static inline guint
+lower_bound (const GESSnapEdge * edges, guint len, guint64 timecode)
+{
+  const GESSnapEdge *base = edges;
+  guint half;
+
+  if (len == 0)
+    return 0;
+
+  /* The conditional move compiles to a cmov, which avoids branch
+   * mispredictions in this loop */
+  while (len > 1) {
+    half = len / 2;
+    base = base[half].timecode < timecode ? base + half : base;
+    len -= half;
+  }
+
+  return (base - edges) + (base->timecode < timecode);
+}
+
+static gint
+compare_edges (const GESSnapEdge * a, const GESSnapEdge * b,
+    gpointer unused G_GNUC_UNUSED)
+{
+  if (a->timecode < b->timecode)
+    return -1;
+
+  return a->timecode > b->timecode;
+}
+
+static void
+compact (GESSnapIndex * index)
+{
+  guint i, j;
+
+  for (i = 0, j = 0; i < index->sorted_len; i++) {
+    if (index->edges[i].data)
+      index->edges[j++] = index->edges[i];
+  }
+
+  memmove (index->edges + j, index->edges + index->sorted_len,
+      (index->len - index->sorted_len) * sizeof (GESSnapEdge));
+  index->len -= index->sorted_len - j;
+  index->sorted_len = j;
+  index->n_removed = 0;
+}
+
+/* Sorts the edges added since last time and merges them with the others */
+static void
+ensure_sorted (GESSnapIndex * index)
+{
+  GESSnapEdge *added;
+  guint n_added = index->len - index->sorted_len;
+  gint i, j, k;
+
+  if (n_added == 0)
+    return;
+
+  if (index->n_removed)
+    compact (index);
+
+  g_qsort_with_data (index->edges + index->sorted_len, n_added,
+      sizeof (GESSnapEdge), (GCompareDataFunc) compare_edges, NULL);
+
+  /* Merge starting from the end, so that only the added edges need to
+   * be copied aside */
+  added = g_memdup (index->edges + index->sorted_len,
+      n_added * sizeof (GESSnapEdge));
+  i = index->sorted_len - 1;
+  j = n_added - 1;
+  for (k = index->len - 1; j >= 0; k--) {
+    if (i >= 0 && index->edges[i].timecode > added[j].timecode)
+      index->edges[k] = index->edges[i--];
+    else
+      index->edges[k] = added[j--];
+  }
+  g_free (added);
+
+  index->sorted_len = index->len;
+}
+
+/* Returns the position of the edge (@data, @timecode) in the sorted array */
+static gint
+find_edge (GESSnapIndex * index, gpointer data, guint64 timecode)
+{
+  guint i;
+
+  ensure_sorted (index);
+
+  for (i = lower_bound (index->edges, index->len, timecode);
+      i < index->len && index->edges[i].timecode == timecode; i++) {
+    if (index->edges[i].data == data)
+      return i;
+  }
+
+  g_critical ("Edge %p at %" G_GUINT64_FORMAT " is not in the snap index",
+      data, timecode);
+
+  return -1;
+}
+
+/* Moves the edge at @i, whose timecode changed, to its sorted place */
+static void
+shift_edge (GESSnapIndex * index, guint i)
+{
+  guint target;
+  GESSnapEdge edge = index->edges[i];
+
+  if (i > 0 && index->edges[i - 1].timecode > edge.timecode) {
+    target = lower_bound (index->edges, i, edge.timecode);
+    memmove (index->edges + target + 1, index->edges + target,
+        (i - target) * sizeof (GESSnapEdge));
+    index->edges[target] = edge;
+  } else if (i + 1 < index->len &&
+      index->edges[i + 1].timecode < edge.timecode) {
+    target = i + 1 + lower_bound (index->edges + i + 1, index->len - i - 1,
+        edge.timecode);
+    memmove (index->edges + i, index->edges + i + 1,
+        (target - i - 1) * sizeof (GESSnapEdge));
+    index->edges[target - 1] = edge;
+  }
+}
+
+/* Never keep removed edges at the end of the sorted array, so that the last
+ * edge always is the biggest timecode */
+static void
+pop_removed (GESSnapIndex * index)
+{
+  if (index->sorted_len != index->len)
+    return;
+
+  while (index->len && index->edges[index->len - 1].data == NULL) {
+    index->len--;
+    index->n_removed--;
+  }
+  index->sorted_len = index->len;
+}
+
+GESSnapIndex *
+ges_snap_index_new (void)
+{
+  return g_slice_new0 (GESSnapIndex);
+}
+
+void
+ges_snap_index_free (GESSnapIndex * index)
+{
+  g_free (index->edges);
+  g_slice_free (GESSnapIndex, index);
+}
+
+/**
+ * ges_snap_index_get_size:
+ * @index: A #GESSnapIndex
+ *
+ * Returns: The number of edges returned by #ges_snap_index_get_edges
+ */
+guint
+ges_snap_index_get_size (GESSnapIndex * index)
+{
+  ensure_sorted (index);
+
+  return index->len;
+}
+
+/**
+ * ges_snap_index_get_edges:
+ * @index: A #GESSnapIndex
+ *
+ * Returns: (transfer none): The edges sorted by timecode, valid until @index
+ * is modified. Edges that have been removed but are still in the array have
+ * a %NULL data and must be skipped.
+ */
+const GESSnapEdge *
+ges_snap_index_get_edges (GESSnapIndex * index)
+{
+  ensure_sorted (index);
+
+  return index->edges;
+}
+
+/**
+ * ges_snap_index_lower_bound:
+ * @index: A #GESSnapIndex
+ * @timecode: The timecode to look for
+ *
+ * Returns: The position, in the array returned by #ges_snap_index_get_edges,
+ * of the first edge whose timecode is not smaller than @timecode
+ */
+guint
+ges_snap_index_lower_bound (GESSnapIndex * index, guint64 timecode)
+{
+  ensure_sorted (index);
+
+  return lower_bound (index->edges, index->len, timecode);
+}
+
+void
+ges_snap_index_add (GESSnapIndex * index, gpointer data, guint64 timecode)
+{
+  g_return_if_fail (data != NULL);
+
+  if (index->len == index->allocated) {
+    index->allocated = MAX (MIN_ALLOCATED, index->allocated * 2);
+    index->edges = g_renew (GESSnapEdge, index->edges, index->allocated);
+  }
+
+  index->edges[index->len].timecode = timecode;
+  index->edges[index->len].data = data;
+  index->len++;
+
+  /* Keep the array sorted when we can do it for free */
+  if (index->sorted_len == index->len - 1 && (index->sorted_len == 0 ||
+          index->edges[index->sorted_len - 1].timecode <= timecode))
+    index->sorted_len = index->len;
+}
+
+void
+ges_snap_index_remove (GESSnapIndex * index, gpointer data, guint64 timecode)
+{
+  gint i = find_edge (index, data, timecode);
+
+  if (G_UNLIKELY (i < 0))
+    return;
+
+  index->edges[i].data = NULL;
+  index->n_removed++;
+  pop_removed (index);
+
+  if (index->n_removed > index->len / 4)
+    compact (index);
+}
+
+void
+ges_snap_index_move (GESSnapIndex * index, gpointer data,
+    guint64 old_timecode, guint64 new_timecode)
+{
+  gint i;
+
+  if (old_timecode == new_timecode)
+    return;
+
+  i = find_edge (index, data, old_timecode);
+  if (G_UNLIKELY (i < 0))
+    return;
+
+  index->edges[i].timecode = new_timecode;
+  shift_edge (index, i);
+  pop_removed (index);
+}
+
+/**
+ * ges_snap_index_move_many:
+ * @index: A #GESSnapIndex
+ * @moves: (array length=n_moves): The edges to move
+ * @n_moves: The number of edges to move
+ *
+ * Moves all the edges at once, this is a lot faster than calling
+ * #ges_snap_index_move for each of them when moving a big part of the
+ * index. Each edge must only be moved once.
+ */
+void
+ges_snap_index_move_many (GESSnapIndex * index, const GESSnapMove * moves,
+    guint n_moves)
+{
+  guint i, j;
+  guint8 *moved;
+  gint *positions;
+
+  ensure_sorted (index);
+
+  if (n_moves * BULK_MOVE_RATIO < index->len) {
+    for (i = 0; i < n_moves; i++)
+      ges_snap_index_move (index, moves[i].data, moves[i].old_timecode,
+          moves[i].new_timecode);
+
+    return;
+  }
+
+  /* Look for all the edges while the array is still sorted, an element
+   * can have several edges at the same timecode so we need to remember
+   * which ones we already found */
+  moved = g_malloc0 (index->len);
+  positions = g_new (gint, n_moves);
+  for (i = 0; i < n_moves; i++) {
+    positions[i] = -1;
+
+    for (j = lower_bound (index->edges, index->len, moves[i].old_timecode);
+        j < index->len && index->edges[j].timecode == moves[i].old_timecode;
+        j++) {
+      if (index->edges[j].data == moves[i].data && !moved[j]) {
+        moved[j] = TRUE;
+        positions[i] = j;
+        break;
+      }
+    }
+
+    if (G_UNLIKELY (positions[i] < 0))
+      g_critical ("Edge %p at %" G_GUINT64_FORMAT " is not in the snap index",
+          moves[i].data, moves[i].old_timecode);
+  }
+
+  for (i = 0; i < n_moves; i++) {
+    if (positions[i] >= 0)
+      index->edges[positions[i]].timecode = moves[i].new_timecode;
+  }
+  g_free (positions);
+  g_free (moved);
+
+  if (index->n_removed)
+    compact (index);
+
+  g_qsort_with_data (index->edges, index->len, sizeof (GESSnapEdge),
+      (GCompareDataFunc) compare_edges, NULL);
+}
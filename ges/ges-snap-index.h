@@ -0,0 +1,70 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Sorted array of the edges (starts and ends) the timeline elements can be
+ * snapped on.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#ifndef _GES_SNAP_INDEX_H_
+#define _GES_SNAP_INDEX_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GESSnapIndex GESSnapIndex;
+
+typedef struct
+{
+  guint64 timecode;
+  gpointer data;
+} GESSnapEdge;
+
+typedef struct
+{
+  gpointer data;
+  guint64 old_timecode;
+  guint64 new_timecode;
+} GESSnapMove;
+
+G_GNUC_INTERNAL GESSnapIndex *     ges_snap_index_new         (void);
+G_GNUC_INTERNAL void               ges_snap_index_free        (GESSnapIndex *index);
+
+G_GNUC_INTERNAL guint              ges_snap_index_get_size    (GESSnapIndex *index);
+G_GNUC_INTERNAL const GESSnapEdge *ges_snap_index_get_edges   (GESSnapIndex *index);
+G_GNUC_INTERNAL guint              ges_snap_index_lower_bound (GESSnapIndex *index,
+                                                               guint64 timecode);
+
+G_GNUC_INTERNAL void               ges_snap_index_add         (GESSnapIndex *index,
+                                                               gpointer data,
+                                                               guint64 timecode);
+G_GNUC_INTERNAL void               ges_snap_index_remove      (GESSnapIndex *index,
+                                                               gpointer data,
+                                                               guint64 timecode);
+G_GNUC_INTERNAL void               ges_snap_index_move        (GESSnapIndex *index,
+                                                               gpointer data,
+                                                               guint64 old_timecode,
+                                                               guint64 new_timecode);
+G_GNUC_INTERNAL void               ges_snap_index_move_many   (GESSnapIndex *index,
+                                                               const GESSnapMove *moves,
+                                                               guint n_moves);
+
+G_END_DECLS
+#endif /* _GES_SNAP_INDEX_H_ */
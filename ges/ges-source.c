@@ -36,8 +36,16 @@ struct _GESSourcePrivate
 {
   /*  Dummy variable */
   GstFramePositionner *positionner;
+
+  /* Element of our content that goes back to the source pool of the track
+   * when the content is released, see _ges_source_set_recyclable */
+  GstElement *recyclable;
+  gchar *pool_key;
 };
 
+/* Blocking probe of a source pad of a pooled element, on the pad */
+#define POOL_BLOCK_QUARK (g_quark_from_static_string ("ges-pool-block"))
+
 /******************************
  *   Internal helper methods  *
  ******************************/
@@ -87,6 +95,14 @@ ges_source_create_topbin (const gchar * bin_name, GstElement * sub_element, ...)
 
   sub_srcpad = gst_element_get_static_pad (sub_element, "src");
 
+  /* A recycled element already has its dynamic pad */
+  if (sub_srcpad == NULL) {
+    GST_OBJECT_LOCK (sub_element);
+    if (sub_element->srcpads)
+      sub_srcpad = gst_object_ref (sub_element->srcpads->data);
+    GST_OBJECT_UNLOCK (sub_element);
+  }
+
   if (prev != NULL) {
     GstPad *srcpad, *sinkpad, *ghost;
 
@@ -122,13 +138,203 @@ ges_source_create_topbin (const gchar * bin_name, GstElement * sub_element, ...)
   return bin;
 }
 
+/* Sets the element created by create_source that can be reused by the
+ * next source of our track with the same @pool_key once our content is
+ * released */
+void
+_ges_source_set_recyclable (GESSource * source, GstElement * element,
+    const gchar * pool_key)
+{
+  GESSourcePrivate *priv = source->priv;
+
+  if (priv->recyclable)
+    gst_object_unref (priv->recyclable);
+  g_free (priv->pool_key);
+
+  priv->recyclable = gst_object_ref (element);
+  priv->pool_key = g_strdup (pool_key);
+}
+
+/* Returns: (transfer full): The source pads of @element */
+static GList *
+get_src_pads (GstElement * element)
+{
+  GList *pads;
+
+  GST_OBJECT_LOCK (element);
+  pads = g_list_copy (element->srcpads);
+  g_list_foreach (pads, (GFunc) gst_object_ref, NULL);
+  GST_OBJECT_UNLOCK (element);
+
+  return pads;
+}
+
+static GstPadProbeReturn
+pool_block_cb (GstPad * pad, GstPadProbeInfo * info, gpointer unused)
+{
+  return GST_PAD_PROBE_OK;
+}
+
+/* The data of a pooled element stops at its source pads, so that it stays
+ * prerolled without being linked */
+static void
+block_pooled_pad (GstElement * element, GstPad * pad)
+{
+  gulong probe;
+
+  if (GST_PAD_DIRECTION (pad) != GST_PAD_SRC ||
+      g_object_get_qdata (G_OBJECT (pad), POOL_BLOCK_QUARK))
+    return;
+
+  probe = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM,
+      pool_block_cb, NULL, NULL);
+  g_object_set_qdata (G_OBJECT (pad), POOL_BLOCK_QUARK,
+      GUINT_TO_POINTER (probe));
+}
+
+/* The composition seeks the content of the source when activating it,
+ * the recycled element then runs along with the rest of the content */
+static GstPadProbeReturn
+recycled_seek_cb (GstPad * pad, GstPadProbeInfo * info, GstElement * element)
+{
+  gulong probe;
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_SEEK)
+    return GST_PAD_PROBE_OK;
+
+  probe = GPOINTER_TO_UINT (g_object_steal_qdata (G_OBJECT (pad),
+          POOL_BLOCK_QUARK));
+  if (probe)
+    gst_pad_remove_probe (pad, probe);
+
+  gst_element_set_locked_state (element, FALSE);
+  gst_element_sync_state_with_parent (element);
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+/* Takes the recyclable element out of our content, which is being
+ * released, and gives it to the source pool of our track. It is kept
+ * prerolled, its source pads being blocked */
+void
+_ges_source_recycle (GESSource * source)
+{
+  GList *pads, *tmp;
+  GstObject *parent;
+  GESSourcePrivate *priv = source->priv;
+  GstElement *element = priv->recyclable;
+  GESTrack *track = ges_track_element_get_track (GES_TRACK_ELEMENT (source));
+
+  if (element == NULL)
+    return;
+
+  priv->recyclable = NULL;
+  if (track == NULL) {
+    gst_object_unref (element);
+
+    return;
+  }
+
+  g_signal_handlers_disconnect_matched (element, G_SIGNAL_MATCH_FUNC, 0, 0,
+      NULL, _pad_added_cb, NULL);
+  g_signal_handlers_disconnect_matched (element, G_SIGNAL_MATCH_FUNC, 0, 0,
+      NULL, _ghost_pad_added_cb, NULL);
+  g_signal_connect (element, "pad-added", G_CALLBACK (block_pooled_pad),
+      NULL);
+
+  /* Its state is not changed with the rest of the content anymore */
+  gst_element_set_locked_state (element, TRUE);
+
+  pads = get_src_pads (element);
+  for (tmp = pads; tmp; tmp = tmp->next) {
+    GstPad *peer = gst_pad_get_peer (tmp->data);
+
+    block_pooled_pad (element, tmp->data);
+    if (peer) {
+      gst_pad_unlink (tmp->data, peer);
+      gst_object_unref (peer);
+    }
+  }
+  g_list_free_full (pads, gst_object_unref);
+
+  parent = gst_object_get_parent (GST_OBJECT (element));
+  if (parent) {
+    gst_bin_remove (GST_BIN (parent), element);
+    gst_object_unref (parent);
+  }
+
+  /* An element that was not activated yet gets prerolled in the pool */
+  gst_element_set_state (element, GST_STATE_PAUSED);
+
+  ges_track_pool_source (track, priv->pool_key, element);
+}
+
+/* Returns: (transfer floating): An element of a released source of our
+ * track with the same @pool_key, or %NULL. It is reset to our in-point with
+ * a flushing seek, and stays blocked until the composition activates us */
+GstElement *
+_ges_source_take_recycled (GESSource * source, const gchar * pool_key)
+{
+  GList *pads, *tmp;
+  GstElement *element;
+  GESTrack *track = ges_track_element_get_track (GES_TRACK_ELEMENT (source));
+
+  if (track == NULL ||
+      (element = ges_track_take_pooled_source (track, pool_key)) == NULL)
+    return NULL;
+
+  g_signal_handlers_disconnect_by_func (element, block_pooled_pad, NULL);
+
+  if (!gst_element_seek (element, 1.0, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, GST_SEEK_TYPE_SET,
+          _INPOINT (source), GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE))
+    GST_WARNING_OBJECT (source, "Could not reset %" GST_PTR_FORMAT, element);
+
+  /* Without any pad yet, it is linked when it gets one like a new element */
+  pads = get_src_pads (element);
+  if (pads == NULL)
+    gst_element_set_locked_state (element, FALSE);
+  for (tmp = pads; tmp; tmp = tmp->next)
+    gst_pad_add_probe (tmp->data, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+        (GstPadProbeCallback) recycled_seek_cb, element, NULL);
+  g_list_free_full (pads, gst_object_unref);
+
+  return element;
+}
+
+static void
+ges_source_dispose (GObject * object)
+{
+  GESSourcePrivate *priv = GES_SOURCE (object)->priv;
+
+  if (priv->recyclable) {
+    gst_object_unref (priv->recyclable);
+    priv->recyclable = NULL;
+  }
+
+  G_OBJECT_CLASS (ges_source_parent_class)->dispose (object);
+}
+
+static void
+ges_source_finalize (GObject * object)
+{
+  g_free (GES_SOURCE (object)->priv->pool_key);
+
+  G_OBJECT_CLASS (ges_source_parent_class)->finalize (object);
+}
+
 static void
 ges_source_class_init (GESSourceClass * klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GESTrackElementClass *track_class = GES_TRACK_ELEMENT_CLASS (klass);
 
   g_type_class_add_private (klass, sizeof (GESSourcePrivate));
 
+  object_class->dispose = ges_source_dispose;
+  object_class->finalize = ges_source_finalize;
+
   track_class->gnlobject_factorytype = "gnlsource";
   track_class->create_element = NULL;
 }
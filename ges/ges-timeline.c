@@ -40,6 +40,8 @@
  * into account until you call the #ges_timeline_commit method.
  */
 
+#include <string.h>
+
 #include "ges-internal.h"
 #include "ges-project.h"
 #include "ges-container.h"
@@ -47,6 +49,8 @@
 #include "ges-track.h"
 #include "ges-layer.h"
 #include "ges-auto-transition.h"
+#include "ges-interval-tree.h"
+#include "ges-snap-index.h"
 #include "ges.h"
 
 typedef struct _MoveContext MoveContext;
@@ -54,6 +58,8 @@ typedef struct _MoveContext MoveContext;
 static GPtrArray *select_tracks_for_object_default (GESTimeline * timeline,
     GESClip * clip, GESTrackElement * tr_obj, gpointer user_data);
 static inline void init_movecontext (MoveContext * mv_ctx, gboolean first_init);
+static inline void clear_movecontext (MoveContext * mv_ctx);
+static GESTimelineSnapshot *timeline_build_snapshot (GESTimeline * timeline);
 static void ges_extractable_interface_init (GESExtractableInterface * iface);
 static void ges_meta_container_interface_init
     (GESMetaContainerInterface * iface);
@@ -86,12 +92,20 @@ GST_DEBUG_CATEGORY_STATIC (ges_timeline_debug);
         g_thread_self());         \
   } G_STMT_END
 
+/* Layers get their base gnonlin priority in a sparse space, LAYER_SPACING
+ * apart, so that changing the priority of a layer or inserting one does
+ * not move the clips of all the following layers. The last LAYER_HEIGHTs
+ * are kept for the background of the tracks. */
+#define LAYER_SPACING (LAYER_HEIGHT * 64)
+#define MAX_LAYER_BASE ((guint64) G_MAXUINT32 - 2 * LAYER_HEIGHT)
+
 typedef struct TrackObjIters
 {
-  GSequenceIter *iter_start;
-  GSequenceIter *iter_end;
-  GSequenceIter *iter_obj;
-  GSequenceIter *iter_by_layer;
+  /* The start and end of the Source as in the snap index */
+  guint64 start_tc;
+  guint64 end_tc;
+  GESIntervalNode *node_obj;
+  GESIntervalNode *node_by_layer;
 
   GESLayer *layer;
   GESTrackElement *trackelement;
@@ -103,6 +117,35 @@ _destroy_obj_iters (TrackObjIters * iters)
   g_slice_free (TrackObjIters, iters);
 }
 
+typedef struct ClipIters
+{
+  /* The clips_by_layer tree of the layer of the Clip */
+  GESIntervalTree *tree;
+  GESIntervalNode *node;
+} ClipIters;
+
+static void
+_destroy_clip_iters (ClipIters * iters)
+{
+  ges_interval_tree_remove (iters->tree, iters->node);
+  g_slice_free (ClipIters, iters);
+}
+
+/* What a GESTimelineRangeIter really contains */
+typedef struct
+{
+  GESTimeline *timeline;
+  GESIntervalNode *node;
+  guint64 start;
+  guint64 end;
+  /* Indexes in layers_by_prio of the next layer and of the one after the
+   * last layer */
+  guint layer;
+  guint layer_end;
+} RealRangeIter;
+
+G_STATIC_ASSERT (sizeof (RealRangeIter) <= sizeof (GESTimelineRangeIter));
+
 /*  The move context is used for the timeline editing modes functions in order to
  *  + Ripple / Roll /  Slide / Move / Trim
  *
@@ -117,6 +160,8 @@ struct _MoveContext
 
   /* Ripple and Roll Objects */
   GList *moving_trackelements;
+  /* The same objects, as a set for fast lookups */
+  GHashTable *moving_set;
 
   /* We use it as a set of Clip to move between layers */
   GHashTable *toplevel_containers;
@@ -127,17 +172,24 @@ struct _MoveContext
 
   /* Never trim so duration would becomes < 0 */
   guint64 max_trim_pos;
-
-  /* fields to force/avoid new context */
-  /* Set to %TRUE when the track is doing updates of track element
-   * properties so we don't end up always needing new move context */
-  gboolean ignore_needs_ctx;
+  /* Set when moving track elements moved and max_trim_pos has to be
+   * computed again */
+  gboolean needs_max_trim_pos;
+
+  /* The Source from which edge moving_trackelements have been collected,
+   * and the position of that edge. The context stays valid as long as no
+   * Source goes from one side of that edge to the other, see
+   * move_context_source_moved */
+  GESTrackElement *editor;
+  guint64 editor_edge;
+
+  /* Set when the context has to be computed again */
   gboolean needs_move_ctx;
 
   /* Last snapping  properties */
   GESTrackElement *last_snaped1;
   GESTrackElement *last_snaped2;
-  GstClockTime *last_snap_ts;
+  GstClockTime last_snap_ts;
 };
 
 struct _GESTimelinePrivate
@@ -156,19 +208,24 @@ struct _GESTimelinePrivate
    * be tracked? */
 
   /* Snapping fields */
-  GHashTable *by_start;         /* {Source: start} */
-  GHashTable *by_end;           /* {Source: end} */
-  GHashTable *by_object;        /* {timecode: Source} */
   GHashTable *obj_iters;        /* {Source: TrackObjIters} */
-  GSequence *starts_ends;       /* Sorted list of starts/ends */
+  GESSnapIndex *snap_index;     /* Starts and ends of the Source-s */
   /* We keep 1 reference to our trackelement here */
-  GSequence *tracksources;      /* Source-s sorted by start/priorities */
+  GESIntervalTree *tracksources;        /* Source-s indexed by [start, end] */
+
+  /* The layers sorted by priority, when the layers have priorities 0 to
+   * n - 1, which is the usual case, the layer of priority i is at index i */
+  GPtrArray *layers_by_prio;
 
   GRecMutex dyn_mutex;
   GList *priv_tracks;
   /* FIXME: We should definitly offer an API over this,
    * probably through a ges_layer_get_track_elements () method */
-  GHashTable *by_layer;         /* {layer: GSequence of TrackElement by start/priorities} */
+  GHashTable *by_layer;         /* {layer: GESIntervalTree of TrackElement} */
+
+  /* Range queries */
+  GHashTable *clips_by_layer;   /* {layer: GESIntervalTree of Clip} */
+  GHashTable *clip_iters;       /* {Clip: ClipIters} */
 
   /* The set of auto_transitions we control, currently the key is
    * pointerToPreviousiTrackObjAdresspointerToNextTrackObjAdress as a string,
@@ -181,12 +238,60 @@ struct _GESTimelinePrivate
    * and %FALSE otherwize */
   gboolean needs_transitions_update;
 
+  /* Sources that moved while @needs_transitions_update was %FALSE, their
+   * transitions will be updated on next commit */
+  GHashTable *transitions_dirty;        /* {Source: Source} */
+
+  /* Edit transactions, see ges_timeline_begin_edit */
+  guint edit_depth;
+  /* TrackElement-s that moved since the transaction started and that still
+   * need to be updated in our indexes */
+  GHashTable *pending_indexes;  /* {TrackElement: TrackElement} */
+  /* Sources that need their transitions updated when the transaction ends */
+  GHashTable *pending_transitions;      /* {Source: Source} */
+
   /* While we are creating and adding the TrackElements for a clip, we need to
    * ignore the child-added signal */
   GESClip *ignore_track_element_added;
   GList *groups;
 
   guint group_id;
+
+  /* Read-only snapshots, see ges_timeline_acquire_snapshot. They are only
+   * built and replaced from the thread committing the timeline, and read
+   * from any thread without locking */
+  GESTimelineSnapshot *snapshot;        /* atomic */
+  /* The number of threads between reading @snapshot and referencing it */
+  gint snapshot_readers;        /* atomic */
+  /* Replaced snapshots that might still be about to be referenced */
+  GSList *retired_snapshots;
+  /* Whether @snapshot is older than the last commit */
+  gboolean snapshot_dirty;
+  /* Whether snapshots were acquired from another thread than the one
+   * committing, they then have to be built on commit */
+  gint snapshot_shared;         /* atomic */
+  GThread *commit_thread;       /* atomic */
+  guint64 snapshot_version;
+
+  /* Asynchronous commits, see ges_timeline_commit_async */
+  GList *pending_commits;       /* GSimpleAsyncResult-s */
+  GSource *commit_source;
+};
+
+struct _GESTimelineSnapshot
+{
+  gint ref_count;
+  guint64 version;
+  /* Whether the timeline was committed since */
+  gint outdated;                /* atomic */
+  GstClockTime duration;
+
+  GESTimelineSnapshotLayer *layers;
+  guint n_layers;
+  GESTimelineSnapshotClip *clips;
+  guint n_clips;
+  GESTimelineSnapshotElement *elements;
+  guint n_elements;
 };
 
 /* private structure to contain our track-related information */
@@ -223,6 +328,7 @@ enum
   SNAPING_ENDED,
   SELECT_TRACKS_FOR_OBJECT,
   COMMITED,
+  COMMIT_STATS,
   LAST_SIGNAL
 };
 
@@ -337,15 +443,17 @@ ges_timeline_dispose (GObject * object)
     g_list_free_full (ges_container_ungroup (priv->groups->data, FALSE),
         gst_object_unref);
 
-  g_hash_table_unref (priv->by_start);
-  g_hash_table_unref (priv->by_end);
-  g_hash_table_unref (priv->by_object);
+  g_ptr_array_unref (priv->layers_by_prio);
   g_hash_table_unref (priv->by_layer);
+  g_hash_table_unref (priv->clip_iters);
+  g_hash_table_unref (priv->clips_by_layer);
   g_hash_table_unref (priv->obj_iters);
-  g_sequence_free (priv->starts_ends);
-  g_sequence_free (priv->tracksources);
-  g_list_free (priv->movecontext.moving_trackelements);
-  g_hash_table_unref (priv->movecontext.toplevel_containers);
+  ges_snap_index_free (priv->snap_index);
+  ges_interval_tree_free (priv->tracksources);
+  g_hash_table_unref (priv->transitions_dirty);
+  g_hash_table_unref (priv->pending_indexes);
+  g_hash_table_unref (priv->pending_transitions);
+  clear_movecontext (&priv->movecontext);
 
   g_hash_table_unref (priv->auto_transitions);
 
@@ -355,6 +463,13 @@ ges_timeline_dispose (GObject * object)
 static void
 ges_timeline_finalize (GObject * object)
 {
+  GESTimelinePrivate *priv = GES_TIMELINE (object)->priv;
+
+  /* Nobody can be acquiring a snapshot without holding a reference */
+  ges_timeline_snapshot_unref (priv->snapshot);
+  g_slist_free_full (priv->retired_snapshots,
+      (GDestroyNotify) ges_timeline_snapshot_unref);
+
   G_OBJECT_CLASS (ges_timeline_parent_class)->finalize (object);
 }
 
@@ -521,6 +636,33 @@ ges_timeline_class_init (GESTimelineClass * klass)
   ges_timeline_signals[COMMITED] =
       g_signal_new ("commited", G_TYPE_FROM_CLASS (klass),
       G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 0);
+
+  /**
+   * GESTimeline::commit-stats:
+   * @timeline: the #GESTimeline
+   * @stats: a #GstStructure describing the commit
+   *
+   * Will be emitted at the end of each #ges_timeline_commit, with the
+   * statistics of the #GESTrack::commit-stats of all the tracks summed up:
+   *
+   *  - "elements-touched" (#G_TYPE_UINT): the number of track elements that
+   *    changed since the last commit
+   *  - "gaps-changed" (#G_TYPE_UINT): the number of gaps that were added,
+   *    removed or moved since the last commit
+   *  - "tracks-committed" (#G_TYPE_UINT): the number of tracks that were
+   *    committed
+   *  - "tracks-skipped" (#G_TYPE_UINT): the number of tracks that did not
+   *    need to be committed
+   *  - "skipped" (#G_TYPE_BOOLEAN): whether none of the tracks needed to be
+   *    committed. #ges_timeline_commit still returns and #GESTimeline::commited
+   *    is still emitted as if they had been
+   *  - "time" (#G_TYPE_UINT64): the time spent in the whole commit, in
+   *    nanoseconds
+   */
+  ges_timeline_signals[COMMIT_STATS] =
+      g_signal_new ("commit-stats", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_marshal_generic,
+      G_TYPE_NONE, 1, GST_TYPE_STRUCTURE | G_SIGNAL_TYPE_STATIC_SCOPE);
 }
 
 static void
@@ -540,24 +682,28 @@ ges_timeline_init (GESTimeline * self)
 
   /* Move context initialization */
   init_movecontext (&self->priv->movecontext, TRUE);
-  priv->movecontext.ignore_needs_ctx = FALSE;
-
   priv->priv_tracks = NULL;
-  priv->by_start = g_hash_table_new (g_direct_hash, g_direct_equal);
-  priv->by_end = g_hash_table_new (g_direct_hash, g_direct_equal);
-  priv->by_object = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->layers_by_prio = g_ptr_array_new ();
   priv->by_layer = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
-      (GDestroyNotify) g_sequence_free);
+      (GDestroyNotify) ges_interval_tree_free);
   priv->obj_iters = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
       (GDestroyNotify) _destroy_obj_iters);
-  priv->starts_ends = g_sequence_new (g_free);
-  priv->tracksources = g_sequence_new (gst_object_unref);
+  priv->clips_by_layer = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) ges_interval_tree_free);
+  priv->clip_iters = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) _destroy_clip_iters);
+  priv->snap_index = ges_snap_index_new ();
+  priv->tracksources = ges_interval_tree_new (gst_object_unref);
 
   priv->auto_transitions =
       g_hash_table_new_full (g_str_hash, g_str_equal, NULL, gst_object_unref);
   priv->needs_transitions_update = TRUE;
+  priv->transitions_dirty = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->pending_indexes = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->pending_transitions = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   priv->group_id = -1;
+  priv->snapshot = timeline_build_snapshot (self);
 
   g_signal_connect_after (self, "select-tracks-for-object",
       G_CALLBACK (select_tracks_for_object_default), NULL);
@@ -565,6 +711,144 @@ ges_timeline_init (GESTimeline * self)
 
 /* Private methods */
 
+typedef struct
+{
+  GArray *clips;
+  GArray *elements;
+  guint layer_priority;
+} SnapshotBuilder;
+
+static gboolean
+snapshot_add_clip (GESClip * clip, guint64 start, guint64 end,
+    SnapshotBuilder * builder)
+{
+  GList *tmp;
+  GESTimelineSnapshotClip sclip;
+  GESTimelineSnapshotElement selement;
+
+  sclip.clip = clip;
+  sclip.start = _START (clip);
+  sclip.inpoint = _INPOINT (clip);
+  sclip.duration = _DURATION (clip);
+  sclip.layer_priority = builder->layer_priority;
+  sclip.track_types = 0;
+  sclip.is_transition = GES_IS_TRANSITION_CLIP (clip);
+  sclip.first_element = builder->elements->len;
+
+  for (tmp = GES_CONTAINER_CHILDREN (clip); tmp; tmp = tmp->next) {
+    GESTrackElement *child = tmp->data;
+    GESTrack *track = ges_track_element_get_track (child);
+
+    selement.element = child;
+    selement.track = track;
+    selement.clip_index = builder->clips->len;
+    selement.start = _START (child);
+    selement.inpoint = _INPOINT (child);
+    selement.duration = _DURATION (child);
+    selement.priority = _PRIORITY (child);
+    selement.active = ges_track_element_is_active (child);
+    g_array_append_val (builder->elements, selement);
+
+    if (track)
+      sclip.track_types |= track->type;
+  }
+
+  sclip.n_elements = builder->elements->len - sclip.first_element;
+  g_array_append_val (builder->clips, sclip);
+
+  return TRUE;
+}
+
+/* Copies the geometry of @timeline, this is linear in its number of track
+ * elements so it is only done when a snapshot of a new commit is needed */
+static GESTimelineSnapshot *
+timeline_build_snapshot (GESTimeline * timeline)
+{
+  guint i;
+  GESTimelineSnapshot *snapshot;
+  SnapshotBuilder builder;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  snapshot = g_slice_new0 (GESTimelineSnapshot);
+  snapshot->ref_count = 1;
+  snapshot->version = priv->snapshot_version++;
+  snapshot->duration = priv->duration;
+
+  builder.clips = g_array_new (FALSE, FALSE,
+      sizeof (GESTimelineSnapshotClip));
+  builder.elements = g_array_new (FALSE, FALSE,
+      sizeof (GESTimelineSnapshotElement));
+
+  snapshot->n_layers = priv->layers_by_prio->len;
+  snapshot->layers = g_new (GESTimelineSnapshotLayer, snapshot->n_layers);
+  for (i = 0; i < priv->layers_by_prio->len; i++) {
+    GESLayer *layer = g_ptr_array_index (priv->layers_by_prio, i);
+    GESIntervalTree *tree = g_hash_table_lookup (priv->clips_by_layer, layer);
+
+    snapshot->layers[i].layer = layer;
+    snapshot->layers[i].priority = ges_layer_get_priority (layer);
+    snapshot->layers[i].first_clip = builder.clips->len;
+
+    builder.layer_priority = snapshot->layers[i].priority;
+    if (tree)
+      ges_interval_tree_foreach (tree, (GESIntervalTreeFunc) snapshot_add_clip,
+          &builder);
+
+    snapshot->layers[i].n_clips =
+        builder.clips->len - snapshot->layers[i].first_clip;
+  }
+
+  snapshot->n_clips = builder.clips->len;
+  snapshot->clips =
+      (GESTimelineSnapshotClip *) g_array_free (builder.clips, FALSE);
+  snapshot->n_elements = builder.elements->len;
+  snapshot->elements =
+      (GESTimelineSnapshotElement *) g_array_free (builder.elements, FALSE);
+
+  return snapshot;
+}
+
+/* Must be called from the thread committing @timeline. The new snapshot is
+ * built without holding any lock, and published atomically */
+static void
+timeline_replace_snapshot (GESTimeline * timeline)
+{
+  GESTimelineSnapshot *snapshot, *old;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  snapshot = timeline_build_snapshot (timeline);
+  old = g_atomic_pointer_get (&priv->snapshot);
+  g_atomic_pointer_set (&priv->snapshot, snapshot);
+  priv->snapshot_dirty = FALSE;
+
+  /* A reader might have read @old and not referenced it yet, in which case
+   * it is still counted in snapshot_readers. Once there are no such readers,
+   * any reader gets the new snapshot, so the old ones can be released */
+  priv->retired_snapshots = g_slist_prepend (priv->retired_snapshots, old);
+  if (g_atomic_int_get (&priv->snapshot_readers) == 0) {
+    g_slist_free_full (priv->retired_snapshots,
+        (GDestroyNotify) ges_timeline_snapshot_unref);
+    priv->retired_snapshots = NULL;
+  }
+}
+
+/* Called on commit. Copying the timeline is left to the next
+ * ges_timeline_acquire_snapshot, unless snapshots are read from other
+ * threads: those could otherwise copy the timeline while it is being
+ * edited */
+static void
+timeline_publish_snapshot (GESTimeline * timeline)
+{
+  GESTimelinePrivate *priv = timeline->priv;
+
+  g_atomic_pointer_set (&priv->commit_thread, g_thread_self ());
+  g_atomic_int_set (&priv->snapshot->outdated, TRUE);
+  if (g_atomic_int_get (&priv->snapshot_shared))
+    timeline_replace_snapshot (timeline);
+  else
+    priv->snapshot_dirty = TRUE;
+}
+
 static inline GESContainer *
 get_toplevel_container (GESTrackElement * element)
 {
@@ -577,82 +861,210 @@ get_toplevel_container (GESTrackElement * element)
   return (GESContainer *) ret;
 }
 
-/* Sorting utils*/
-static gint
-sort_layers (gpointer a, gpointer b)
-{
-  GESLayer *layer_a, *layer_b;
-  guint prio_a, prio_b;
-
-  layer_a = GES_LAYER (a);
-  layer_b = GES_LAYER (b);
-
-  prio_a = ges_layer_get_priority (layer_a);
-  prio_b = ges_layer_get_priority (layer_b);
-
-  if ((gint) prio_a > (guint) prio_b)
-    return 1;
-  if ((guint) prio_a < (guint) prio_b)
-    return -1;
-
-  return 0;
-}
-
 static void
 timeline_update_duration (GESTimeline * timeline)
 {
-  GstClockTime *cduration;
-  GSequenceIter *it = g_sequence_get_end_iter (timeline->priv->starts_ends);
+  GstClockTime cduration;
+  guint n_edges = ges_snap_index_get_size (timeline->priv->snap_index);
 
-  it = g_sequence_iter_prev (it);
-
-  if (g_sequence_iter_is_end (it)) {
+  if (n_edges == 0) {
     timeline->priv->duration = 0;
     g_object_notify_by_pspec (G_OBJECT (timeline), properties[PROP_DURATION]);
     return;
   }
 
-  cduration = g_sequence_get (it);
+  /* The last edge always is the biggest end */
+  cduration =
+      ges_snap_index_get_edges (timeline->priv->snap_index)[n_edges -
+      1].timecode;
 
-  if (cduration && timeline->priv->duration != *cduration) {
+  if (timeline->priv->duration != cduration) {
     GST_DEBUG ("track duration : %" GST_TIME_FORMAT " current : %"
-        GST_TIME_FORMAT, GST_TIME_ARGS (*cduration),
+        GST_TIME_FORMAT, GST_TIME_ARGS (cduration),
         GST_TIME_ARGS (timeline->priv->duration));
 
-    timeline->priv->duration = *cduration;
+    timeline->priv->duration = cduration;
 
     g_object_notify_by_pspec (G_OBJECT (timeline), properties[PROP_DURATION]);
   }
 }
 
-static gint
-find_layer_by_prio (GESLayer * a, gpointer pprio)
+/* Returns the index of @layers_by_prio where a layer of priority @prio is,
+ * or should be inserted */
+static guint
+layer_index_for_prio (GESTimeline * timeline, guint prio)
+{
+  GPtrArray *layers = timeline->priv->layers_by_prio;
+  guint low = 0, high = layers->len, middle;
+
+  /* Fast path for the usual case, where priorities are contiguous from 0.
+   * The left neighbour is checked so that the first one of duplicated
+   * priorities is returned */
+  if (prio < layers->len &&
+      ges_layer_get_priority (g_ptr_array_index (layers, prio)) == prio &&
+      (prio == 0 ||
+          ges_layer_get_priority (g_ptr_array_index (layers, prio - 1)) < prio))
+    return prio;
+
+  while (low < high) {
+    middle = (low + high) / 2;
+    if (ges_layer_get_priority (g_ptr_array_index (layers, middle)) < prio)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+
+  return low;
+}
+
+static GESLayer *
+timeline_get_layer_by_prio (GESTimeline * timeline, guint prio)
 {
-  gint prio = GPOINTER_TO_INT (pprio), lprio = ges_layer_get_priority (a);
+  GPtrArray *layers = timeline->priv->layers_by_prio;
+  guint i = layer_index_for_prio (timeline, prio);
+
+  if (i < layers->len &&
+      ges_layer_get_priority (g_ptr_array_index (layers, i)) == prio)
+    return g_ptr_array_index (layers, i);
 
-  if (lprio < prio)
-    return -1;
-  if (lprio > prio)
-    return 1;
-  return 0;
+  return NULL;
 }
 
+/* Gives new base gnonlin priorities to all the layers, LAYER_SPACING apart
+ * and centered in the priority space so that there is room on both ends */
 static void
-sort_track_elements (GESTimeline * timeline, TrackObjIters * iters)
+timeline_spread_layer_bases (GESTimeline * timeline)
 {
-  g_sequence_sort_changed (iters->iter_obj,
-      (GCompareDataFunc) element_start_compare, NULL);
+  guint i;
+  guint64 base, span, spacing = LAYER_SPACING;
+  GPtrArray *layers = timeline->priv->layers_by_prio;
+
+  if (layers->len < 2)
+    return;
+
+  span = (guint64) (layers->len - 1) * spacing;
+  if (span > MAX_LAYER_BASE - MIN_GNL_PRIO) {
+    spacing = MAX (LAYER_HEIGHT,
+        (MAX_LAYER_BASE - MIN_GNL_PRIO) / (layers->len - 1));
+    span = (guint64) (layers->len - 1) * spacing;
+  }
+
+  GST_DEBUG_OBJECT (timeline, "Spreading %u layers %" G_GUINT64_FORMAT
+      " priorities apart", layers->len, spacing);
+
+  base = MIN_GNL_PRIO;
+  if (span < MAX_LAYER_BASE - MIN_GNL_PRIO)
+    base += (MAX_LAYER_BASE - MIN_GNL_PRIO - span) / 2;
+
+  for (i = 0; i < layers->len; i++)
+    _ges_layer_set_gnl_priority_base (g_ptr_array_index (layers, i),
+        base + i * spacing);
 }
 
-static gint
-compare_uint64 (guint64 * a, guint64 * b, gpointer user_data)
+/* Makes sure that the base gnonlin priority of the layer at @index in
+ * @layers_by_prio is above the ones of the layers of higher priorities and
+ * below the ones of lower priorities. Only that layer gets a new base when
+ * there is room for it, otherwise all the layers are spread again. If
+ * @keep_base, the layer keeps its current base if it is already in order */
+static void
+timeline_place_layer (GESTimeline * timeline, guint index, gboolean keep_base)
 {
-  if (*a > *b)
-    return 1;
-  else if (*a == *b)
-    return 0;
-  else
-    return -1;
+  gint i;
+  guint prio, other_prio;
+  gboolean has_prev = FALSE, has_next = FALSE;
+  guint64 low = MIN_GNL_PRIO, high = MAX_LAYER_BASE, base;
+  GPtrArray *layers = timeline->priv->layers_by_prio;
+  GESLayer *layer = g_ptr_array_index (layers, index), *other;
+
+  /* Layers with the same priority are not ordered with each other, so we
+   * have to be after all the layers of the previous priority, and before
+   * all the ones of the next priority */
+  prio = ges_layer_get_priority (layer);
+  other_prio = prio;
+  for (i = (gint) index - 1; i >= 0; i--) {
+    other = g_ptr_array_index (layers, i);
+    if (ges_layer_get_priority (other) == prio)
+      continue;
+    if (has_prev && ges_layer_get_priority (other) != other_prio)
+      break;
+
+    has_prev = TRUE;
+    other_prio = ges_layer_get_priority (other);
+    low = MAX (low, (guint64) other->min_gnl_priority + LAYER_HEIGHT);
+  }
+
+  other_prio = prio;
+  for (i = index + 1; i < (gint) layers->len; i++) {
+    other = g_ptr_array_index (layers, i);
+    if (ges_layer_get_priority (other) == prio)
+      continue;
+    if (has_next && ges_layer_get_priority (other) != other_prio)
+      break;
+
+    has_next = TRUE;
+    other_prio = ges_layer_get_priority (other);
+    high = MIN (high, other->min_gnl_priority < LAYER_HEIGHT ? 0 :
+        (guint64) other->min_gnl_priority - LAYER_HEIGHT);
+  }
+
+  if (keep_base && layer->min_gnl_priority >= low &&
+      layer->min_gnl_priority <= high)
+    return;
+
+  if (low > high) {
+    timeline_spread_layer_bases (timeline);
+    return;
+  }
+
+  /* Use the base the layer would have alone when it fits, unless it is
+   * above all the other layers, where we rather leave room for the next
+   * layers to be inserted on top */
+  base = (guint64) prio * LAYER_HEIGHT + MIN_GNL_PRIO;
+  if (base < low || base > high || (!has_prev && has_next)) {
+    if (!has_prev)
+      base = high - MIN (high - low, LAYER_SPACING - LAYER_HEIGHT);
+    else if (!has_next)
+      base = low + MIN (high - low, LAYER_SPACING - LAYER_HEIGHT);
+    else
+      base = low + (high - low) / 2;
+  }
+
+  _ges_layer_set_gnl_priority_base (layer, base);
+}
+
+/* Inserts @layer at its place in @layers_by_prio and timeline->layers */
+static void
+timeline_insert_layer_sorted (GESTimeline * timeline, GESLayer * layer,
+    gboolean keep_base)
+{
+  GPtrArray *layers = timeline->priv->layers_by_prio;
+  guint i = layer_index_for_prio (timeline, ges_layer_get_priority (layer));
+
+  g_ptr_array_add (layers, layer);
+  memmove (layers->pdata + i + 1, layers->pdata + i,
+      (layers->len - i - 1) * sizeof (gpointer));
+  g_ptr_array_index (layers, i) = layer;
+
+  timeline->layers = g_list_insert (timeline->layers, layer, i);
+
+  timeline_place_layer (timeline, i, keep_base);
+}
+
+/* Moves @iters->trackelement to its current [start, end] in the interval
+ * trees we index it in */
+static void
+update_track_element_intervals (GESTimeline * timeline, TrackObjIters * iters)
+{
+  GESTimelineElement *element = GES_TIMELINE_ELEMENT (iters->trackelement);
+
+  if (iters->node_by_layer)
+    ges_interval_tree_update (g_hash_table_lookup (timeline->priv->by_layer,
+            iters->layer), iters->node_by_layer, _START (element),
+        _END (element));
+
+  if (iters->node_obj)
+    ges_interval_tree_update (timeline->priv->tracksources, iters->node_obj,
+        _START (element), _END (element));
 }
 
 static gint
@@ -663,31 +1075,158 @@ custom_find_track (TrackPrivate * tr_priv, GESTrack * track)
   return -1;
 }
 
+/* Moves the edges of the Source in the snap index to its current
+ * start and end */
 static inline void
-sort_starts_ends_end (GESTimeline * timeline, TrackObjIters * iters)
+update_snap_edges (GESTimeline * timeline, TrackObjIters * iters)
 {
   GESTimelineElement *obj = GES_TIMELINE_ELEMENT (iters->trackelement);
-  GESTimelinePrivate *priv = timeline->priv;
-  guint64 *end = g_hash_table_lookup (priv->by_end, obj);
+  GESSnapIndex *snap_index = timeline->priv->snap_index;
 
-  *end = _START (obj) + _DURATION (obj);
+  ges_snap_index_move (snap_index, obj, iters->start_tc, _START (obj));
+  iters->start_tc = _START (obj);
+  ges_snap_index_move (snap_index, obj, iters->end_tc, _END (obj));
+  iters->end_tc = _END (obj);
 
-  g_sequence_sort_changed (iters->iter_end, (GCompareDataFunc) compare_uint64,
-      NULL);
   timeline_update_duration (timeline);
 }
 
-static inline void
-sort_starts_ends_start (GESTimeline * timeline, TrackObjIters * iters)
+static inline guint64
+move_context_get_editor_edge (MoveContext * mv_ctx)
 {
-  GESTimelineElement *obj = GES_TIMELINE_ELEMENT (iters->trackelement);
+  if (mv_ctx->edge == GES_EDGE_START)
+    return _START (mv_ctx->editor);
+
+  return _END (mv_ctx->editor);
+}
+
+/* Whether @source should be in moving_trackelements, see
+ * ges_move_context_set_objects */
+static inline gboolean
+move_context_should_move (MoveContext * mv_ctx, GESTrackElement * source,
+    guint64 editor_edge)
+{
+  if (source == mv_ctx->editor)
+    return FALSE;
+
+  if (mv_ctx->edge == GES_EDGE_START)
+    return _END (source) <= editor_edge;
+
+  return _START (source) >= editor_edge;
+}
+
+/* Called when @source moved, once the element values are all up to date */
+static void
+move_context_source_moved (GESTimeline * timeline, GESTrackElement * source)
+{
+  gboolean moving;
+  MoveContext *mv_ctx = &timeline->priv->movecontext;
+
+  if (mv_ctx->editor == NULL || mv_ctx->needs_move_ctx)
+    return;
+
+  moving = g_hash_table_contains (mv_ctx->moving_set, source);
+  if (moving)
+    mv_ctx->needs_max_trim_pos = TRUE;
+
+  if (moving != move_context_should_move (mv_ctx, source,
+          move_context_get_editor_edge (mv_ctx))) {
+    GST_DEBUG_OBJECT (source, "Changed side of the edited edge");
+    mv_ctx->needs_move_ctx = TRUE;
+  }
+}
+
+/* Checks the Sources the edited edge passed over since last time, called
+ * once the snap index is up to date */
+static void
+move_context_check_editor_edge (GESTimeline * timeline)
+{
+  guint i, n_edges;
+  const GESSnapEdge *edges;
+  guint64 editor_edge, low, high;
+  MoveContext *mv_ctx = &timeline->priv->movecontext;
+  GESSnapIndex *snap_index = timeline->priv->snap_index;
+
+  if (mv_ctx->editor == NULL || mv_ctx->needs_move_ctx)
+    return;
+
+  editor_edge = move_context_get_editor_edge (mv_ctx);
+  if (editor_edge == mv_ctx->editor_edge)
+    return;
+
+  low = MIN (editor_edge, mv_ctx->editor_edge);
+  high = MAX (editor_edge, mv_ctx->editor_edge);
+  mv_ctx->editor_edge = editor_edge;
+
+  /* Only the Sources with an edge in [low, high] can have changed side */
+  n_edges = ges_snap_index_get_size (snap_index);
+  edges = ges_snap_index_get_edges (snap_index);
+  for (i = ges_snap_index_lower_bound (snap_index, low);
+      i < n_edges && edges[i].timecode <= high; i++) {
+    if (edges[i].data == NULL)
+      continue;
+
+    if (g_hash_table_contains (mv_ctx->moving_set, edges[i].data) !=
+        move_context_should_move (mv_ctx, edges[i].data, editor_edge)) {
+      GST_DEBUG_OBJECT (edges[i].data, "Changed side of the edited edge");
+      mv_ctx->needs_move_ctx = TRUE;
+
+      return;
+    }
+  }
+}
+
+/* Updates the indexes of the TrackElement-s that moved inside the current
+ * edit transaction, so that they can be queried again */
+static void
+flush_pending_indexes (GESTimeline * timeline)
+{
+  GHashTableIter iter;
+  GESTrackElement *trackelement;
+  TrackObjIters *iters;
+  GArray *moves;
+  GESSnapMove move;
+
   GESTimelinePrivate *priv = timeline->priv;
-  guint64 *start = g_hash_table_lookup (priv->by_start, obj);
 
-  *start = _START (obj);
+  if (g_hash_table_size (priv->pending_indexes) == 0)
+    return;
+
+  moves = g_array_sized_new (FALSE, FALSE, sizeof (GESSnapMove),
+      2 * g_hash_table_size (priv->pending_indexes));
+
+  g_hash_table_iter_init (&iter, priv->pending_indexes);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & trackelement, NULL)) {
+    iters = g_hash_table_lookup (priv->obj_iters, trackelement);
+
+    update_track_element_intervals (timeline, iters);
+    if (GES_IS_SOURCE (trackelement)) {
+      move_context_source_moved (timeline, trackelement);
+
+      move.data = trackelement;
+
+      if (iters->start_tc != _START (trackelement)) {
+        move.old_timecode = iters->start_tc;
+        move.new_timecode = iters->start_tc = _START (trackelement);
+        g_array_append_val (moves, move);
+      }
+
+      if (iters->end_tc != _END (trackelement)) {
+        move.old_timecode = iters->end_tc;
+        move.new_timecode = iters->end_tc = _END (trackelement);
+        g_array_append_val (moves, move);
+      }
+    }
+  }
+  g_hash_table_remove_all (priv->pending_indexes);
+
+  /* Move all the edges at once */
+  ges_snap_index_move_many (priv->snap_index, (GESSnapMove *) moves->data,
+      moves->len);
+  g_array_free (moves, TRUE);
+
+  move_context_check_editor_edge (timeline);
 
-  g_sequence_sort_changed (iters->iter_start,
-      (GCompareDataFunc) compare_uint64, NULL);
   timeline_update_duration (timeline);
 }
 
@@ -760,13 +1299,38 @@ _find_transition_from_auto_transitions (GESTimeline * timeline,
   return auto_transition;
 }
 
+typedef struct
+{
+  GESTrack *track;
+  GstClockTime duration;
+  GESTrackElement *transition;
+} TransitionLookup;
+
+static gboolean
+_find_fitting_transition (GESTrackElement * element, guint64 start,
+    guint64 end, TransitionLookup * lookup)
+{
+  /* TODO We should make sure that the transition contains only
+   * TrackElement-s in @track and if it is not the case properly unlink the
+   * object to use it */
+  if (GES_IS_TRANSITION (element) &&
+      ges_track_element_get_track (element) == lookup->track &&
+      _DURATION (element) == lookup->duration) {
+    lookup->transition = element;
+
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
 static GESAutoTransition *
 _create_auto_transition_from_transitions (GESTimeline * timeline,
     GESLayer * layer, GESTrack * track, GESTrackElement * prev,
     GESTrackElement * next, GstClockTime transition_duration)
 {
-  GSequenceIter *tmp_iter;
-  GSequence *by_layer_sequence;
+  GESIntervalTree *by_layer_tree;
+  TransitionLookup lookup = { track, transition_duration, NULL };
 
   GESTimelinePrivate *priv = timeline->priv;
   GESAutoTransition *auto_transition =
@@ -776,116 +1340,144 @@ _create_auto_transition_from_transitions (GESTimeline * timeline,
   if (auto_transition)
     return auto_transition;
 
-
   /* Try to find a transition that perfectly fits with the one that
-   * should be added at that place
-   * optimize: Use g_sequence_search instead of going over all the
-   * sequence */
-  by_layer_sequence = g_hash_table_lookup (priv->by_layer, layer);
-  for (tmp_iter = g_sequence_get_begin_iter (by_layer_sequence);
-      tmp_iter && !g_sequence_iter_is_end (tmp_iter);
-      tmp_iter = g_sequence_iter_next (tmp_iter)) {
-    GESTrackElement *maybe_transition = g_sequence_get (tmp_iter);
-
-    if (ges_track_element_get_track (maybe_transition) != track)
-      continue;
+   * should be added at that place */
+  by_layer_tree = g_hash_table_lookup (priv->by_layer, layer);
+  ges_interval_tree_foreach_in_range (by_layer_tree, _START (next),
+      _START (next), (GESIntervalTreeFunc) _find_fitting_transition, &lookup);
 
-    if (_START (maybe_transition) > _START (next))
-      break;
-    else if (_START (maybe_transition) != _START (next) ||
-        _DURATION (maybe_transition) != transition_duration)
-      continue;
-    else if (GES_IS_TRANSITION (maybe_transition))
-      /* Use that transition */
-      /* TODO We should make sure that the transition contains only
-       * TrackElement-s in @track and if it is not the case properly unlink the
-       * object to use it */
-      return create_transition (timeline, prev, next,
-          GES_CLIP (GES_TIMELINE_ELEMENT_PARENT (maybe_transition)), layer,
-          _START (next), transition_duration);
-  }
+  if (lookup.transition)
+    return create_transition (timeline, prev, next,
+        GES_CLIP (GES_TIMELINE_ELEMENT_PARENT (lookup.transition)), layer,
+        _START (next), transition_duration);
 
   return NULL;
 }
 
+typedef struct
+{
+  GESTrack *track;
+  GESTrackElement *element;
+
+  /* Couples of overlapping sources: previous, next, previous, next, ... */
+  GPtrArray *pairs;
+} TransitionSearch;
+
+static gboolean
+_collect_sources (GESTrackElement * element, guint64 start, guint64 end,
+    GPtrArray * sources)
+{
+  if (GES_IS_SOURCE (element))
+    g_ptr_array_add (sources, element);
+
+  return TRUE;
+}
+
+static gboolean
+_collect_overlapping_sources (GESTrackElement * other, guint64 start,
+    guint64 end, TransitionSearch * search)
+{
+  GESTrackElement *element = search->element;
+
+  if (other == element || !GES_IS_SOURCE (other) ||
+      ges_track_element_get_track (other) != search->track)
+    return TRUE;
+
+  if (_START (other) < _START (element)) {
+    g_ptr_array_add (search->pairs, other);
+    g_ptr_array_add (search->pairs, element);
+  } else if (_START (other) > _START (element)) {
+    g_ptr_array_add (search->pairs, element);
+    g_ptr_array_add (search->pairs, other);
+  }
+
+  return TRUE;
+}
+
+static void
+_create_transitions_for_pairs (GESTimeline * timeline, GESLayer * layer,
+    GPtrArray * pairs, GetAutoTransitionFunc get_auto_transition)
+{
+  guint i;
+
+  for (i = 0; i + 1 < pairs->len; i += 2) {
+    gint64 transition_duration;
+    GESTrackElement *prev = g_ptr_array_index (pairs, i);
+    GESTrackElement *next = g_ptr_array_index (pairs, i + 1);
+    GESTrack *track = ges_track_element_get_track (next);
+
+    if (get_toplevel_container (prev) == get_toplevel_container (next))
+      continue;
+
+    transition_duration = (_START (prev) + _DURATION (prev)) - _START (next);
+    if (transition_duration > 0 && transition_duration < _DURATION (prev) &&
+        transition_duration < _DURATION (next)) {
+      if (!get_auto_transition (timeline, layer, track, prev, next,
+              transition_duration))
+        create_transition (timeline, prev, next, NULL, layer,
+            _START (next), transition_duration);
+    }
+  }
+}
+
 /* Create all transition that do not exist on @layer.
  * @get_auto_transition is called to check if a particular transition exists
  * if @ track is specified, we will create the transitions only for that particular
- * track */
+ * track. If @initiating_obj is specified, only the transitions it is part of
+ * are considered */
 static void
 _create_transitions_on_layer (GESTimeline * timeline, GESLayer * layer,
     GESTrack * track, GESTrackElement * initiating_obj,
     GetAutoTransitionFunc get_auto_transition)
 {
-  guint32 layer_prio;
-  GSequenceIter *iter;
-  GESAutoTransition *transition;
+  guint i;
+  GPtrArray *sources;
+  GESIntervalTree *by_layer_tree;
+  TransitionSearch search;
 
-  GESTrack *ctrack = track;
-  GList *entered = NULL;        /* List of TrackElement for wich we walk through the
-                                 * "start" but not the "end" in the starts_ends list */
   GESTimelinePrivate *priv = timeline->priv;
 
   if (!layer || !ges_layer_get_auto_transition (layer))
     return;
 
-  layer_prio = ges_layer_get_priority (layer);
-  for (iter = g_sequence_get_begin_iter (priv->starts_ends);
-      iter && !g_sequence_iter_is_end (iter);
-      iter = g_sequence_iter_next (iter)) {
-    GList *tmp;
-    guint *start_or_end = g_sequence_get (iter);
-    GESTrackElement *next = g_hash_table_lookup (timeline->priv->by_object,
-        start_or_end);
-    GESTimelineElement *toplevel =
-        ges_timeline_element_get_toplevel_parent (GES_TIMELINE_ELEMENT (next));
-
-    /* Only object that are in that layer and track */
-    if (_ges_track_element_get_layer_priority (next) != layer_prio ||
-        (track && track != ges_track_element_get_track (next)))
-      continue;
-
-    if (track == NULL)
-      ctrack = ges_track_element_get_track (next);
-
-    if (start_or_end == g_hash_table_lookup (priv->by_end, next)) {
-      if (initiating_obj == next) {
-        /* We passed the objects that initiated the research
-         * we are now done */
-        g_list_free (entered);
-        return;
-      }
-      entered = g_list_remove (entered, next);
+  flush_pending_indexes (timeline);
 
-      continue;
-    }
+  by_layer_tree = g_hash_table_lookup (priv->by_layer, layer);
+  if (G_UNLIKELY (by_layer_tree == NULL))
+    return;
 
-    for (tmp = entered; tmp; tmp = tmp->next) {
-      gint64 transition_duration;
+  /* We can not create the transitions while walking the tree as it
+   * is modified when adding them, collect the couples first */
+  search.pairs = g_ptr_array_new ();
+  if (initiating_obj) {
+    search.element = initiating_obj;
+    search.track = track ? track : ges_track_element_get_track (initiating_obj);
+    ges_interval_tree_foreach_overlapping (by_layer_tree,
+        _START (initiating_obj), _END (initiating_obj),
+        (GESIntervalTreeFunc) _collect_overlapping_sources, &search);
+  } else {
+    sources = g_ptr_array_new ();
+    ges_interval_tree_foreach (by_layer_tree,
+        (GESIntervalTreeFunc) _collect_sources, sources);
 
-      GESTrackElement *prev = tmp->data;
+    /* Each source is the "next" one of the sources its start lands in */
+    for (i = 0; i < sources->len; i++) {
+      search.element = g_ptr_array_index (sources, i);
+      search.track = ges_track_element_get_track (search.element);
 
-      if (ctrack != ges_track_element_get_track (prev) ||
-          ges_timeline_element_get_toplevel_parent (GES_TIMELINE_ELEMENT (prev))
-          == toplevel)
+      if (track && search.track != track)
         continue;
 
-      transition_duration = (_START (prev) + _DURATION (prev)) - _START (next);
-      if (transition_duration > 0 && transition_duration < _DURATION (prev) &&
-          transition_duration < _DURATION (next)) {
-        transition =
-            get_auto_transition (timeline, layer, ctrack, prev, next,
-            transition_duration);
-        if (!transition)
-          transition = create_transition (timeline, prev, next, NULL, layer,
-              _START (next), transition_duration);
-      }
+      ges_interval_tree_foreach_overlapping (by_layer_tree,
+          _START (search.element), _START (search.element),
+          (GESIntervalTreeFunc) _collect_overlapping_sources, &search);
     }
-
-    /* And add that object to the entered list so that it we can possibly set
-     * a transition on its end edge */
-    entered = g_list_append (entered, next);
+    g_ptr_array_free (sources, TRUE);
   }
+
+  _create_transitions_for_pairs (timeline, layer, search.pairs,
+      get_auto_transition);
+  g_ptr_array_free (search.pairs, TRUE);
 }
 
 /* @track_element must be a GESSource */
@@ -893,79 +1485,129 @@ static void
 create_transitions (GESTimeline * timeline, GESTrackElement * track_element)
 {
   GESTrack *track;
-  GList *layer_node;
+  GESLayer *layer;
 
   GESTimelinePrivate *priv = timeline->priv;
 
-  if (!priv->needs_transitions_update)
+  if (!priv->needs_transitions_update) {
+    /* Only look at it when commiting */
+    g_hash_table_add (priv->transitions_dirty, track_element);
+
     return;
+  }
+
+  if (priv->edit_depth) {
+    /* Only look at it when the edit transaction is over */
+    g_hash_table_add (priv->pending_transitions, track_element);
+
+    return;
+  }
 
   GST_DEBUG_OBJECT (timeline, "Creating transitions around %p", track_element);
 
   track = ges_track_element_get_track (track_element);
-  layer_node = g_list_find_custom (timeline->layers,
-      GINT_TO_POINTER (_ges_track_element_get_layer_priority (track_element)),
-      (GCompareFunc) find_layer_by_prio);
+  layer = timeline_get_layer_by_prio (timeline,
+      _ges_track_element_get_layer_priority (track_element));
 
-  _create_transitions_on_layer (timeline,
-      layer_node ? layer_node->data : NULL, track, track_element,
+  _create_transitions_on_layer (timeline, layer, track, track_element,
       _find_transition_from_auto_transitions);
 
   GST_DEBUG_OBJECT (timeline, "Done updating transitions");
 }
 
-/* Timeline edition functions */
-static inline void
-init_movecontext (MoveContext * mv_ctx, gboolean first_init)
+/* Creates the transitions around the sources that moved since last time,
+ * and only those, so that it does not depend on the size of the timeline */
+static void
+update_dirty_transitions (GESTimeline * timeline)
+{
+  GList *dirty, *tmp;
+  TrackObjIters *iters;
+
+  GESTimelinePrivate *priv = timeline->priv;
+
+  if (g_hash_table_size (priv->transitions_dirty) == 0)
+    return;
+
+  GST_DEBUG_OBJECT (timeline, "Updating transitions around %i sources",
+      g_hash_table_size (priv->transitions_dirty));
+
+  dirty = g_hash_table_get_keys (priv->transitions_dirty);
+  g_hash_table_remove_all (priv->transitions_dirty);
+
+  for (tmp = dirty; tmp; tmp = tmp->next) {
+    iters = g_hash_table_lookup (priv->obj_iters, tmp->data);
+
+    if (iters && iters->layer)
+      _create_transitions_on_layer (timeline, iters->layer,
+          NULL, tmp->data, _find_transition_from_auto_transitions);
+  }
+
+  g_list_free (dirty);
+}
+
+/* Timeline edition functions */
+static inline void
+init_movecontext (MoveContext * mv_ctx, gboolean first_init)
 {
-  if (G_UNLIKELY (first_init))
+  if (G_UNLIKELY (first_init)) {
     mv_ctx->toplevel_containers =
         g_hash_table_new (g_direct_hash, g_direct_equal);
+    mv_ctx->moving_set = g_hash_table_new (g_direct_hash, g_direct_equal);
+  }
 
   mv_ctx->moving_trackelements = NULL;
   mv_ctx->max_trim_pos = G_MAXUINT64;
+  mv_ctx->needs_max_trim_pos = FALSE;
+  mv_ctx->editor = NULL;
   mv_ctx->min_move_layer = G_MAXUINT;
   mv_ctx->max_layer_prio = 0;
   mv_ctx->last_snaped1 = NULL;
   mv_ctx->last_snaped2 = NULL;
-  mv_ctx->last_snap_ts = NULL;
+  mv_ctx->last_snap_ts = GST_CLOCK_TIME_NONE;
 }
 
 static inline void
 clean_movecontext (MoveContext * mv_ctx)
 {
   g_list_free (mv_ctx->moving_trackelements);
+  g_hash_table_remove_all (mv_ctx->moving_set);
   g_hash_table_remove_all (mv_ctx->toplevel_containers);
   init_movecontext (mv_ctx, FALSE);
 }
 
+/* Frees what init_movecontext allocated on first init */
+static inline void
+clear_movecontext (MoveContext * mv_ctx)
+{
+  g_list_free (mv_ctx->moving_trackelements);
+  g_hash_table_unref (mv_ctx->moving_set);
+  g_hash_table_unref (mv_ctx->toplevel_containers);
+}
+
 static void
 stop_tracking_track_element (GESTimeline * timeline,
     GESTrackElement * trackelement)
 {
-  guint64 *start, *end;
   TrackObjIters *iters;
   GESTimelinePrivate *priv = timeline->priv;
 
+  g_hash_table_remove (priv->transitions_dirty, trackelement);
+  g_hash_table_remove (priv->pending_indexes, trackelement);
+  g_hash_table_remove (priv->pending_transitions, trackelement);
+
   iters = g_hash_table_lookup (priv->obj_iters, trackelement);
-  if (G_LIKELY (iters->iter_by_layer)) {
-    g_sequence_remove (iters->iter_by_layer);
+  if (G_LIKELY (iters->node_by_layer)) {
+    ges_interval_tree_remove (g_hash_table_lookup (priv->by_layer,
+            iters->layer), iters->node_by_layer);
   } else {
     GST_WARNING_OBJECT (timeline, "TrackElement %p was in no layer",
         trackelement);
   }
 
   if (GES_IS_SOURCE (trackelement)) {
-    start = g_hash_table_lookup (priv->by_start, trackelement);
-    end = g_hash_table_lookup (priv->by_end, trackelement);
-
-    g_hash_table_remove (priv->by_start, trackelement);
-    g_hash_table_remove (priv->by_end, trackelement);
-    g_hash_table_remove (priv->by_object, end);
-    g_hash_table_remove (priv->by_object, start);
-    g_sequence_remove (iters->iter_start);
-    g_sequence_remove (iters->iter_end);
-    g_sequence_remove (iters->iter_obj);
+    ges_snap_index_remove (priv->snap_index, trackelement, iters->start_tc);
+    ges_snap_index_remove (priv->snap_index, trackelement, iters->end_tc);
+    ges_interval_tree_remove (priv->tracksources, iters->node_obj);
     timeline_update_duration (timeline);
   }
   g_hash_table_remove (priv->obj_iters, trackelement);
@@ -975,20 +1617,18 @@ static void
 start_tracking_track_element (GESTimeline * timeline,
     GESTrackElement * trackelement)
 {
-  guint64 *pstart, *pend;
-  GSequence *by_layer_sequence;
+  GESIntervalTree *by_layer_tree;
   TrackObjIters *iters;
   GESTimelinePrivate *priv = timeline->priv;
 
-  guint layer_prio = _ges_track_element_get_layer_priority (trackelement);
-  GList *layer_node = g_list_find_custom (timeline->layers,
-      GINT_TO_POINTER (layer_prio), (GCompareFunc) find_layer_by_prio);
-  GESLayer *layer = layer_node ? layer_node->data : NULL;
+  GESLayer *layer = timeline_get_layer_by_prio (timeline,
+      _ges_track_element_get_layer_priority (trackelement));
 
   iters = g_slice_new0 (TrackObjIters);
+  iters->trackelement = trackelement;
 
   /* We add all TrackElement to obj_iters as we always follow them
-   * in the by_layer Sequences */
+   * in the by_layer trees */
   g_hash_table_insert (priv->obj_iters, trackelement, iters);
 
   /* Track all objects by layer */
@@ -1003,34 +1643,21 @@ start_tracking_track_element (GESTimeline * timeline,
     GST_ERROR_OBJECT (timeline, "Adding a TrackElement that lands in no layer "
         "we are controlling");
   } else {
-    by_layer_sequence = g_hash_table_lookup (priv->by_layer, layer);
-    iters->iter_by_layer =
-        g_sequence_insert_sorted (by_layer_sequence, trackelement,
-        (GCompareDataFunc) element_start_compare, NULL);
+    by_layer_tree = g_hash_table_lookup (priv->by_layer, layer);
+    iters->node_by_layer = ges_interval_tree_insert (by_layer_tree,
+        trackelement, _START (trackelement), _END (trackelement));
     iters->layer = layer;
   }
 
   if (GES_IS_SOURCE (trackelement)) {
     /* Track only sources for timeline edition and snapping */
-    pstart = g_malloc (sizeof (guint64));
-    pend = g_malloc (sizeof (guint64));
-    *pstart = _START (trackelement);
-    *pend = *pstart + _DURATION (trackelement);
-
-    iters->iter_start = g_sequence_insert_sorted (priv->starts_ends, pstart,
-        (GCompareDataFunc) compare_uint64, NULL);
-    iters->iter_end = g_sequence_insert_sorted (priv->starts_ends, pend,
-        (GCompareDataFunc) compare_uint64, NULL);
-    iters->iter_obj =
-        g_sequence_insert_sorted (priv->tracksources,
-        gst_object_ref (trackelement), (GCompareDataFunc) element_start_compare,
-        NULL);
-    iters->trackelement = trackelement;
-
-    g_hash_table_insert (priv->by_start, trackelement, pstart);
-    g_hash_table_insert (priv->by_object, pstart, trackelement);
-    g_hash_table_insert (priv->by_end, trackelement, pend);
-    g_hash_table_insert (priv->by_object, pend, trackelement);
+    iters->start_tc = _START (trackelement);
+    iters->end_tc = _END (trackelement);
+
+    ges_snap_index_add (priv->snap_index, trackelement, iters->start_tc);
+    ges_snap_index_add (priv->snap_index, trackelement, iters->end_tc);
+    iters->node_obj = ges_interval_tree_insert (priv->tracksources,
+        gst_object_ref (trackelement), iters->start_tc, iters->end_tc);
 
     timeline->priv->movecontext.needs_move_ctx = TRUE;
 
@@ -1041,19 +1668,17 @@ start_tracking_track_element (GESTimeline * timeline,
 
 static inline void
 ges_timeline_emit_snappig (GESTimeline * timeline, GESTrackElement * obj1,
-    guint64 * timecode)
+    const GESSnapEdge * edge)
 {
-  GESTrackElement *obj2;
   MoveContext *mv_ctx = &timeline->priv->movecontext;
-  GstClockTime snap_time = timecode ? *timecode : 0;
-  GstClockTime last_snap_ts = mv_ctx->last_snap_ts ?
-      *mv_ctx->last_snap_ts : GST_CLOCK_TIME_NONE;
+  GstClockTime snap_time = edge ? edge->timecode : 0;
+  GstClockTime last_snap_ts = mv_ctx->last_snap_ts;
 
   GST_DEBUG_OBJECT (timeline, "Distance: %" GST_TIME_FORMAT " snapping at %"
       GST_TIME_FORMAT, GST_TIME_ARGS (timeline->priv->snapping_distance),
       GST_TIME_ARGS (snap_time));
 
-  if (timecode == NULL) {
+  if (edge == NULL) {
     if (mv_ctx->last_snaped1 != NULL && mv_ctx->last_snaped2 != NULL) {
       g_signal_emit (timeline, ges_timeline_signals[SNAPING_ENDED], 0,
           mv_ctx->last_snaped1, mv_ctx->last_snaped2, last_snap_ts);
@@ -1065,114 +1690,108 @@ ges_timeline_emit_snappig (GESTimeline * timeline, GESTrackElement * obj1,
     return;
   }
 
-  obj2 = g_hash_table_lookup (timeline->priv->by_object, timecode);
-
-  if (last_snap_ts != *timecode) {
+  if (last_snap_ts != edge->timecode) {
     g_signal_emit (timeline, ges_timeline_signals[SNAPING_ENDED], 0,
         mv_ctx->last_snaped1, mv_ctx->last_snaped2, (last_snap_ts));
 
     /* We want the snap start signal to be emited anyway */
-    mv_ctx->last_snap_ts = NULL;
+    mv_ctx->last_snap_ts = GST_CLOCK_TIME_NONE;
   }
 
-  if (mv_ctx->last_snap_ts == NULL) {
+  if (!GST_CLOCK_TIME_IS_VALID (mv_ctx->last_snap_ts)) {
 
     mv_ctx->last_snaped1 = obj1;
-    mv_ctx->last_snaped2 = obj2;
-    mv_ctx->last_snap_ts = timecode;
+    mv_ctx->last_snaped2 = edge->data;
+    mv_ctx->last_snap_ts = edge->timecode;
 
     g_signal_emit (timeline, ges_timeline_signals[SNAPING_STARTED], 0,
-        obj1, obj2, *timecode);
+        obj1, edge->data, edge->timecode);
 
   }
 }
 
-static guint64 *
+/* Looks for the closest edge of a Source that is not in the same toplevel
+ * container as @trackelement and that is at most the snapping distance away
+ * from @timecode. Returns %TRUE and sets @snapped to it if there is one */
+static gboolean
 ges_timeline_snap_position (GESTimeline * timeline,
-    GESTrackElement * trackelement, guint64 * current, guint64 timecode,
-    gboolean emit)
+    GESTrackElement * trackelement, guint64 timecode, gboolean emit,
+    GESSnapEdge * snapped)
 {
   GESTimelinePrivate *priv = timeline->priv;
-  GSequenceIter *iter, *prev_iter, *nxt_iter;
-  GESTrackElement *tmp_trackelement;
-  GESContainer *tmp_container, *container;
+  GESContainer *container;
+  const GESSnapEdge *edges, *ret = NULL;
+  GESSnapEdge last_snap;
+  guint i, n_edges;
 
-  GstClockTime *last_snap_ts = priv->movecontext.last_snap_ts;
+  GstClockTime last_snap_ts = priv->movecontext.last_snap_ts;
   guint64 snap_distance = timeline->priv->snapping_distance;
-  guint64 *prev_tc, *next_tc, *ret = NULL, off = G_MAXUINT64, off1 =
-      G_MAXUINT64;
+  guint64 off = G_MAXUINT64;
 
   /* Avoid useless calculations */
   if (snap_distance == 0)
-    return NULL;
+    return FALSE;
+
+  flush_pending_indexes (timeline);
 
   /* If we can just resnap as last snap... do it */
-  if (last_snap_ts) {
-    off = timecode > *last_snap_ts ?
-        timecode - *last_snap_ts : *last_snap_ts - timecode;
+  if (GST_CLOCK_TIME_IS_VALID (last_snap_ts)) {
+    off = timecode > last_snap_ts ?
+        timecode - last_snap_ts : last_snap_ts - timecode;
     if (off <= snap_distance) {
-      ret = last_snap_ts;
+      last_snap.timecode = last_snap_ts;
+      last_snap.data = priv->movecontext.last_snaped2;
+      ret = &last_snap;
       goto done;
     }
   }
 
   container = get_toplevel_container (trackelement);
 
-  iter = g_sequence_search (priv->starts_ends, &timecode,
-      (GCompareDataFunc) compare_uint64, NULL);
-
-  /* Getting the next/previous  values, and use the closest one if any "respects"
-   * the snap_distance value */
-  nxt_iter = iter;
-  while (!g_sequence_iter_is_end (nxt_iter)) {
-    next_tc = g_sequence_get (iter);
-    tmp_trackelement = g_hash_table_lookup (timeline->priv->by_object, next_tc);
-    tmp_container = get_toplevel_container (tmp_trackelement);
-
-    off = timecode > *next_tc ? timecode - *next_tc : *next_tc - timecode;
-    if (next_tc != current && off <= snap_distance
-        && container != tmp_container) {
-
-      ret = next_tc;
+  n_edges = ges_snap_index_get_size (priv->snap_index);
+  edges = ges_snap_index_get_edges (priv->snap_index);
+  i = ges_snap_index_lower_bound (priv->snap_index, timecode);
+
+  /* Getting the next/previous values, and use the closest one if any
+   * "respects" the snap_distance value, as edges are sorted we can stop
+   * as soon as we are too far */
+  off = G_MAXUINT64;
+  for (; i < n_edges && edges[i].timecode - timecode <= snap_distance; i++) {
+    if (edges[i].data &&
+        get_toplevel_container (edges[i].data) != container) {
+      off = edges[i].timecode - timecode;
+      ret = &edges[i];
       break;
     }
-
-    nxt_iter = g_sequence_iter_next (nxt_iter);
   }
 
-  if (ret == NULL)
-    off = G_MAXUINT64;
-
-  prev_iter = g_sequence_iter_prev (iter);
-  while (!g_sequence_iter_is_begin (prev_iter)) {
-    prev_tc = g_sequence_get (prev_iter);
-    tmp_trackelement = g_hash_table_lookup (timeline->priv->by_object, prev_tc);
-    tmp_container = get_toplevel_container (tmp_trackelement);
-
-    off1 = timecode > *prev_tc ? timecode - *prev_tc : *prev_tc - timecode;
-    if (prev_tc != current && off1 < off && off1 <= snap_distance &&
-        container != tmp_container) {
-      ret = prev_tc;
-
+  for (i = ges_snap_index_lower_bound (priv->snap_index, timecode); i > 0 &&
+      timecode - edges[i - 1].timecode < off &&
+      timecode - edges[i - 1].timecode <= snap_distance; i--) {
+    if (edges[i - 1].data &&
+        get_toplevel_container (edges[i - 1].data) != container) {
+      ret = &edges[i - 1];
       break;
     }
-
-    prev_iter = g_sequence_iter_prev (prev_iter);
   }
 
 done:
+  /* @ret might point in the index, copy it before signals are emited */
+  if (ret)
+    *snapped = *ret;
+
   /* We emit the snapping signal only if we snapped with a different value
    * than the current one */
   if (emit) {
-    GstClockTime snap_time = ret ? *ret : GST_CLOCK_TIME_NONE;
+    GstClockTime snap_time = ret ? snapped->timecode : GST_CLOCK_TIME_NONE;
 
-    ges_timeline_emit_snappig (timeline, trackelement, ret);
+    ges_timeline_emit_snappig (timeline, trackelement, ret ? snapped : NULL);
 
     GST_DEBUG_OBJECT (timeline, "Snaping at %" GST_TIME_FORMAT,
         GST_TIME_ARGS (snap_time));
   }
 
-  return ret;
+  return ret != NULL;
 }
 
 static inline GESContainer *
@@ -1210,98 +1829,100 @@ add_toplevel_container (MoveContext * mv_ctx, GESTrackElement * trackelement)
   return toplevel;
 }
 
+typedef struct
+{
+  MoveContext *mv_ctx;
+  GESTrackElement *obj;
+  guint64 position;
+} MovingCollect;
+
+/* Collects the sources ending before @collect->position */
 static gboolean
-ges_move_context_set_objects (GESTimeline * timeline, GESTrackElement * obj,
-    GESEdge edge)
+_collect_moving_before (GESTrackElement * element, guint64 start, guint64 end,
+    MovingCollect * collect)
 {
-  TrackObjIters *iters;
-  GESTrackElement *tmptrackelement;
-  guint64 start, end, tmpend;
-  GSequenceIter *iter, *trackelement_iter;
+  MoveContext *mv_ctx = collect->mv_ctx;
 
-  MoveContext *mv_ctx = &timeline->priv->movecontext;
+  if (element != collect->obj && end <= collect->position) {
+    mv_ctx->max_trim_pos = MAX (mv_ctx->max_trim_pos, start);
+    mv_ctx->moving_trackelements =
+        g_list_prepend (mv_ctx->moving_trackelements, element);
+    g_hash_table_add (mv_ctx->moving_set, element);
+  }
+
+  return TRUE;
+}
+
+/* Collects the sources starting after @collect->position */
+static gboolean
+_collect_moving_after (GESTrackElement * element, guint64 start, guint64 end,
+    MovingCollect * collect)
+{
+  MoveContext *mv_ctx = collect->mv_ctx;
+
+  if (element != collect->obj) {
+    mv_ctx->max_trim_pos = MIN (mv_ctx->max_trim_pos, end);
+    mv_ctx->moving_trackelements =
+        g_list_prepend (mv_ctx->moving_trackelements, element);
+    g_hash_table_add (mv_ctx->moving_set, element);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+ges_move_context_set_objects (GESTimeline * timeline, MoveContext * mv_ctx,
+    GESTrackElement * obj, GESEdge edge)
+{
+  MovingCollect collect;
+
+  collect.mv_ctx = mv_ctx;
+  collect.obj = obj;
 
-  iters = g_hash_table_lookup (timeline->priv->obj_iters, obj);
-  trackelement_iter = iters->iter_obj;
   switch (edge) {
     case GES_EDGE_START:
       /* set it properly in the context of "trimming" */
       mv_ctx->max_trim_pos = 0;
-      start = _START (obj);
-
-      if (g_sequence_iter_is_begin (trackelement_iter))
-        break;
+      collect.position = _START (obj);
 
       /* Look for the objects */
-      for (iter = g_sequence_iter_prev (trackelement_iter);
-          iter && !g_sequence_iter_is_end (iter);
-          iter = g_sequence_iter_prev (iter)) {
-
-        tmptrackelement = GES_TRACK_ELEMENT (g_sequence_get (iter));
-        tmpend = _START (tmptrackelement) + _DURATION (tmptrackelement);
-
-        if (tmpend <= start) {
-          mv_ctx->max_trim_pos =
-              MAX (mv_ctx->max_trim_pos, _START (tmptrackelement));
-          mv_ctx->moving_trackelements =
-              g_list_prepend (mv_ctx->moving_trackelements, tmptrackelement);
-        }
-
-        if (g_sequence_iter_is_begin (iter))
-          break;
-      }
+      ges_interval_tree_foreach_in_range (timeline->priv->tracksources, 0,
+          collect.position, (GESIntervalTreeFunc) _collect_moving_before,
+          &collect);
+      mv_ctx->moving_trackelements =
+          g_list_reverse (mv_ctx->moving_trackelements);
       break;
 
     case GES_EDGE_END:
     case GES_EDGE_NONE:        /* In this case only works for ripple */
-      end = _START (obj) + _DURATION (obj);
       mv_ctx->max_trim_pos = G_MAXUINT64;
+      collect.position = _START (obj) + _DURATION (obj);
 
       /* Look for folowing objects */
-      for (iter = g_sequence_iter_next (trackelement_iter);
-          iter && !g_sequence_iter_is_end (iter);
-          iter = g_sequence_iter_next (iter)) {
-        tmptrackelement = GES_TRACK_ELEMENT (g_sequence_get (iter));
-
-        if (_START (tmptrackelement) >= end) {
-          tmpend = _START (tmptrackelement) + _DURATION (tmptrackelement);
-          mv_ctx->max_trim_pos = MIN (mv_ctx->max_trim_pos, tmpend);
-          mv_ctx->moving_trackelements =
-              g_list_prepend (mv_ctx->moving_trackelements, tmptrackelement);
-        }
-      }
+      ges_interval_tree_foreach_in_range (timeline->priv->tracksources,
+          collect.position, G_MAXUINT64,
+          (GESIntervalTreeFunc) _collect_moving_after, &collect);
       break;
     default:
       GST_DEBUG ("Edge type %d no supported", edge);
       return FALSE;
   }
 
+  mv_ctx->editor = obj;
+  mv_ctx->editor_edge = collect.position;
+
   return TRUE;
 }
 
+/* Fills the freshly cleaned @mv_ctx for editing @obj */
 static gboolean
-ges_timeline_set_moving_context (GESTimeline * timeline, GESTrackElement * obj,
-    GESEditMode mode, GESEdge edge, GList * layers)
+move_context_fill (GESTimeline * timeline, MoveContext * mv_ctx,
+    GESTrackElement * obj, GESEditMode mode, GESEdge edge)
 {
   /* A TrackElement that could initiate movement for other object */
   GESTrackElement *editor_trackelement = NULL;
-  MoveContext *mv_ctx = &timeline->priv->movecontext;
   GESClip *clip = GES_CLIP (GES_TIMELINE_ELEMENT_PARENT (obj));
 
-  /* Still in the same mv_ctx */
-  if ((mv_ctx->clip == clip && mv_ctx->mode == mode &&
-          mv_ctx->edge == edge && !mv_ctx->needs_move_ctx)) {
-
-    GST_DEBUG ("Keeping the same moving mv_ctx");
-    return TRUE;
-  }
-
-  GST_DEBUG_OBJECT (clip,
-      "Changing context:\nold: obj: %p, mode: %d, edge: %d \n"
-      "new: obj: %p, mode: %d, edge: %d ! Has changed %i", mv_ctx->clip,
-      mv_ctx->mode, mv_ctx->edge, clip, mode, edge, mv_ctx->needs_move_ctx);
-
-  clean_movecontext (mv_ctx);
   mv_ctx->edge = edge;
   mv_ctx->mode = mode;
   mv_ctx->clip = clip;
@@ -1326,30 +1947,101 @@ ges_timeline_set_moving_context (GESTimeline * timeline, GESTrackElement * obj,
     switch (mode) {
       case GES_EDIT_MODE_RIPPLE:
       case GES_EDIT_MODE_ROLL:
-        if (!(ges_move_context_set_objects (timeline, editor_trackelement,
-                    edge)))
+        if (!(ges_move_context_set_objects (timeline, mv_ctx,
+                    editor_trackelement, edge)))
           return FALSE;
       default:
         break;
     }
-    add_toplevel_container (&timeline->priv->movecontext, editor_trackelement);
+    add_toplevel_container (mv_ctx, editor_trackelement);
   } else {
     /* We add the main object to the toplevel_containers set */
-    add_toplevel_container (&timeline->priv->movecontext, obj);
+    add_toplevel_container (mv_ctx, obj);
   }
 
-
   return TRUE;
 }
 
+static gboolean
+ges_timeline_set_moving_context (GESTimeline * timeline, GESTrackElement * obj,
+    GESEditMode mode, GESEdge edge, GList * layers)
+{
+  MoveContext *mv_ctx = &timeline->priv->movecontext;
+  GESClip *clip = GES_CLIP (GES_TIMELINE_ELEMENT_PARENT (obj));
+
+  flush_pending_indexes (timeline);
+
+  /* Still in the same mv_ctx */
+  if ((mv_ctx->clip == clip && mv_ctx->mode == mode &&
+          mv_ctx->edge == edge && !mv_ctx->needs_move_ctx)) {
+
+    GST_DEBUG ("Keeping the same moving mv_ctx");
+
+    if (mv_ctx->needs_max_trim_pos) {
+      GList *tmp;
+
+      mv_ctx->max_trim_pos = edge == GES_EDGE_START ? 0 : G_MAXUINT64;
+      for (tmp = mv_ctx->moving_trackelements; tmp; tmp = tmp->next) {
+        if (edge == GES_EDGE_START)
+          mv_ctx->max_trim_pos = MAX (mv_ctx->max_trim_pos, _START (tmp->data));
+        else
+          mv_ctx->max_trim_pos = MIN (mv_ctx->max_trim_pos, _END (tmp->data));
+      }
+      mv_ctx->needs_max_trim_pos = FALSE;
+    }
+
+    return TRUE;
+  }
+
+  GST_DEBUG_OBJECT (clip,
+      "Changing context:\nold: obj: %p, mode: %d, edge: %d \n"
+      "new: obj: %p, mode: %d, edge: %d ! Has changed %i", mv_ctx->clip,
+      mv_ctx->mode, mv_ctx->edge, clip, mode, edge, mv_ctx->needs_move_ctx);
+
+  clean_movecontext (mv_ctx);
+
+  return move_context_fill (timeline, mv_ctx, obj, mode, edge);
+}
+
+/* Computes the start, inpoint and duration @track_element would have after
+ * trimming its @edge to @position */
+static void
+compute_trim (GESTrackElement * track_element, GESEdge edge, guint64 position,
+    guint64 * start, guint64 * inpoint, guint64 * duration)
+{
+  gint64 real_dur;
+  guint64 max_duration;
+
+  g_object_get (track_element, "max-duration", &max_duration, NULL);
+  *start = _START (track_element);
+  *inpoint = _INPOINT (track_element);
+
+  if (edge == GES_EDGE_START) {
+    position = MIN (position, *start + _DURATION (track_element));
+    *inpoint = *inpoint + position > *start ?
+        *inpoint + position - *start : 0;
+
+    real_dur = _END (track_element) - position;
+    /* FIXME: Why CLAMP (0, real_dur, max_duration) doesn't work? */
+    *duration =
+        MIN (real_dur,
+        max_duration > *inpoint ? max_duration - *inpoint : G_MAXUINT64);
+    *start = position;
+  } else {
+    real_dur = position - *start;
+    *duration = MAX (0, real_dur);
+    *duration = MIN (*duration, max_duration - *inpoint);
+  }
+}
+
 gboolean
 ges_timeline_trim_object_simple (GESTimeline * timeline,
     GESTimelineElement * element, GList * layers, GESEdge edge,
     guint64 position, gboolean snapping)
 {
-  guint64 start, inpoint, duration, max_duration, *snapped, *cur;
+  guint64 start, inpoint, duration;
+  GESSnapEdge snapped;
   gboolean ret = TRUE;
-  gint64 real_dur;
   GESTrackElement *track_element;
 
   /* We only work with GESSource-s */
@@ -1361,9 +2053,6 @@ ges_timeline_trim_object_simple (GESTimeline * timeline,
       " %s snaping, edge %i", GST_TIME_ARGS (position),
       snapping ? "Is" : "Not", edge);
 
-  start = _START (track_element);
-  g_object_get (track_element, "max-duration", &max_duration, NULL);
-
   switch (edge) {
     case GES_EDGE_START:
     {
@@ -1389,29 +2078,15 @@ ges_timeline_trim_object_simple (GESTimeline * timeline,
             GES_CHILDREN_UPDATE_ALL_VALUES;
       }
 
-      inpoint = _INPOINT (track_element);
-      duration = _DURATION (track_element);
-
       if (snapping) {
-        cur = g_hash_table_lookup (timeline->priv->by_start, track_element);
-
-        snapped = ges_timeline_snap_position (timeline, track_element, cur,
-            position, TRUE);
-        if (snapped)
-          position = *snapped;
+        if (ges_timeline_snap_position (timeline, track_element, position,
+                TRUE, &snapped))
+          position = snapped.timecode;
       }
 
       /* Calculate new values */
-      position = MIN (position, start + duration);
-      inpoint =
-          MAX (0, inpoint + position > start ? inpoint + position - start : 0);
-
-      real_dur = _END (element) - position;
-      /* FIXME: Why CLAMP (0, real_dur, max_duration) doesn't work? */
-      duration = MAX (0, real_dur);
-      duration =
-          MIN (real_dur,
-          max_duration > inpoint ? max_duration - inpoint : G_MAXUINT64);
+      compute_trim (track_element, edge, position, &start, &inpoint,
+          &duration);
 
       /* If we already are at max duration or duration == 0 do no useless work */
       if ((duration == _DURATION (track_element) &&
@@ -1424,7 +2099,7 @@ ges_timeline_trim_object_simple (GESTimeline * timeline,
       }
 
       timeline->priv->needs_transitions_update = FALSE;
-      _set_start0 (GES_TIMELINE_ELEMENT (track_element), position);
+      _set_start0 (GES_TIMELINE_ELEMENT (track_element), start);
       _set_inpoint0 (GES_TIMELINE_ELEMENT (track_element), inpoint);
       timeline->priv->needs_transitions_update = TRUE;
 
@@ -1437,16 +2112,13 @@ ges_timeline_trim_object_simple (GESTimeline * timeline,
     }
     case GES_EDGE_END:
     {
-      cur = g_hash_table_lookup (timeline->priv->by_end, track_element);
-      snapped = ges_timeline_snap_position (timeline, track_element, cur,
-          position, TRUE);
-      if (snapped)
-        position = *snapped;
+      if (ges_timeline_snap_position (timeline, track_element, position,
+              TRUE, &snapped))
+        position = snapped.timecode;
 
       /* Calculate new values */
-      real_dur = position - start;
-      duration = MAX (0, real_dur);
-      duration = MIN (duration, max_duration - _INPOINT (track_element));
+      compute_trim (track_element, edge, position, &start, &inpoint,
+          &duration);
 
       /* Not moving, avoid overhead */
       if (duration == _DURATION (track_element)) {
@@ -1469,15 +2141,17 @@ gboolean
 timeline_ripple_object (GESTimeline * timeline, GESTrackElement * obj,
     GList * layers, GESEdge edge, guint64 position)
 {
-  GList *tmp, *moved_clips = NULL;
+  GList *tmp;
+  GHashTable *moved_clips;
   GESTrackElement *trackelement;
   GESContainer *container;
-  guint64 duration, new_start, *snapped, *cur;
+  guint64 duration, new_start;
+  GESSnapEdge snapped;
   gint64 offset;
 
   MoveContext *mv_ctx = &timeline->priv->movecontext;
 
-  mv_ctx->ignore_needs_ctx = TRUE;
+  ges_timeline_begin_edit (timeline);
 
   if (!ges_timeline_set_moving_context (timeline, obj, GES_EDIT_MODE_RIPPLE,
           edge, layers))
@@ -1488,26 +2162,25 @@ timeline_ripple_object (GESTimeline * timeline, GESTrackElement * obj,
       GST_DEBUG ("Simply rippling");
 
       /* We should be smart here to avoid recalculate transitions when possible */
-      cur = g_hash_table_lookup (timeline->priv->by_end, obj);
-      snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
-      if (snapped)
-        position = *snapped;
+      if (ges_timeline_snap_position (timeline, obj, position, TRUE, &snapped))
+        position = snapped.timecode;
 
       offset = position - _START (obj);
 
+      moved_clips = g_hash_table_new (g_direct_hash, g_direct_equal);
       for (tmp = mv_ctx->moving_trackelements; tmp; tmp = tmp->next) {
         trackelement = GES_TRACK_ELEMENT (tmp->data);
         new_start = _START (trackelement) + offset;
 
         container = add_toplevel_container (mv_ctx, trackelement);
         /* Make sure not to move 2 times the same Clip */
-        if (g_list_find (moved_clips, container) == NULL) {
+        if (!g_hash_table_contains (moved_clips, container)) {
           _set_start0 (GES_TIMELINE_ELEMENT (trackelement), new_start);
-          moved_clips = g_list_prepend (moved_clips, container);
+          g_hash_table_add (moved_clips, container);
         }
 
       }
-      g_list_free (moved_clips);
+      g_hash_table_unref (moved_clips);
       _set_start0 (GES_TIMELINE_ELEMENT (obj), position);
 
       break;
@@ -1515,20 +2188,21 @@ timeline_ripple_object (GESTimeline * timeline, GESTrackElement * obj,
       timeline->priv->needs_transitions_update = FALSE;
       GST_DEBUG ("Rippling end");
 
-      cur = g_hash_table_lookup (timeline->priv->by_end, obj);
-      snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
-      if (snapped)
-        position = *snapped;
+      if (ges_timeline_snap_position (timeline, obj, position, TRUE, &snapped))
+        position = snapped.timecode;
 
       duration = _DURATION (obj);
 
       if (!ges_timeline_trim_object_simple (timeline,
               GES_TIMELINE_ELEMENT (obj), NULL, GES_EDGE_END, position,
               FALSE)) {
-        return FALSE;
+        timeline->priv->needs_transitions_update = TRUE;
+
+        goto error;
       }
 
       offset = _DURATION (obj) - duration;
+      moved_clips = g_hash_table_new (g_direct_hash, g_direct_equal);
       for (tmp = mv_ctx->moving_trackelements; tmp; tmp = tmp->next) {
         trackelement = GES_TRACK_ELEMENT (tmp->data);
         new_start = _START (trackelement) + offset;
@@ -1537,16 +2211,16 @@ timeline_ripple_object (GESTimeline * timeline, GESTrackElement * obj,
         if (GES_IS_GROUP (container))
           container->children_control_mode = GES_CHILDREN_UPDATE_OFFSETS;
         /* Make sure not to move 2 times the same Clip */
-        if (g_list_find (moved_clips, container) == NULL) {
+        if (!g_hash_table_contains (moved_clips, container)) {
           _set_start0 (GES_TIMELINE_ELEMENT (trackelement), new_start);
-          moved_clips = g_list_prepend (moved_clips, container);
+          g_hash_table_add (moved_clips, container);
         }
         if (GES_IS_GROUP (container))
           container->children_control_mode = GES_CHILDREN_UPDATE;
 
       }
 
-      g_list_free (moved_clips);
+      g_hash_table_unref (moved_clips);
       timeline->priv->needs_transitions_update = TRUE;
       GST_DEBUG ("Done Rippling end");
       break;
@@ -1560,13 +2234,12 @@ timeline_ripple_object (GESTimeline * timeline, GESTrackElement * obj,
 
       break;
   }
-
-  mv_ctx->ignore_needs_ctx = FALSE;
+  ges_timeline_end_edit (timeline);
 
   return TRUE;
 
 error:
-  mv_ctx->ignore_needs_ctx = FALSE;
+  ges_timeline_end_edit (timeline);
 
   return FALSE;
 }
@@ -1586,22 +2259,12 @@ gboolean
 timeline_trim_object (GESTimeline * timeline, GESTrackElement * object,
     GList * layers, GESEdge edge, guint64 position)
 {
-  gboolean ret = FALSE;
-  MoveContext *mv_ctx = &timeline->priv->movecontext;
-
-  mv_ctx->ignore_needs_ctx = TRUE;
-
   if (!ges_timeline_set_moving_context (timeline, object, GES_EDIT_MODE_TRIM,
           edge, layers))
-    goto end;
+    return FALSE;
 
-  ret = ges_timeline_trim_object_simple (timeline,
+  return ges_timeline_trim_object_simple (timeline,
       GES_TIMELINE_ELEMENT (object), layers, edge, position, TRUE);
-
-end:
-  mv_ctx->ignore_needs_ctx = FALSE;
-
-  return ret;
 }
 
 gboolean
@@ -1609,11 +2272,12 @@ timeline_roll_object (GESTimeline * timeline, GESTrackElement * obj,
     GList * layers, GESEdge edge, guint64 position)
 {
   MoveContext *mv_ctx = &timeline->priv->movecontext;
-  guint64 start, duration, end, tmpstart, tmpduration, tmpend, *snapped, *cur;
+  guint64 start, duration, end, tmpstart, tmpduration, tmpend;
+  GESSnapEdge snapped;
   gboolean ret = TRUE;
   GList *tmp;
 
-  mv_ctx->ignore_needs_ctx = TRUE;
+  ges_timeline_begin_edit (timeline);
 
   GST_DEBUG_OBJECT (obj, "Rolling object to %" GST_TIME_FORMAT,
       GST_TIME_ARGS (position));
@@ -1634,10 +2298,8 @@ timeline_roll_object (GESTimeline * timeline, GESTrackElement * obj,
       if (position < mv_ctx->max_trim_pos || position > end)
         goto error;
 
-      cur = g_hash_table_lookup (timeline->priv->by_start, obj);
-      snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
-      if (snapped)
-        position = *snapped;
+      if (ges_timeline_snap_position (timeline, obj, position, TRUE, &snapped))
+        position = snapped.timecode;
 
       ret &= ges_timeline_trim_object_simple (timeline,
           GES_TIMELINE_ELEMENT (obj), layers, GES_EDGE_START, position, FALSE);
@@ -1671,10 +2333,8 @@ timeline_roll_object (GESTimeline * timeline, GESTrackElement * obj,
 
       end = _START (obj) + _DURATION (obj);
 
-      cur = g_hash_table_lookup (timeline->priv->by_end, obj);
-      snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
-      if (snapped)
-        position = *snapped;
+      if (ges_timeline_snap_position (timeline, obj, position, TRUE, &snapped))
+        position = snapped.timecode;
 
       ret &= ges_timeline_trim_object_simple (timeline,
           GES_TIMELINE_ELEMENT (obj), NULL, GES_EDGE_END, position, FALSE);
@@ -1711,7 +2371,7 @@ timeline_roll_object (GESTimeline * timeline, GESTrackElement * obj,
 
 done:
   timeline->priv->needs_transitions_update = TRUE;
-  mv_ctx->ignore_needs_ctx = FALSE;
+  ges_timeline_end_edit (timeline);
 
   return ret;
 
@@ -1744,46 +2404,47 @@ ges_timeline_move_object_simple (GESTimeline * timeline,
     GESTimelineElement * element, GList * layers, GESEdge edge,
     guint64 position)
 {
-  guint64 *snap_end, *snap_st, *cur, off1, off2, end;
+  guint64 off1, off2, end;
+  GESSnapEdge snap_end, snap_st;
+  gboolean snapped_end, snapped_st;
   GESTrackElement *track_element;
 
   /* We only work with GESSource-s and we check that we are not already moving
    * element ourself*/
   if (GES_IS_SOURCE (element) == FALSE ||
-      g_list_find (timeline->priv->movecontext.moving_trackelements, element))
+      g_hash_table_contains (timeline->priv->movecontext.moving_set, element))
     return FALSE;
 
   track_element = GES_TRACK_ELEMENT (element);
   end = position + _DURATION (get_toplevel_container (track_element));
-  cur = g_hash_table_lookup (timeline->priv->by_end, track_element);
 
   GST_DEBUG_OBJECT (timeline, "Moving %" GST_PTR_FORMAT "to %"
       GST_TIME_FORMAT " (end %" GST_TIME_FORMAT ")", element,
       GST_TIME_ARGS (position), GST_TIME_ARGS (end));
 
-  snap_end = ges_timeline_snap_position (timeline, track_element, cur, end,
-      FALSE);
-  if (snap_end)
-    off1 = end > *snap_end ? end - *snap_end : *snap_end - end;
+  snapped_end = ges_timeline_snap_position (timeline, track_element, end,
+      FALSE, &snap_end);
+  if (snapped_end)
+    off1 = end > snap_end.timecode ?
+        end - snap_end.timecode : snap_end.timecode - end;
   else
     off1 = G_MAXUINT64;
 
-  cur = g_hash_table_lookup (timeline->priv->by_start, track_element);
-  snap_st =
-      ges_timeline_snap_position (timeline, track_element, cur, position,
-      FALSE);
-  if (snap_st)
-    off2 = position > *snap_st ? position - *snap_st : *snap_st - position;
+  snapped_st = ges_timeline_snap_position (timeline, track_element, position,
+      FALSE, &snap_st);
+  if (snapped_st)
+    off2 = position > snap_st.timecode ?
+        position - snap_st.timecode : snap_st.timecode - position;
   else
     off2 = G_MAXUINT64;
 
   /* In the case we could snap on both sides, we snap on the end */
-  if (snap_end && off1 <= off2) {
-    position = position + *snap_end - end;
-    ges_timeline_emit_snappig (timeline, track_element, snap_end);
-  } else if (snap_st) {
-    position = position + *snap_st - position;
-    ges_timeline_emit_snappig (timeline, track_element, snap_st);
+  if (snapped_end && off1 <= off2) {
+    position = position + snap_end.timecode - end;
+    ges_timeline_emit_snappig (timeline, track_element, &snap_end);
+  } else if (snapped_st) {
+    position = snap_st.timecode;
+    ges_timeline_emit_snappig (timeline, track_element, &snap_st);
   } else
     ges_timeline_emit_snappig (timeline, track_element, NULL);
 
@@ -1799,8 +2460,6 @@ timeline_context_to_layer (GESTimeline * timeline, gint offset)
   gboolean ret = TRUE;
   MoveContext *mv_ctx = &timeline->priv->movecontext;
 
-
-
   /* Layer's priority is always positive */
   if (offset != 0 && (offset > 0 || mv_ctx->min_move_layer >= -offset)) {
     GHashTableIter iter;
@@ -1808,7 +2467,6 @@ timeline_context_to_layer (GESTimeline * timeline, gint offset)
     GESLayer *new_layer;
     guint prio;
 
-    mv_ctx->ignore_needs_ctx = TRUE;
 
     GST_DEBUG ("Moving %d object, offset %d",
         g_hash_table_size (mv_ctx->toplevel_containers), offset);
@@ -1821,8 +2479,7 @@ timeline_context_to_layer (GESTimeline * timeline, gint offset)
         prio = ges_clip_get_layer_priority (GES_CLIP (value));
 
         /* We know that the layer exists as we created it */
-        new_layer =
-            GES_LAYER (g_list_nth_data (timeline->layers, prio + offset));
+        new_layer = timeline_get_layer_by_prio (timeline, prio + offset);
 
         if (new_layer == NULL) {
           do {
@@ -1835,7 +2492,7 @@ timeline_context_to_layer (GESTimeline * timeline, gint offset)
         guint32 last_prio = _PRIORITY (value) + offset +
             GES_CONTAINER_HEIGHT (value) - 1;
 
-        new_layer = GES_LAYER (g_list_nth_data (timeline->layers, last_prio));
+        new_layer = timeline_get_layer_by_prio (timeline, last_prio);
 
         if (new_layer == NULL) {
           do {
@@ -1851,7 +2508,6 @@ timeline_context_to_layer (GESTimeline * timeline, gint offset)
     /* Readjust min_move_layer */
     mv_ctx->min_move_layer = mv_ctx->min_move_layer + offset;
 
-    mv_ctx->ignore_needs_ctx = FALSE;
   }
 
   return ret;
@@ -2064,6 +2720,43 @@ clip_track_element_removed_cb (GESClip * clip,
     ges_track_remove_element (track, track_element);
 }
 
+static void
+clip_times_changed_cb (GESClip * clip, GParamSpec * arg G_GNUC_UNUSED,
+    GESTimeline * timeline)
+{
+  ClipIters *iters = g_hash_table_lookup (timeline->priv->clip_iters, clip);
+
+  if (G_LIKELY (iters))
+    ges_interval_tree_update (iters->tree, iters->node, _START (clip),
+        _END (clip));
+}
+
+static void
+stop_tracking_clip (GESTimeline * timeline, GESClip * clip)
+{
+  g_signal_handlers_disconnect_by_func (clip, clip_times_changed_cb, timeline);
+  g_hash_table_remove (timeline->priv->clip_iters, clip);
+}
+
+static void
+start_tracking_clip (GESTimeline * timeline, GESLayer * layer, GESClip * clip)
+{
+  ClipIters *iters;
+
+  stop_tracking_clip (timeline, clip);
+
+  iters = g_slice_new (ClipIters);
+  iters->tree = g_hash_table_lookup (timeline->priv->clips_by_layer, layer);
+  iters->node = ges_interval_tree_insert (iters->tree, clip, _START (clip),
+      _END (clip));
+  g_hash_table_insert (timeline->priv->clip_iters, clip, iters);
+
+  g_signal_connect (clip, "notify::start",
+      G_CALLBACK (clip_times_changed_cb), timeline);
+  g_signal_connect (clip, "notify::duration",
+      G_CALLBACK (clip_times_changed_cb), timeline);
+}
+
 static void
 layer_object_added_cb (GESLayer * layer, GESClip * clip, GESTimeline * timeline)
 {
@@ -2081,6 +2774,8 @@ layer_object_added_cb (GESLayer * layer, GESClip * clip, GESTimeline * timeline)
   g_signal_connect (clip, "child-removed",
       G_CALLBACK (clip_track_element_removed_cb), timeline);
 
+  start_tracking_clip (timeline, layer, clip);
+
   if (ges_clip_is_moving_from_layer (clip)) {
     GST_DEBUG ("Clip %p moving from one layer to another, not creating "
         "TrackElement", clip);
@@ -2102,12 +2797,20 @@ layer_object_added_cb (GESLayer * layer, GESClip * clip, GESTimeline * timeline)
   GST_DEBUG ("Done");
 }
 
-static void
-layer_priority_changed_cb (GESLayer * layer,
-    GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
+/* Called by @layer when its priority changes, only @layer is moved in the
+ * gnonlin priority space, and only if it is out of order, so that this does
+ * not depend on the number of clips in the other layers.
+ *
+ * When @layer does get a new base, only its layer compositions are moved if
+ * all the tracks use them, otherwise all of its clips are resynced, see
+ * _ges_layer_set_gnl_priority_base */
+void
+timeline_layer_priority_changed (GESTimeline * timeline, GESLayer * layer)
 {
-  timeline->layers = g_list_sort (timeline->layers, (GCompareFunc)
-      sort_layers);
+  /* Only @layer is out of place, move it to its new place */
+  g_ptr_array_remove (timeline->priv->layers_by_prio, layer);
+  timeline->layers = g_list_remove (timeline->layers, layer);
+  timeline_insert_layer_sorted (timeline, layer, TRUE);
 }
 
 static void
@@ -2116,6 +2819,8 @@ layer_object_removed_cb (GESLayer * layer, GESClip * clip,
 {
   GList *trackelements, *tmp;
 
+  stop_tracking_clip (timeline, clip);
+
   if (ges_clip_is_moving_from_layer (clip)) {
     GST_DEBUG ("Clip %p is moving from a layer to another, not doing"
         " anything on it", clip);
@@ -2164,25 +2869,20 @@ trackelement_start_changed_cb (GESTrackElement * child,
   GESTimelinePrivate *priv = timeline->priv;
   TrackObjIters *iters = g_hash_table_lookup (priv->obj_iters, child);
 
-  if (G_LIKELY (iters->iter_by_layer))
-    g_sequence_sort_changed (iters->iter_by_layer,
-        (GCompareDataFunc) element_start_compare, NULL);
-
-  if (GES_IS_SOURCE (child)) {
-    sort_track_elements (timeline, iters);
-    sort_starts_ends_start (timeline, iters);
-    sort_starts_ends_end (timeline, iters);
-
-    /* If the timeline is set to snap objects together, we
-     * are sure that all movement of TrackElement-s are done within
-     * the moving context, so we do not need to recalculate the
-     * move context as often */
-    if (timeline->priv->movecontext.ignore_needs_ctx &&
-        timeline->priv->snapping_distance == 0)
-      timeline->priv->movecontext.needs_move_ctx = TRUE;
+  if (priv->edit_depth) {
+    g_hash_table_add (priv->pending_indexes, child);
+  } else {
+    update_track_element_intervals (timeline, iters);
 
-    create_transitions (timeline, child);
+    if (GES_IS_SOURCE (child)) {
+      update_snap_edges (timeline, iters);
+      move_context_source_moved (timeline, child);
+      move_context_check_editor_edge (timeline);
+    }
   }
+
+  if (GES_IS_SOURCE (child))
+    create_transitions (timeline, child);
 }
 
 static void
@@ -2191,10 +2891,8 @@ trackelement_priority_changed_cb (GESTrackElement * child,
 {
   GESTimelinePrivate *priv = timeline->priv;
 
-  GList *layer_node = g_list_find_custom (timeline->layers,
-      GINT_TO_POINTER (_ges_track_element_get_layer_priority (child)),
-      (GCompareFunc) find_layer_by_prio);
-  GESLayer *layer = layer_node ? layer_node->data : NULL;
+  GESLayer *layer = timeline_get_layer_by_prio (timeline,
+      _ges_track_element_get_layer_priority (child));
   TrackObjIters *iters = g_hash_table_lookup (priv->obj_iters,
       child);
 
@@ -2202,33 +2900,28 @@ trackelement_priority_changed_cb (GESTrackElement * child,
     GST_ERROR_OBJECT (timeline,
         "Changing a TrackElement prio, which would not "
         "land in no layer we are controlling");
-    g_sequence_remove (iters->iter_by_layer);
-    iters->iter_by_layer = NULL;
+    if (iters->node_by_layer)
+      ges_interval_tree_remove (g_hash_table_lookup (priv->by_layer,
+              iters->layer), iters->node_by_layer);
+    iters->node_by_layer = NULL;
     iters->layer = NULL;
-  } else {
+  } else if (layer != iters->layer) {
     /* If it moves from layer, properly change it */
-    if (layer != iters->layer) {
-      GSequence *by_layer_sequence =
-          g_hash_table_lookup (priv->by_layer, layer);
-
-      GST_DEBUG_OBJECT (child, "Moved from layer %" GST_PTR_FORMAT
-          "(prio %d) to" " %" GST_PTR_FORMAT " (prio %d)", layer,
-          ges_layer_get_priority (layer), iters->layer,
-          ges_layer_get_priority (iters->layer));
-
-      g_sequence_remove (iters->iter_by_layer);
-      iters->iter_by_layer =
-          g_sequence_insert_sorted (by_layer_sequence, child,
-          (GCompareDataFunc) element_start_compare, NULL);
-      iters->layer = layer;
-    } else {
-      g_sequence_sort_changed (iters->iter_by_layer,
-          (GCompareDataFunc) element_start_compare, NULL);
-    }
+    GESIntervalTree *by_layer_tree = g_hash_table_lookup (priv->by_layer,
+        layer);
+
+    GST_DEBUG_OBJECT (child, "Moved from layer %" GST_PTR_FORMAT
+        "(prio %d) to" " %" GST_PTR_FORMAT " (prio %d)", iters->layer,
+        iters->layer ? ges_layer_get_priority (iters->layer) : -1, layer,
+        ges_layer_get_priority (layer));
+
+    if (iters->node_by_layer)
+      ges_interval_tree_remove (g_hash_table_lookup (priv->by_layer,
+              iters->layer), iters->node_by_layer);
+    iters->node_by_layer = ges_interval_tree_insert (by_layer_tree, child,
+        _START (child), _END (child));
+    iters->layer = layer;
   }
-
-  if (GES_IS_SOURCE (child))
-    sort_track_elements (timeline, iters);
 }
 
 static void
@@ -2238,20 +2931,20 @@ trackelement_duration_changed_cb (GESTrackElement * child,
   GESTimelinePrivate *priv = timeline->priv;
   TrackObjIters *iters = g_hash_table_lookup (priv->obj_iters, child);
 
-  if (GES_IS_SOURCE (child)) {
-    sort_starts_ends_end (timeline, iters);
+  if (priv->edit_depth) {
+    g_hash_table_add (priv->pending_indexes, child);
+  } else {
+    update_track_element_intervals (timeline, iters);
 
-    /* If the timeline is set to snap objects together, we
-     * are sure that all movement of TrackElement-s are done within
-     * the moving context, so we do not need to recalculate the
-     * move context as often */
-    if (timeline->priv->movecontext.ignore_needs_ctx &&
-        timeline->priv->snapping_distance == 0) {
-      timeline->priv->movecontext.needs_move_ctx = TRUE;
+    if (GES_IS_SOURCE (child)) {
+      update_snap_edges (timeline, iters);
+      move_context_source_moved (timeline, child);
+      move_context_check_editor_edge (timeline);
     }
+  }
 
+  if (GES_IS_SOURCE (child))
     create_transitions (timeline, child);
-  }
 }
 
 static void
@@ -2564,21 +3257,21 @@ ges_timeline_add_layer (GESTimeline * timeline, GESLayer * layer)
   }
 
   gst_object_ref_sink (layer);
-  timeline->layers = g_list_insert_sorted (timeline->layers, layer,
-      (GCompareFunc) sort_layers);
+  timeline_insert_layer_sorted (timeline, layer, FALSE);
 
   /* Inform the layer that it belongs to a new timeline */
   ges_layer_set_timeline (layer, timeline);
 
-  g_hash_table_insert (timeline->priv->by_layer, layer, g_sequence_new (NULL));
+  g_hash_table_insert (timeline->priv->by_layer, layer,
+      ges_interval_tree_new (NULL));
+  g_hash_table_insert (timeline->priv->clips_by_layer, layer,
+      ges_interval_tree_new (NULL));
 
   /* Connect to 'clip-added'/'clip-removed' signal from the new layer */
   g_signal_connect (layer, "clip-added", G_CALLBACK (layer_object_added_cb),
       timeline);
   g_signal_connect (layer, "clip-removed",
       G_CALLBACK (layer_object_removed_cb), timeline);
-  g_signal_connect (layer, "notify::priority",
-      G_CALLBACK (layer_priority_changed_cb), timeline);
   g_signal_connect (layer, "notify::auto-transition",
       G_CALLBACK (layer_auto_transition_changed_cb), timeline);
 
@@ -2636,12 +3329,12 @@ ges_timeline_remove_layer (GESTimeline * timeline, GESLayer * layer)
   g_signal_handlers_disconnect_by_func (layer, layer_object_added_cb, timeline);
   g_signal_handlers_disconnect_by_func (layer, layer_object_removed_cb,
       timeline);
-  g_signal_handlers_disconnect_by_func (layer, layer_priority_changed_cb,
-      timeline);
   g_signal_handlers_disconnect_by_func (layer,
       layer_auto_transition_changed_cb, timeline);
 
   g_hash_table_remove (timeline->priv->by_layer, layer);
+  g_hash_table_remove (timeline->priv->clips_by_layer, layer);
+  g_ptr_array_remove (timeline->priv->layers_by_prio, layer);
   timeline->layers = g_list_remove (timeline->layers, layer);
   ges_layer_set_timeline (layer, NULL);
 
@@ -2705,6 +3398,8 @@ ges_timeline_add_track (GESTimeline * timeline, GESTrack * track)
 
   /* Inform the track that it's currently being used by ourself */
   ges_track_set_timeline (track, timeline);
+  if (timeline->priv->edit_depth)
+    ges_track_begin_edit (track);
 
   GST_DEBUG ("Done adding track, emitting 'track-added' signal");
 
@@ -2731,6 +3426,11 @@ ges_timeline_add_track (GESTimeline * timeline, GESTrack * track)
       gst_object_unref (clip);
     }
     g_list_free (objects);
+
+    /* The layer might have been rebased while all the tracks were using
+     * layer compositions */
+    if (!ges_track_get_layer_compositions (track))
+      _ges_layer_sync_clips_base (tmp->data);
   }
 
   /* FIXME Check if we should rollback if we can't sync state */
@@ -2782,6 +3482,8 @@ ges_timeline_remove_track (GESTimeline * timeline, GESTrack * track)
   UNLOCK_DYN (timeline);
   timeline->tracks = g_list_remove (timeline->tracks, track);
 
+  if (priv->edit_depth)
+    ges_track_end_edit (track);
   ges_track_set_timeline (track, NULL);
 
   /* Remove ghost pad */
@@ -2880,56 +3582,969 @@ ges_timeline_get_tracks (GESTimeline * timeline)
 GList *
 ges_timeline_get_layers (GESTimeline * timeline)
 {
-  GList *tmp, *res = NULL;
-
-  for (tmp = timeline->layers; tmp; tmp = g_list_next (tmp)) {
-    res = g_list_insert_sorted (res, gst_object_ref (tmp->data),
-        (GCompareFunc) sort_layers);
-  }
-
-  return res;
+  return g_list_copy_deep (timeline->layers, (GCopyFunc) gst_object_ref, NULL);
 }
 
 /**
- * ges_timeline_commit:
+ * ges_timeline_range_iter_init:
+ * @iter: an uninitialized #GESTimelineRangeIter
  * @timeline: a #GESTimeline
+ * @start: the start of the range
+ * @end: the end of the range
+ * @layer_min: the priority of the first layer to look into
+ * @layer_max: the priority of the last layer to look into
  *
- * Commits all the pending changes of the clips contained in the
- * @timeline.
+ * Initializes @iter to walk over the #GESClip-s of the layers of priority
+ * between @layer_min and @layer_max that touch [@start, @end], meaning
+ * that they neither start after @end nor end before @start.
  *
- * When timing changes happen in a timeline, the changes are not
- * directly done inside GNL. This method needs to be called so any changes
- * on a clip contained in the timeline actually happen at the media
- * processing level.
+ * The clips are found through an index of the timeline, walking over them
+ * costs O(log(n)) per layer, plus the number of clips in the range. It
+ * does not allocate any memory, which makes it suitable for culling the
+ * clips of a timeline view on each redraw.
  *
- * Returns: %TRUE if something as been commited %FALSE if nothing needed
- * to be commited
+ * The timeline must not be modified while iterating.
+ *
+ * |[
+ * GESTimelineRangeIter iter;
+ * GESTimelineElement *clip;
+ *
+ * ges_timeline_range_iter_init (&iter, timeline, start, end, 0, G_MAXUINT);
+ * while (ges_timeline_range_iter_next (&iter, &clip)) {
+ *   // draw the clip
+ * }
+ * ]|
+ */
+void
+ges_timeline_range_iter_init (GESTimelineRangeIter * iter,
+    GESTimeline * timeline, GstClockTime start, GstClockTime end,
+    guint layer_min, guint layer_max)
+{
+  RealRangeIter *ri = (RealRangeIter *) iter;
+
+  g_return_if_fail (iter != NULL);
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+  g_return_if_fail (start <= end);
+
+  ri->timeline = timeline;
+  ri->node = NULL;
+  ri->start = start;
+  ri->end = end;
+  ri->layer = layer_index_for_prio (timeline, layer_min);
+  ri->layer_end = layer_max == G_MAXUINT ? timeline->priv->layers_by_prio->len
+      : layer_index_for_prio (timeline, layer_max + 1);
+}
+
+/**
+ * ges_timeline_range_iter_next:
+ * @iter: an initialized #GESTimelineRangeIter
+ * @clip: (out) (transfer none) (allow-none): a location to store the next
+ * clip
+ *
+ * Advances @iter and retrieves the next clip. The clips are sorted by
+ * layer priority, and by start inside of a layer.
+ *
+ * Returns: %FALSE if the end of the range has been reached
  */
 gboolean
-ges_timeline_commit (GESTimeline * timeline)
+ges_timeline_range_iter_next (GESTimelineRangeIter * iter,
+    GESTimelineElement ** clip)
 {
-  GList *tmp;
-  gboolean res = TRUE;
+  GESLayer *layer;
+  GESIntervalTree *tree;
+  RealRangeIter *ri = (RealRangeIter *) iter;
+
+  g_return_val_if_fail (iter != NULL, FALSE);
+
+  do {
+    if (ri->node) {
+      ri->node = ges_interval_node_next_overlapping (ri->node, ri->start,
+          ri->end);
+    } else if (ri->layer < ri->layer_end) {
+      layer = g_ptr_array_index (ri->timeline->priv->layers_by_prio,
+          ri->layer);
+      tree = g_hash_table_lookup (ri->timeline->priv->clips_by_layer, layer);
+      ri->node = ges_interval_tree_first_overlapping (tree, ri->start,
+          ri->end);
+      ri->layer++;
+    } else {
+      return FALSE;
+    }
+  } while (ri->node == NULL);
 
-  GST_DEBUG_OBJECT (timeline, "commiting changes");
+  if (clip)
+    *clip = ges_interval_node_get_data (ri->node);
 
-  for (tmp = timeline->layers; tmp; tmp = tmp->next) {
-    _create_transitions_on_layer (timeline, GES_LAYER (tmp->data),
-        NULL, NULL, _find_transition_from_auto_transitions);
-  }
+  return TRUE;
+}
 
-  for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
-    if (!ges_track_commit (GES_TRACK (tmp->data)))
-      res = FALSE;
-  }
+/**
+ * ges_timeline_get_elements_in_range:
+ * @timeline: a #GESTimeline
+ * @start: the start of the range
+ * @end: the end of the range
+ * @layer_min: the priority of the first layer to look into
+ * @layer_max: the priority of the last layer to look into
+ *
+ * Gets the #GESClip-s of the layers of priority between @layer_min and
+ * @layer_max that touch [@start, @end]. See #ges_timeline_range_iter_init
+ * for a way to do so without allocating a list.
+ *
+ * Returns: (transfer full) (element-type GESTimelineElement): the clips
+ * sorted by layer priority, and by start inside of a layer. The caller
+ * should unref each clip once done with them.
+ */
+GList *
+ges_timeline_get_elements_in_range (GESTimeline * timeline,
+    GstClockTime start, GstClockTime end, guint layer_min, guint layer_max)
+{
+  GESTimelineRangeIter iter;
+  GESTimelineElement *clip;
+  GList *res = NULL;
 
-  /* Make sure we reset the context */
-  timeline->priv->movecontext.needs_move_ctx = TRUE;
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+  g_return_val_if_fail (start <= end, NULL);
 
-  if (res)
-    g_signal_emit (timeline, ges_timeline_signals[COMMITED], 0);
+  ges_timeline_range_iter_init (&iter, timeline, start, end, layer_min,
+      layer_max);
+  while (ges_timeline_range_iter_next (&iter, &clip))
+    res = g_list_prepend (res, gst_object_ref (clip));
 
-  return res;
+  return g_list_reverse (res);
+}
+
+static void
+_clear_preview_entry (GESEditPreviewEntry * entry)
+{
+  gst_object_unref (entry->element);
+}
+
+/* @seen is the set of elements already in @preview, as the same clip can
+ * be reached through each of its sources */
+static void
+preview_add_entry (GESEditPreview * preview, GHashTable * seen,
+    GESTimelineElement * element, guint64 start, guint64 duration)
+{
+  GESEditPreviewEntry entry;
+
+  if (g_hash_table_contains (seen, element))
+    return;
+  g_hash_table_add (seen, element);
+
+  entry.element = gst_object_ref (element);
+  entry.start = start;
+  entry.duration = duration;
+
+  if (GES_IS_CLIP (element))
+    entry.layer_priority = ges_clip_get_layer_priority (GES_CLIP (element));
+  else
+    entry.layer_priority = _PRIORITY (element);
+
+  g_array_append_val (preview->entries, entry);
+}
+
+/* Adds the clip of @element trimmed as in ges_timeline_trim_object_simple */
+static gboolean
+preview_add_trimmed (GESEditPreview * preview, GHashTable * seen,
+    GESTrackElement * element, GESEdge edge, guint64 position)
+{
+  guint64 start, inpoint, duration;
+
+  compute_trim (element, edge, position, &start, &inpoint, &duration);
+  if (duration == _DURATION (element))
+    return FALSE;
+
+  preview_add_entry (preview, seen, GES_TIMELINE_ELEMENT_PARENT (element),
+      start, duration);
+
+  return TRUE;
+}
+
+/* Adds the toplevel container of @element moved by @offset */
+static void
+preview_add_moved (GESEditPreview * preview, GHashTable * seen,
+    GESTrackElement * element, gint64 offset)
+{
+  GESContainer *container = get_toplevel_container (element);
+
+  preview_add_entry (preview, seen, GES_TIMELINE_ELEMENT (container),
+      _START (container) + offset, _DURATION (container));
+}
+
+static void
+preview_set_snapped (GESEditPreview * preview, const GESSnapEdge * snapped)
+{
+  preview->snapped = TRUE;
+  preview->snapped_element = gst_object_ref (snapped->data);
+  preview->snap_time = snapped->timecode;
+}
+
+static guint64
+preview_snap (GESTimeline * timeline, GESEditPreview * preview,
+    GESTrackElement * element, guint64 position)
+{
+  GESSnapEdge snapped;
+
+  if (!ges_timeline_snap_position (timeline, element, position, FALSE,
+          &snapped))
+    return position;
+
+  preview_set_snapped (preview, &snapped);
+
+  return snapped.timecode;
+}
+
+/* Snaps on both edges, as ges_timeline_move_object_simple */
+static guint64
+preview_snap_move (GESTimeline * timeline, GESEditPreview * preview,
+    GESTrackElement * element, guint64 position)
+{
+  guint64 off1 = G_MAXUINT64, off2 = G_MAXUINT64, end;
+  GESSnapEdge snap_end, snap_st;
+
+  end = position + _DURATION (get_toplevel_container (element));
+  if (ges_timeline_snap_position (timeline, element, end, FALSE, &snap_end))
+    off1 = end > snap_end.timecode ?
+        end - snap_end.timecode : snap_end.timecode - end;
+
+  if (ges_timeline_snap_position (timeline, element, position, FALSE,
+          &snap_st))
+    off2 = position > snap_st.timecode ?
+        position - snap_st.timecode : snap_st.timecode - position;
+
+  if (off1 != G_MAXUINT64 && off1 <= off2) {
+    preview_set_snapped (preview, &snap_end);
+    position = position + snap_end.timecode - end;
+  } else if (off2 != G_MAXUINT64) {
+    preview_set_snapped (preview, &snap_st);
+    position = snap_st.timecode;
+  }
+
+  return position;
+}
+
+/* Fills @preview with what the timeline_*_object editing functions would
+ * do, using @mv_ctx as move context */
+static gboolean
+preview_edit_track_element (GESTimeline * timeline, MoveContext * mv_ctx,
+    GESEditPreview * preview, GHashTable * seen, GESTrackElement * obj,
+    GESEditMode mode, GESEdge edge, guint64 position)
+{
+  GList *tmp;
+  guint64 start, end, inpoint, duration;
+
+  start = _START (obj);
+  end = _END (obj);
+
+  switch (mode) {
+    case GES_EDIT_MODE_NORMAL:
+      position = preview_snap_move (timeline, preview, obj, position);
+      preview_add_moved (preview, seen, obj, position - start);
+      break;
+    case GES_EDIT_MODE_TRIM:
+      if (edge != GES_EDGE_START && edge != GES_EDGE_END)
+        return FALSE;
+
+      position = preview_snap (timeline, preview, obj, position);
+      return preview_add_trimmed (preview, seen, obj, edge, position);
+    case GES_EDIT_MODE_RIPPLE:
+      if (edge == GES_EDGE_START) {
+        position = preview_snap (timeline, preview, obj, position);
+        return preview_add_trimmed (preview, seen, obj, edge, position);
+      }
+
+      position = preview_snap (timeline, preview, obj, position);
+      if (edge == GES_EDGE_NONE) {
+        preview_add_moved (preview, seen, obj, position - start);
+        for (tmp = mv_ctx->moving_trackelements; tmp; tmp = tmp->next)
+          preview_add_moved (preview, seen, tmp->data, position - start);
+      } else if (edge == GES_EDGE_END) {
+        if (!preview_add_trimmed (preview, seen, obj, edge, position))
+          return FALSE;
+
+        compute_trim (obj, edge, position, &start, &inpoint, &duration);
+        for (tmp = mv_ctx->moving_trackelements; tmp; tmp = tmp->next)
+          preview_add_moved (preview, seen, tmp->data,
+              (gint64) duration - (gint64) _DURATION (obj));
+      } else {
+        return FALSE;
+      }
+      break;
+    case GES_EDIT_MODE_ROLL:
+      if (edge == GES_EDGE_START) {
+        if (position < mv_ctx->max_trim_pos || position > end)
+          return FALSE;
+
+        position = preview_snap (timeline, preview, obj, position);
+        compute_trim (obj, edge, position, &position, &inpoint, &duration);
+        preview_add_entry (preview, seen, GES_TIMELINE_ELEMENT_PARENT (obj),
+            position, duration);
+
+        for (tmp = mv_ctx->moving_trackelements; tmp; tmp = tmp->next) {
+          if (_END (tmp->data) == start) {
+            preview_add_trimmed (preview, seen, tmp->data, GES_EDGE_END,
+                position);
+            break;
+          }
+        }
+      } else if (edge == GES_EDGE_END) {
+        if (position > mv_ctx->max_trim_pos || position < start)
+          return FALSE;
+
+        position = preview_snap (timeline, preview, obj, position);
+        if (!preview_add_trimmed (preview, seen, obj, edge, position))
+          return FALSE;
+
+        compute_trim (obj, edge, position, &start, &inpoint, &duration);
+        position = start + duration;
+
+        for (tmp = mv_ctx->moving_trackelements; tmp; tmp = tmp->next) {
+          if (_START (tmp->data) == end)
+            preview_add_trimmed (preview, seen, tmp->data, GES_EDGE_START,
+                position);
+        }
+      } else {
+        return FALSE;
+      }
+      break;
+    default:
+      GST_FIXME_OBJECT (timeline, "Can not preview edit mode %d", mode);
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * ges_timeline_preview_edit:
+ * @timeline: a #GESTimeline
+ * @clip: the #GESClip to edit
+ * @new_layer_priority: The priority of the layer @clip should land in.
+ * If the layer you're trying to move the clip to doesn't exist, it will
+ * be created automatically. -1 means no move.
+ * @mode: The #GESEditMode in which the editition will happen.
+ * @edge: The #GESEdge the edit should happen on.
+ * @position: The position at which to edit @clip (in nanosecond)
+ *
+ * Computes what #ges_container_edit would do to the timeline with the same
+ * arguments, without modifying anything and without emitting the snapping
+ * signals. This allows showing the result of an edit while the user is
+ * dragging a clip around, and only actually editing the timeline once the
+ * drag is over.
+ *
+ * The edit is computed in its own context, so previewing does not disturb
+ * an edit in progress, such as an interactive drag.
+ *
+ * Returns: (transfer full) (allow-none): the #GESEditPreview of the edit, to
+ * free with #ges_edit_preview_free, or %NULL if the edit would fail.
+ */
+GESEditPreview *
+ges_timeline_preview_edit (GESTimeline * timeline, GESClip * clip,
+    gint new_layer_priority, GESEditMode mode, GESEdge edge, guint64 position)
+{
+  guint i;
+  GList *tmp;
+  gboolean res;
+  GHashTable *seen;
+  gint offset = 0, min_layer = G_MAXINT;
+  GESEditPreview *preview;
+  GESEditPreviewEntry *entry;
+  GESTrackElement *obj = NULL;
+  MoveContext mv_ctx = { 0, };
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+  g_return_val_if_fail (GES_IS_CLIP (clip), NULL);
+
+  /* The clip edits through its first source, see GESClip:edit */
+  for (tmp = GES_CONTAINER_CHILDREN (clip); tmp; tmp = tmp->next) {
+    if (GES_IS_SOURCE (tmp->data)) {
+      obj = tmp->data;
+      break;
+    }
+  }
+
+  if (obj == NULL || !g_hash_table_contains (timeline->priv->obj_iters, obj)) {
+    GST_INFO_OBJECT (clip, "Has no source in %" GST_PTR_FORMAT, timeline);
+    return NULL;
+  }
+
+  flush_pending_indexes (timeline);
+  init_movecontext (&mv_ctx, TRUE);
+  if (!move_context_fill (timeline, &mv_ctx, obj, mode, edge)) {
+    clear_movecontext (&mv_ctx);
+
+    return NULL;
+  }
+
+  preview = g_slice_new0 (GESEditPreview);
+  preview->entries = g_array_new (FALSE, FALSE, sizeof (GESEditPreviewEntry));
+  g_array_set_clear_func (preview->entries,
+      (GDestroyNotify) _clear_preview_entry);
+  preview->snap_time = GST_CLOCK_TIME_NONE;
+
+  seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+  res = preview_edit_track_element (timeline, &mv_ctx, preview, seen, obj,
+      mode, edge, position);
+  g_hash_table_unref (seen);
+  clear_movecontext (&mv_ctx);
+
+  if (!res) {
+    ges_edit_preview_free (preview);
+
+    return NULL;
+  }
+
+  /* Moving to layer, as in timeline_context_to_layer */
+  if (new_layer_priority != -1)
+    offset = new_layer_priority - ges_clip_get_layer_priority (clip);
+
+  for (i = 0; offset && i < preview->entries->len; i++) {
+    entry = &g_array_index (preview->entries, GESEditPreviewEntry, i);
+    min_layer = MIN (min_layer, entry->layer_priority);
+  }
+
+  if (offset > 0 || (offset < 0 && min_layer >= -offset)) {
+    for (i = 0; i < preview->entries->len; i++) {
+      entry = &g_array_index (preview->entries, GESEditPreviewEntry, i);
+      entry->layer_priority += offset;
+    }
+  }
+
+  return preview;
+}
+
+/**
+ * ges_edit_preview_free:
+ * @preview: a #GESEditPreview
+ *
+ * Frees @preview and releases the references it holds.
+ */
+void
+ges_edit_preview_free (GESEditPreview * preview)
+{
+  g_return_if_fail (preview != NULL);
+
+  g_array_unref (preview->entries);
+  if (preview->snapped_element)
+    gst_object_unref (preview->snapped_element);
+
+  g_slice_free (GESEditPreview, preview);
+}
+
+/**
+ * ges_edit_preview_copy:
+ * @preview: a #GESEditPreview
+ *
+ * Copies @preview, along with its entries.
+ *
+ * Returns: (transfer full): a copy of @preview, to free with
+ * #ges_edit_preview_free
+ */
+GESEditPreview *
+ges_edit_preview_copy (const GESEditPreview * preview)
+{
+  guint i;
+  GESEditPreview *copy;
+  GESEditPreviewEntry *entry;
+
+  g_return_val_if_fail (preview != NULL, NULL);
+
+  copy = g_slice_dup (GESEditPreview, preview);
+  copy->entries = g_array_sized_new (FALSE, FALSE,
+      sizeof (GESEditPreviewEntry), preview->entries->len);
+  g_array_set_clear_func (copy->entries,
+      (GDestroyNotify) _clear_preview_entry);
+  g_array_append_vals (copy->entries, preview->entries->data,
+      preview->entries->len);
+  for (i = 0; i < copy->entries->len; i++) {
+    entry = &g_array_index (copy->entries, GESEditPreviewEntry, i);
+    gst_object_ref (entry->element);
+  }
+
+  if (copy->snapped_element)
+    gst_object_ref (copy->snapped_element);
+
+  return copy;
+}
+
+G_DEFINE_BOXED_TYPE (GESEditPreview, ges_edit_preview,
+    ges_edit_preview_copy, ges_edit_preview_free);
+
+/**
+ * ges_edit_preview_entry_copy:
+ * @entry: a #GESEditPreviewEntry
+ *
+ * Copies @entry, taking a reference on its element.
+ *
+ * Returns: (transfer full): a copy of @entry, to free with
+ * #ges_edit_preview_entry_free
+ */
+GESEditPreviewEntry *
+ges_edit_preview_entry_copy (const GESEditPreviewEntry * entry)
+{
+  GESEditPreviewEntry *copy;
+
+  g_return_val_if_fail (entry != NULL, NULL);
+
+  copy = g_slice_dup (GESEditPreviewEntry, entry);
+  gst_object_ref (copy->element);
+
+  return copy;
+}
+
+/**
+ * ges_edit_preview_entry_free:
+ * @entry: a #GESEditPreviewEntry copied with #ges_edit_preview_entry_copy
+ *
+ * Frees @entry and releases the reference on its element.
+ */
+void
+ges_edit_preview_entry_free (GESEditPreviewEntry * entry)
+{
+  g_return_if_fail (entry != NULL);
+
+  gst_object_unref (entry->element);
+  g_slice_free (GESEditPreviewEntry, entry);
+}
+
+G_DEFINE_BOXED_TYPE (GESEditPreviewEntry, ges_edit_preview_entry,
+    ges_edit_preview_entry_copy, ges_edit_preview_entry_free);
+
+/**
+ * ges_timeline_acquire_snapshot:
+ * @timeline: a #GESTimeline
+ *
+ * Gets an immutable view of the positions of the layers, clips, transitions
+ * and track elements of @timeline, as they were when @timeline was last
+ * committed. A new snapshot, with a bigger version, is built by the first
+ * call following a #ges_timeline_commit, copying the timeline is linear in
+ * its number of track elements.
+ *
+ * This can be called from any thread while @timeline is being edited or
+ * committed, as long as the caller holds a reference to @timeline, and never
+ * blocks. Once it has been called from another thread than the one
+ * committing @timeline, snapshots are built by each commit instead, and the
+ * first such call might still get the snapshot preceding the last commit,
+ * which #ges_timeline_snapshot_is_outdated tells. The elements of the
+ * snapshot are only identified by their address, they must not be
+ * dereferenced without holding a reference to them.
+ *
+ * Returns: (transfer full): The current snapshot of @timeline, release it
+ * with #ges_timeline_snapshot_unref
+ */
+GESTimelineSnapshot *
+ges_timeline_acquire_snapshot (GESTimeline * timeline)
+{
+  GThread *commit_thread;
+  GESTimelineSnapshot *snapshot;
+  GESTimelinePrivate *priv;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+
+  priv = timeline->priv;
+  commit_thread = g_atomic_pointer_get (&priv->commit_thread);
+  if (commit_thread == g_thread_self ()) {
+    if (priv->snapshot_dirty)
+      timeline_replace_snapshot (timeline);
+  } else if (commit_thread) {
+    g_atomic_int_set (&priv->snapshot_shared, TRUE);
+  }
+
+  /* The snapshot we read can not be released until we are done */
+  g_atomic_int_inc (&priv->snapshot_readers);
+  snapshot =
+      ges_timeline_snapshot_ref (g_atomic_pointer_get (&priv->snapshot));
+  g_atomic_int_add (&priv->snapshot_readers, -1);
+
+  return snapshot;
+}
+
+/**
+ * ges_timeline_snapshot_ref:
+ * @snapshot: a #GESTimelineSnapshot
+ *
+ * Returns: (transfer full): @snapshot
+ */
+GESTimelineSnapshot *
+ges_timeline_snapshot_ref (GESTimelineSnapshot * snapshot)
+{
+  g_return_val_if_fail (snapshot != NULL, NULL);
+
+  g_atomic_int_inc (&snapshot->ref_count);
+
+  return snapshot;
+}
+
+/**
+ * ges_timeline_snapshot_unref:
+ * @snapshot: a #GESTimelineSnapshot
+ *
+ * Releases a reference to @snapshot, this can be done from any thread.
+ */
+void
+ges_timeline_snapshot_unref (GESTimelineSnapshot * snapshot)
+{
+  g_return_if_fail (snapshot != NULL);
+
+  if (!g_atomic_int_dec_and_test (&snapshot->ref_count))
+    return;
+
+  g_free (snapshot->layers);
+  g_free (snapshot->clips);
+  g_free (snapshot->elements);
+  g_slice_free (GESTimelineSnapshot, snapshot);
+}
+
+G_DEFINE_BOXED_TYPE (GESTimelineSnapshot, ges_timeline_snapshot,
+    ges_timeline_snapshot_ref, ges_timeline_snapshot_unref);
+
+/**
+ * ges_timeline_snapshot_get_version:
+ * @snapshot: a #GESTimelineSnapshot
+ *
+ * Returns: The version of @snapshot, later snapshots of a timeline have
+ * bigger versions
+ */
+guint64
+ges_timeline_snapshot_get_version (GESTimelineSnapshot * snapshot)
+{
+  g_return_val_if_fail (snapshot != NULL, 0);
+
+  return snapshot->version;
+}
+
+/**
+ * ges_timeline_snapshot_is_outdated:
+ * @snapshot: a #GESTimelineSnapshot
+ *
+ * Can be called from any thread to know whether a newer snapshot can be
+ * acquired.
+ *
+ * Returns: %TRUE if the timeline of @snapshot was committed since @snapshot
+ * was taken
+ */
+gboolean
+ges_timeline_snapshot_is_outdated (GESTimelineSnapshot * snapshot)
+{
+  g_return_val_if_fail (snapshot != NULL, FALSE);
+
+  return g_atomic_int_get (&snapshot->outdated);
+}
+
+/**
+ * ges_timeline_snapshot_get_duration:
+ * @snapshot: a #GESTimelineSnapshot
+ *
+ * Returns: The duration of the timeline when @snapshot was taken
+ */
+GstClockTime
+ges_timeline_snapshot_get_duration (GESTimelineSnapshot * snapshot)
+{
+  g_return_val_if_fail (snapshot != NULL, GST_CLOCK_TIME_NONE);
+
+  return snapshot->duration;
+}
+
+/**
+ * ges_timeline_snapshot_get_layers:
+ * @snapshot: a #GESTimelineSnapshot
+ * @n_layers: (out): The number of layers
+ *
+ * Returns: (transfer none) (array length=n_layers): The layers of @snapshot
+ * sorted by priority, valid as long as @snapshot is
+ */
+const GESTimelineSnapshotLayer *
+ges_timeline_snapshot_get_layers (GESTimelineSnapshot * snapshot,
+    guint * n_layers)
+{
+  g_return_val_if_fail (snapshot != NULL, NULL);
+  g_return_val_if_fail (n_layers != NULL, NULL);
+
+  *n_layers = snapshot->n_layers;
+
+  return snapshot->layers;
+}
+
+/**
+ * ges_timeline_snapshot_get_clips:
+ * @snapshot: a #GESTimelineSnapshot
+ * @n_clips: (out): The number of clips
+ *
+ * Returns: (transfer none) (array length=n_clips): The clips of @snapshot
+ * sorted by layer priority and then by start, valid as long as @snapshot is
+ */
+const GESTimelineSnapshotClip *
+ges_timeline_snapshot_get_clips (GESTimelineSnapshot * snapshot,
+    guint * n_clips)
+{
+  g_return_val_if_fail (snapshot != NULL, NULL);
+  g_return_val_if_fail (n_clips != NULL, NULL);
+
+  *n_clips = snapshot->n_clips;
+
+  return snapshot->clips;
+}
+
+/**
+ * ges_timeline_snapshot_get_elements:
+ * @snapshot: a #GESTimelineSnapshot
+ * @n_elements: (out): The number of track elements
+ *
+ * Returns: (transfer none) (array length=n_elements): The track elements of
+ * @snapshot grouped by clip, in the same order as the clips, valid as long
+ * as @snapshot is
+ */
+const GESTimelineSnapshotElement *
+ges_timeline_snapshot_get_elements (GESTimelineSnapshot * snapshot,
+    guint * n_elements)
+{
+  g_return_val_if_fail (snapshot != NULL, NULL);
+  g_return_val_if_fail (n_elements != NULL, NULL);
+
+  *n_elements = snapshot->n_elements;
+
+  return snapshot->elements;
+}
+
+/* Any commit also satisfies the asynchronous commits that are queued */
+static void
+complete_pending_commits (GESTimeline * timeline, gboolean res)
+{
+  GList *tmp, *pending = timeline->priv->pending_commits;
+
+  if (timeline->priv->commit_source) {
+    g_source_destroy (timeline->priv->commit_source);
+    g_source_unref (timeline->priv->commit_source);
+    timeline->priv->commit_source = NULL;
+  }
+
+  timeline->priv->pending_commits = NULL;
+  for (tmp = pending; tmp; tmp = tmp->next) {
+    g_simple_async_result_set_op_res_gboolean (tmp->data, res);
+    g_simple_async_result_complete_in_idle (tmp->data);
+    g_object_unref (tmp->data);
+  }
+  g_list_free (pending);
+}
+
+static gboolean
+commit_pending_cb (GESTimeline * timeline)
+{
+  GST_DEBUG_OBJECT (timeline, "Running %d queued commits at once",
+      g_list_length (timeline->priv->pending_commits));
+
+  ges_timeline_commit (timeline);
+
+  return FALSE;
+}
+
+/**
+ * ges_timeline_commit:
+ * @timeline: a #GESTimeline
+ *
+ * Commits all the pending changes of the clips contained in the
+ * @timeline.
+ *
+ * When timing changes happen in a timeline, the changes are not
+ * directly done inside GNL. This method needs to be called so any changes
+ * on a clip contained in the timeline actually happen at the media
+ * processing level.
+ *
+ * Returns: %TRUE if something as been commited %FALSE if nothing needed
+ * to be commited
+ */
+gboolean
+ges_timeline_commit (GESTimeline * timeline)
+{
+  GList *tmp;
+  gboolean res = TRUE, skipped;
+  GstStructure *stats;
+  const GstStructure *track_stats;
+  guint elements_touched = 0, gaps_changed = 0, n_touched, n_gaps,
+      tracks_committed = 0, tracks_skipped = 0;
+  GstClockTime start = gst_util_get_timestamp ();
+
+  GST_DEBUG_OBJECT (timeline, "commiting changes");
+
+  flush_pending_indexes (timeline);
+  update_dirty_transitions (timeline);
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
+    if (!ges_track_commit (GES_TRACK (tmp->data)))
+      res = FALSE;
+
+    track_stats = ges_track_get_commit_stats (tmp->data);
+    gst_structure_get (track_stats, "skipped", G_TYPE_BOOLEAN, &skipped,
+        "elements-touched", G_TYPE_UINT, &n_touched,
+        "gaps-changed", G_TYPE_UINT, &n_gaps, NULL);
+    elements_touched += n_touched;
+    gaps_changed += n_gaps;
+    if (skipped)
+      tracks_skipped++;
+    else
+      tracks_committed++;
+  }
+
+  /* The objects of the move context are kept as long as they are valid, but
+   * we do not keep snapping on the same edge from one edit to the next */
+  timeline->priv->movecontext.last_snaped1 = NULL;
+  timeline->priv->movecontext.last_snaped2 = NULL;
+  timeline->priv->movecontext.last_snap_ts = GST_CLOCK_TIME_NONE;
+
+  timeline_publish_snapshot (timeline);
+  complete_pending_commits (timeline, res);
+
+  stats = gst_structure_new ("ges-commit-stats",
+      "elements-touched", G_TYPE_UINT, elements_touched,
+      "gaps-changed", G_TYPE_UINT, gaps_changed,
+      "tracks-committed", G_TYPE_UINT, tracks_committed,
+      "tracks-skipped", G_TYPE_UINT, tracks_skipped,
+      "skipped", G_TYPE_BOOLEAN, tracks_committed == 0,
+      "time", G_TYPE_UINT64, gst_util_get_timestamp () - start, NULL);
+  g_signal_emit (timeline, ges_timeline_signals[COMMIT_STATS], 0, stats);
+  gst_structure_free (stats);
+
+  if (res)
+    g_signal_emit (timeline, ges_timeline_signals[COMMITED], 0);
+
+  return res;
+}
+
+/**
+ * ges_timeline_commit_async:
+ * @timeline: a #GESTimeline
+ * @cancellable: (allow-none): optional %GCancellable object, %NULL to ignore
+ * @callback: (allow-none): a #GAsyncReadyCallback to call when the commit
+ * is done
+ * @user_data: the data to pass to @callback
+ *
+ * Queues a commit of @timeline, see #ges_timeline_commit, and returns
+ * immediately. The commit is done when the thread-default main context of
+ * the first caller gets idle, so that all the commits requested by a burst
+ * of edits are merged in a single one. A call to #ges_timeline_commit before
+ * that also completes the queued commits.
+ *
+ * @callback is then called in the thread-default main context of the caller,
+ * and can call #ges_timeline_commit_finish to get the result of the commit.
+ */
+void
+ges_timeline_commit_async (GESTimeline * timeline, GCancellable * cancellable,
+    GAsyncReadyCallback callback, gpointer user_data)
+{
+  GSimpleAsyncResult *simple;
+  GESTimelinePrivate *priv;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  priv = timeline->priv;
+  simple = g_simple_async_result_new (G_OBJECT (timeline), callback,
+      user_data, ges_timeline_commit_async);
+  g_simple_async_result_set_check_cancellable (simple, cancellable);
+  priv->pending_commits = g_list_prepend (priv->pending_commits, simple);
+
+  if (priv->commit_source)
+    return;
+
+  priv->commit_source = g_idle_source_new ();
+  g_source_set_callback (priv->commit_source, (GSourceFunc) commit_pending_cb,
+      gst_object_ref (timeline), gst_object_unref);
+  g_source_attach (priv->commit_source, g_main_context_get_thread_default ());
+}
+
+/**
+ * ges_timeline_commit_finish:
+ * @timeline: a #GESTimeline
+ * @result: the #GAsyncResult passed to the callback of
+ * #ges_timeline_commit_async
+ * @error: (allow-none): return location for a #GError, or %NULL
+ *
+ * Finishes an asynchronous commit started with #ges_timeline_commit_async.
+ *
+ * Returns: the result of the commit, as returned by #ges_timeline_commit,
+ * or %FALSE with @error set if the commit was cancelled
+ */
+gboolean
+ges_timeline_commit_finish (GESTimeline * timeline, GAsyncResult * result,
+    GError ** error)
+{
+  GSimpleAsyncResult *simple;
+
+  g_return_val_if_fail (g_simple_async_result_is_valid (result,
+          G_OBJECT (timeline), ges_timeline_commit_async), FALSE);
+
+  simple = G_SIMPLE_ASYNC_RESULT (result);
+  if (g_simple_async_result_propagate_error (simple, error))
+    return FALSE;
+
+  return g_simple_async_result_get_op_res_gboolean (simple);
+}
+
+/**
+ * ges_timeline_begin_edit:
+ * @timeline: a #GESTimeline
+ *
+ * Starts an edit transaction on @timeline. Until the matching call to
+ * #ges_timeline_end_edit, the work that the timeline usually does each time
+ * an element is moved or resized (keeping its internal indexes sorted,
+ * creating the auto-transitions and sorting the elements of the tracks) is
+ * deferred, and done only once when the transaction ends. This makes
+ * editing a lot of elements in a row much faster.
+ *
+ * Transactions can be nested, in which case the deferred work is done when
+ * the outermost one ends.
+ */
+void
+ges_timeline_begin_edit (GESTimeline * timeline)
+{
+  GList *tmp;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  if (timeline->priv->edit_depth++ > 0)
+    return;
+
+  GST_DEBUG_OBJECT (timeline, "Starting edit transaction");
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next)
+    ges_track_begin_edit (tmp->data);
+}
+
+/**
+ * ges_timeline_end_edit:
+ * @timeline: a #GESTimeline
+ *
+ * Ends an edit transaction started with #ges_timeline_begin_edit. If it
+ * was the outermost transaction, all the deferred work is done.
+ */
+void
+ges_timeline_end_edit (GESTimeline * timeline)
+{
+  GList *tmp, *pending;
+  GESTimelinePrivate *priv;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  priv = timeline->priv;
+  g_return_if_fail (priv->edit_depth > 0);
+
+  if (--priv->edit_depth > 0)
+    return;
+
+  GST_DEBUG_OBJECT (timeline, "Ending edit transaction, %i elements moved",
+      g_hash_table_size (priv->pending_indexes));
+
+  flush_pending_indexes (timeline);
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next)
+    ges_track_end_edit (tmp->data);
+
+  /* Creating transitions might move elements, which is why we steal the
+   * list first */
+  pending = g_hash_table_get_keys (priv->pending_transitions);
+  g_hash_table_remove_all (priv->pending_transitions);
+  for (tmp = pending; tmp; tmp = tmp->next)
+    create_transitions (timeline, tmp->data);
+  g_list_free (pending);
 }
 
 /**
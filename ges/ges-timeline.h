@@ -22,9 +22,11 @@
 #define _GES_TIMELINE
 
 #include <glib-object.h>
+#include <gio/gio.h>
 #include <gst/gst.h>
 #include <gst/pbutils/gstdiscoverer.h>
 #include <ges/ges-types.h>
+#include <ges/ges-enums.h>
 
 G_BEGIN_DECLS
 
@@ -57,6 +59,7 @@ G_BEGIN_DECLS
 #define ges_timeline_get_project(obj) (GES_TIMELINE (ges_extractable_get_asset (obj))
 
 typedef struct _GESTimelinePrivate GESTimelinePrivate;
+typedef struct _GESTimelineRangeIter GESTimelineRangeIter;
 
 /**
  * GESTimeline:
@@ -97,6 +100,138 @@ struct _GESTimelineClass {
   gpointer _ges_reserved[GES_PADDING];
 };
 
+/**
+ * GESTimelineRangeIter:
+ *
+ * A GESTimelineRangeIter structure represents an iterator that can be used
+ * to walk over the clips of a #GESTimeline in a range of time and layers. It
+ * is meant to be allocated on the stack and initialized with
+ * #ges_timeline_range_iter_init.
+ */
+struct _GESTimelineRangeIter {
+  /*< private >*/
+  gpointer dummy1;
+  gpointer dummy2;
+  guint64 dummy3;
+  guint64 dummy4;
+  guint dummy5;
+  guint dummy6;
+
+  gpointer _ges_reserved[GES_PADDING];
+};
+
+/**
+ * GESEditPreviewEntry:
+ * @element: the #GESTimelineElement affected by the edit
+ * @start: the start @element would have after the edit
+ * @duration: the duration @element would have after the edit
+ * @layer_priority: the priority of the layer @element would be in after the
+ * edit
+ *
+ * An element affected by an edit previewed with #ges_timeline_preview_edit.
+ */
+typedef struct {
+  GESTimelineElement *element;
+  GstClockTime start;
+  GstClockTime duration;
+  gint layer_priority;
+} GESEditPreviewEntry;
+
+/**
+ * GESEditPreview:
+ * @entries: (element-type GESEditPreviewEntry): the elements the edit would
+ * affect
+ * @snapped: whether the edit would snap
+ * @snapped_element: (allow-none): the #GESTrackElement the edit would snap
+ * to, if any
+ * @snap_time: the position the edit would snap at, if any
+ *
+ * The result of #ges_timeline_preview_edit.
+ */
+typedef struct {
+  GArray *entries;
+  gboolean snapped;
+  GESTrackElement *snapped_element;
+  GstClockTime snap_time;
+} GESEditPreview;
+
+/**
+ * GESTimelineSnapshot:
+ *
+ * An immutable view of the geometry of a #GESTimeline as it was when it was
+ * last committed, see #ges_timeline_acquire_snapshot.
+ */
+typedef struct _GESTimelineSnapshot GESTimelineSnapshot;
+
+/**
+ * GESTimelineSnapshotLayer:
+ * @layer: identifies the #GESLayer
+ * @priority: the priority of the layer
+ * @first_clip: the index of the first clip of the layer in the clips of the
+ * snapshot
+ * @n_clips: the number of clips in the layer
+ *
+ * A layer as seen by a #GESTimelineSnapshot.
+ */
+typedef struct {
+  gconstpointer layer;
+  guint priority;
+  guint first_clip;
+  guint n_clips;
+} GESTimelineSnapshotLayer;
+
+/**
+ * GESTimelineSnapshotClip:
+ * @clip: identifies the #GESClip
+ * @start: the start of the clip
+ * @inpoint: the in-point of the clip
+ * @duration: the duration of the clip
+ * @layer_priority: the priority of the layer of the clip
+ * @track_types: the types of the tracks the clip has elements in
+ * @is_transition: whether the clip is a #GESTransitionClip
+ * @first_element: the index of the first track element of the clip in the
+ * elements of the snapshot
+ * @n_elements: the number of track elements of the clip
+ *
+ * A clip as seen by a #GESTimelineSnapshot.
+ */
+typedef struct {
+  gconstpointer clip;
+  GstClockTime start;
+  GstClockTime inpoint;
+  GstClockTime duration;
+  guint layer_priority;
+  GESTrackType track_types;
+  gboolean is_transition;
+  guint first_element;
+  guint n_elements;
+} GESTimelineSnapshotClip;
+
+/**
+ * GESTimelineSnapshotElement:
+ * @element: identifies the #GESTrackElement
+ * @track: (allow-none): identifies the #GESTrack the element is in
+ * @clip_index: the index of the clip of the element in the clips of the
+ * snapshot
+ * @start: the start of the element
+ * @inpoint: the in-point of the element
+ * @duration: the duration of the element
+ * @priority: the priority of the element
+ * @active: whether the element is active
+ *
+ * A track element as seen by a #GESTimelineSnapshot.
+ */
+typedef struct {
+  gconstpointer element;
+  gconstpointer track;
+  guint clip_index;
+  GstClockTime start;
+  GstClockTime inpoint;
+  GstClockTime duration;
+  guint32 priority;
+  gboolean active;
+} GESTimelineSnapshotElement;
+
 GType ges_timeline_get_type (void);
 
 GESTimeline* ges_timeline_new (void);
@@ -110,6 +245,13 @@ GESLayer * ges_timeline_append_layer (GESTimeline * timeline);
 gboolean ges_timeline_remove_layer (GESTimeline *timeline, GESLayer *layer);
 GList* ges_timeline_get_layers (GESTimeline *timeline);
 
+GList* ges_timeline_get_elements_in_range (GESTimeline *timeline, GstClockTime start,
+    GstClockTime end, guint layer_min, guint layer_max);
+void ges_timeline_range_iter_init (GESTimelineRangeIter *iter, GESTimeline *timeline,
+    GstClockTime start, GstClockTime end, guint layer_min, guint layer_max);
+gboolean ges_timeline_range_iter_next (GESTimelineRangeIter *iter,
+    GESTimelineElement **clip);
+
 gboolean ges_timeline_add_track (GESTimeline *timeline, GESTrack *track);
 gboolean ges_timeline_remove_track (GESTimeline *timeline, GESTrack *track);
 
@@ -117,6 +259,41 @@ GESTrack * ges_timeline_get_track_for_pad (GESTimeline *timeline, GstPad *pad);
 GList *ges_timeline_get_tracks (GESTimeline *timeline);
 
 gboolean ges_timeline_commit (GESTimeline * timeline);
+void ges_timeline_commit_async (GESTimeline * timeline, GCancellable *cancellable,
+    GAsyncReadyCallback callback, gpointer user_data);
+gboolean ges_timeline_commit_finish (GESTimeline * timeline, GAsyncResult *result,
+    GError **error);
+
+void ges_timeline_begin_edit (GESTimeline * timeline);
+void ges_timeline_end_edit (GESTimeline * timeline);
+
+#define GES_TYPE_EDIT_PREVIEW (ges_edit_preview_get_type ())
+#define GES_TYPE_EDIT_PREVIEW_ENTRY (ges_edit_preview_entry_get_type ())
+
+GESEditPreview * ges_timeline_preview_edit (GESTimeline *timeline, GESClip *clip,
+    gint new_layer_priority, GESEditMode mode, GESEdge edge, guint64 position);
+GType ges_edit_preview_get_type (void);
+GESEditPreview * ges_edit_preview_copy (const GESEditPreview *preview);
+void ges_edit_preview_free (GESEditPreview *preview);
+GType ges_edit_preview_entry_get_type (void);
+GESEditPreviewEntry * ges_edit_preview_entry_copy (const GESEditPreviewEntry *entry);
+void ges_edit_preview_entry_free (GESEditPreviewEntry *entry);
+
+#define GES_TYPE_TIMELINE_SNAPSHOT (ges_timeline_snapshot_get_type ())
+
+GESTimelineSnapshot * ges_timeline_acquire_snapshot (GESTimeline *timeline);
+GType ges_timeline_snapshot_get_type (void);
+GESTimelineSnapshot * ges_timeline_snapshot_ref (GESTimelineSnapshot *snapshot);
+void ges_timeline_snapshot_unref (GESTimelineSnapshot *snapshot);
+guint64 ges_timeline_snapshot_get_version (GESTimelineSnapshot *snapshot);
+gboolean ges_timeline_snapshot_is_outdated (GESTimelineSnapshot *snapshot);
+GstClockTime ges_timeline_snapshot_get_duration (GESTimelineSnapshot *snapshot);
+const GESTimelineSnapshotLayer * ges_timeline_snapshot_get_layers (GESTimelineSnapshot *snapshot,
+    guint *n_layers);
+const GESTimelineSnapshotClip * ges_timeline_snapshot_get_clips (GESTimelineSnapshot *snapshot,
+    guint *n_clips);
+const GESTimelineSnapshotElement * ges_timeline_snapshot_get_elements (GESTimelineSnapshot *snapshot,
+    guint *n_elements);
 
 GstClockTime ges_timeline_get_duration (GESTimeline *timeline);
 
@@ -180,6 +180,12 @@ ges_title_source_create_source (GESTrackElement * object)
   gst_object_ref (text);
   gst_object_ref (background);
 
+  /* We might be instantiated again after having been released */
+  if (priv->text_el)
+    gst_object_unref (priv->text_el);
+  if (priv->background_el)
+    gst_object_unref (priv->background_el);
+
   priv->text_el = text;
   priv->background_el = background;
 
@@ -34,12 +34,19 @@
 #include "ges-extractable.h"
 #include "ges-track-element.h"
 #include "ges-clip.h"
+#include "ges-source.h"
+#include "ges-track.h"
 #include "ges-meta-container.h"
+#include "ges-keyframe-store.h"
+#include "ges-baked-control-source.h"
 #include <gobject/gvaluecollector.h>
 
 G_DEFINE_ABSTRACT_TYPE (GESTrackElement, ges_track_element,
     GES_TYPE_TIMELINE_ELEMENT);
 
+typedef struct _ChildPropsTable ChildPropsTable;
+typedef struct _ChildProps ChildProps;
+
 struct _GESTrackElementPrivate
 {
   GESTrackType track_type;
@@ -54,10 +61,10 @@ struct _GESTrackElementPrivate
   GstElement *gnlobject;        /* The GnlObject */
   GstElement *element;          /* The element contained in the gnlobject (can be NULL) */
 
-  /* We keep a link between properties name and elements internally
-   * The hashtable should look like
-   * {GParamaSpec ---> element,}*/
-  GHashTable *children_props;
+  /* The children properties, as shared ChildPropsTable bound to our child
+   * elements, the last added first. See ges_track_element_add_children_props
+   * {ChildProps,} */
+  GList *children_props;
 
   GESTrack *track;
 
@@ -69,8 +76,43 @@ struct _GESTrackElementPrivate
                                            and deserialize keyframes */
 
   GList *pending_bindings;
+
+  /* All the keyframes of the bound properties, the control sources only
+   * contain the ones inside [inpoint, inpoint + duration] */
+  GHashTable *keyframe_stores;  /* {property name: GESKeyframeStore} */
+
+  /* Bindings replaced on the children by one driven from a table sampled
+   * at the framerate of the track, see ges_track_set_baked_controls */
+  GHashTable *baked_bindings;   /* {property name: BakedBinding} */
+
+  /* The content of the gnlobject is only created when needed, see
+   * ges_track_set_instantiation_window */
+  gboolean lazy;
+  GList *released_props;        /* ReleasedProp-s to set back on next
+                                 * instantiation */
 };
 
+typedef struct
+{
+  gchar *name;                  /* ClassName::property-name */
+  GValue value;
+} ReleasedProp;
+
+typedef struct
+{
+  GstControlBinding *binding;   /* The one in bindings_hashtable */
+  GstControlBinding *baked;     /* Set on the child instead of @binding */
+
+  /* What the table was sampled for */
+  GstClockTime interval;
+  GstClockTime inpoint;
+  GstClockTime duration;
+  guint n_keyframes;
+} BakedBinding;
+
+/* Beyond that, the property is left to its control source */
+#define MAX_BAKED_VALUES (1 << 20)
+
 typedef struct
 {
   GESTrackElement *element;
@@ -100,9 +142,9 @@ static guint ges_track_element_signals[LAST_SIGNAL] = { 0 };
 
 static GstElement *ges_track_element_create_gnl_object_func (GESTrackElement *
     object);
+static void ensure_instantiated (GESTrackElement * object);
 
-static void connect_properties_signals (GESTrackElement * object);
-static void connect_signal (gpointer key, gpointer value, gpointer user_data);
+static void free_child_props (ChildProps * props);
 static void gst_element_prop_changed_cb (GstElement * element, GParamSpec * arg
     G_GNUC_UNUSED, GESTrackElement * track_element);
 
@@ -159,15 +201,36 @@ ges_track_element_set_property (GObject * object, guint property_id,
   }
 }
 
+static void
+free_released_prop (ReleasedProp * prop)
+{
+  g_free (prop->name);
+  g_value_unset (&prop->value);
+  g_slice_free (ReleasedProp, prop);
+}
+
+static void
+free_baked_binding (BakedBinding * baked)
+{
+  gst_object_unref (baked->binding);
+  gst_object_unref (baked->baked);
+  g_slice_free (BakedBinding, baked);
+}
+
 static void
 ges_track_element_dispose (GObject * object)
 {
   GESTrackElement *element = GES_TRACK_ELEMENT (object);
   GESTrackElementPrivate *priv = element->priv;
 
-  g_hash_table_destroy (priv->children_props);
+  g_list_free_full (priv->children_props, (GDestroyNotify) free_child_props);
+  priv->children_props = NULL;
+  g_list_free_full (priv->released_props, (GDestroyNotify) free_released_prop);
+  priv->released_props = NULL;
   if (priv->bindings_hashtable)
     g_hash_table_destroy (priv->bindings_hashtable);
+  g_hash_table_destroy (priv->keyframe_stores);
+  g_hash_table_destroy (priv->baked_bindings);
 
   if (priv->gnlobject) {
     GstState cstate;
@@ -276,10 +339,10 @@ ges_track_element_init (GESTrackElement * self)
   priv->pending_active = TRUE;
   priv->bindings_hashtable = g_hash_table_new_full (g_str_hash, g_str_equal,
       g_free, NULL);
-  priv->children_props =
-      g_hash_table_new_full ((GHashFunc) ges_pspec_hash, ges_pspec_equal,
-      (GDestroyNotify) g_param_spec_unref, gst_object_unref);
-
+  priv->keyframe_stores = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, (GDestroyNotify) ges_keyframe_store_free);
+  priv->baked_bindings = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, (GDestroyNotify) free_baked_binding);
 }
 
 static gfloat
@@ -307,6 +370,29 @@ interpolate_values_for_position (GstTimedValue * first_value,
   return value_at_pos;
 }
 
+/* Gets the store of the keyframes of @property_name, (re)loading it from
+ * @source when the source was modified without going through it */
+static GESKeyframeStore *
+get_keyframe_store (GESTrackElement * self, const gchar * property_name,
+    GstTimedValueControlSource * source)
+{
+  GESKeyframeStore *store;
+
+  store = g_hash_table_lookup (self->priv->keyframe_stores, property_name);
+  if (store == NULL) {
+    store = ges_keyframe_store_new ();
+    g_hash_table_insert (self->priv->keyframe_stores,
+        g_strdup (property_name), store);
+    ges_keyframe_store_load (store, source);
+  } else if (!ges_keyframe_store_is_fed_to (store, source)) {
+    GST_DEBUG_OBJECT (self, "Keyframes of %s changed in the control source",
+        property_name);
+    ges_keyframe_store_load (store, source);
+  }
+
+  return store;
+}
+
 static void
 _update_control_bindings (GESTimelineElement * element, GstClockTime inpoint,
     GstClockTime duration)
@@ -314,82 +400,37 @@ _update_control_bindings (GESTimelineElement * element, GstClockTime inpoint,
   GParamSpec **specs;
   guint n, n_specs;
   GstControlBinding *binding;
-  GstTimedValueControlSource *source;
+  GstControlSource *source;
+  GESKeyframeStore *store;
   GESTrackElement *self = GES_TRACK_ELEMENT (element);
 
   specs = ges_track_element_list_children_properties (self, &n_specs);
 
   for (n = 0; n < n_specs; ++n) {
-    GList *values, *tmp;
-    GstTimedValue *last, *first, *prev = NULL, *next = NULL;
-    gfloat value_at_pos;
-
     binding = ges_track_element_get_control_binding (self, specs[n]->name);
 
     if (!binding)
       continue;
 
     g_object_get (binding, "control_source", &source, NULL);
-
-    if (duration == 0) {
-      gst_timed_value_control_source_unset_all (GST_TIMED_VALUE_CONTROL_SOURCE
-          (source));
+    if (!GST_IS_TIMED_VALUE_CONTROL_SOURCE (source)) {
+      gst_object_unref (source);
       continue;
     }
 
-    values =
-        gst_timed_value_control_source_get_all (GST_TIMED_VALUE_CONTROL_SOURCE
-        (source));
-
-    if (g_list_length (values) == 0)
-      continue;
+    store = get_keyframe_store (self, specs[n]->name,
+        GST_TIMED_VALUE_CONTROL_SOURCE (source));
 
-    first = values->data;
+    /* %GST_CLOCK_TIME_NONE keeps the previous end of the window */
+    if (duration == 0)
+      ges_keyframe_store_feed_nothing (store,
+          GST_TIMED_VALUE_CONTROL_SOURCE (source));
+    else if (ges_keyframe_store_get_size (store))
+      ges_keyframe_store_feed (store, GST_TIMED_VALUE_CONTROL_SOURCE (source),
+          inpoint, GST_CLOCK_TIME_IS_VALID (duration) ?
+          inpoint + duration : GST_CLOCK_TIME_NONE);
 
-    for (tmp = values->next; tmp; tmp = tmp->next) {
-      next = tmp->data;
-
-      if (next->timestamp > inpoint)
-        break;
-    }
-
-    value_at_pos = interpolate_values_for_position (first, next, inpoint);
-    gst_timed_value_control_source_unset (source, first->timestamp);
-    gst_timed_value_control_source_set (source, inpoint, value_at_pos);
-
-    values =
-        gst_timed_value_control_source_get_all (GST_TIMED_VALUE_CONTROL_SOURCE
-        (source));
-
-    if (duration != GST_CLOCK_TIME_NONE) {
-      last = g_list_last (values)->data;
-
-      for (tmp = g_list_last (values)->prev; tmp; tmp = tmp->prev) {
-        prev = tmp->data;
-
-        if (prev->timestamp < duration + inpoint)
-          break;
-      }
-
-      value_at_pos =
-          interpolate_values_for_position (prev, last, duration + inpoint);
-
-      gst_timed_value_control_source_unset (source, last->timestamp);
-      gst_timed_value_control_source_set (source, duration + inpoint,
-          value_at_pos);
-      values =
-          gst_timed_value_control_source_get_all (GST_TIMED_VALUE_CONTROL_SOURCE
-          (source));
-    }
-
-    for (tmp = values; tmp; tmp = tmp->next) {
-      GstTimedValue *value = tmp->data;
-      if (value->timestamp < inpoint)
-        gst_timed_value_control_source_unset (source, value->timestamp);
-      else if (duration != GST_CLOCK_TIME_NONE
-          && value->timestamp > duration + inpoint)
-        gst_timed_value_control_source_unset (source, value->timestamp);
-    }
+    gst_object_unref (source);
   }
 
   g_free (specs);
@@ -425,7 +466,12 @@ _set_inpoint (GESTimelineElement * element, GstClockTime inpoint)
   } else
     object->priv->pending_inpoint = inpoint;
 
-  _update_control_bindings (element, inpoint, GST_CLOCK_TIME_NONE);
+  /* The keyframes are in the time of the media, so the window of keyframes
+   * fed to the control sources slides with the in-point and keeps the
+   * duration of @element. Keyframes leaving the window are kept in the store
+   * instead of being destroyed, and the first keyframe is no longer moved to
+   * the in-point, nor is the end of the window kept in place as it used to */
+  _update_control_bindings (element, inpoint, _DURATION (element));
 
   return TRUE;
 }
@@ -539,25 +585,6 @@ gst_element_prop_changed_cb (GstElement * element, GParamSpec * arg
       GST_ELEMENT (element), arg);
 }
 
-static void
-connect_signal (gpointer key, gpointer value, gpointer user_data)
-{
-  gchar *signame = g_strconcat ("notify::", G_PARAM_SPEC (key)->name, NULL);
-
-  g_signal_connect (G_OBJECT (value),
-      signame, G_CALLBACK (gst_element_prop_changed_cb),
-      GES_TRACK_ELEMENT (user_data));
-
-  g_free (signame);
-}
-
-static void
-connect_properties_signals (GESTrackElement * object)
-{
-  g_hash_table_foreach (object->priv->children_props,
-      (GHFunc) connect_signal, object);
-}
-
 /* default 'create_gnl_object' virtual method implementation */
 static GstElement *
 ges_track_element_create_gnl_object_func (GESTrackElement * self)
@@ -582,7 +609,9 @@ ges_track_element_create_gnl_object_func (GESTrackElement * self)
   if (G_UNLIKELY (gnlobject == NULL))
     goto no_gnlobject;
 
-  if (klass->create_element) {
+  if (self->priv->lazy) {
+    GST_DEBUG_OBJECT (self, "Content will be created when needed");
+  } else if (klass->create_element) {
     GST_DEBUG ("Calling subclass 'create_element' vmethod");
     child = klass->create_element (self);
 
@@ -724,6 +753,317 @@ strv_find_str (const gchar ** strv, const char *str)
   return FALSE;
 }
 
+/* The configurable properties of the child elements of a given layout,
+ * for a given set of categories, blacklist and whitelist. They are computed
+ * once and shared by reference by all the track elements whose children
+ * have that layout, which only bind their child instances to them */
+struct _ChildPropsTable
+{
+  gint refcount;
+
+  guint n_children;
+  GPtrArray *specs;             /* {GParamSpec,} */
+  GArray *children;             /* {index of the child of each of @specs,} */
+
+  /* {GParamSpec: index in @specs + 1} */
+  GHashTable *index;
+  /* Both "property-name" and "ClassName::property-name", the first one
+   * found winning for the former {GQuark: GParamSpec} */
+  GHashTable *names;
+};
+
+/* A ChildPropsTable bound to the child elements of a track element, which
+ * are as many as the table has children in its layout */
+struct _ChildProps
+{
+  ChildPropsTable *table;
+  GstElement **children;
+};
+
+/* {key: ChildPropsTable}, see child_props_key. Freed by ges_deinit */
+static GHashTable *child_props_tables = NULL;
+G_LOCK_DEFINE_STATIC (child_props_tables);
+
+static ChildPropsTable *
+child_props_table_ref (ChildPropsTable * table)
+{
+  g_atomic_int_inc (&table->refcount);
+
+  return table;
+}
+
+static void
+child_props_table_unref (ChildPropsTable * table)
+{
+  if (!g_atomic_int_dec_and_test (&table->refcount))
+    return;
+
+  g_ptr_array_unref (table->specs);
+  g_array_unref (table->children);
+  g_hash_table_unref (table->index);
+  g_hash_table_unref (table->names);
+  g_slice_free (ChildPropsTable, table);
+}
+
+static void
+free_child_props (ChildProps * props)
+{
+  guint i;
+
+  for (i = 0; i < props->table->n_children; i++)
+    gst_object_unref (props->children[i]);
+  g_free (props->children);
+  child_props_table_unref (props->table);
+  g_slice_free (ChildProps, props);
+}
+
+static inline GstElement *
+child_props_get_child (ChildProps * props, guint spec_index)
+{
+  return props->children[g_array_index (props->table->children, guint,
+          spec_index)];
+}
+
+void
+ges_track_element_children_props_deinit (void)
+{
+  G_LOCK (child_props_tables);
+  if (child_props_tables) {
+    g_hash_table_unref (child_props_tables);
+    child_props_tables = NULL;
+  }
+  G_UNLOCK (child_props_tables);
+}
+
+static void
+append_strv (GString * key, const gchar ** strv)
+{
+  guint i;
+
+  if (strv == NULL) {
+    g_string_append (key, "|*");
+
+    return;
+  }
+
+  g_string_append_c (key, '|');
+  for (i = 0; strv[i]; i++) {
+    g_string_append (key, strv[i]);
+    g_string_append_c (key, ',');
+  }
+}
+
+/* Returns: (transfer full): A string identifying the arguments of
+ * ges_track_element_add_children_props and the layout of @children, the
+ * elements it found, @recurse being whether it was given a bin. The
+ * filters are keyed by their content since subclasses pass arrays on the
+ * stack */
+static gchar *
+child_props_key (gboolean recurse, const gchar ** wanted_categories,
+    const gchar ** blacklist, const gchar ** whitelist, GPtrArray * children)
+{
+  guint i;
+  GstElementFactory *factory;
+  GString *key = g_string_new (recurse ? "bin" : "element");
+
+  append_strv (key, wanted_categories);
+  append_strv (key, blacklist);
+  append_strv (key, whitelist);
+
+  g_string_append_c (key, '|');
+  for (i = 0; i < children->len; i++) {
+    factory = gst_element_get_factory (children->pdata[i]);
+    g_string_append_printf (key, "%s:%s,",
+        factory ? GST_OBJECT_NAME (factory) : "",
+        G_OBJECT_TYPE_NAME (children->pdata[i]));
+  }
+
+  return g_string_free (key, FALSE);
+}
+
+static gboolean
+child_is_wanted (GstElement * child, const gchar ** wanted_categories,
+    const gchar ** blacklist)
+{
+  guint i;
+  gchar **categories;
+  const gchar *klass;
+  gboolean wanted = FALSE;
+  GstElementFactory *factory = gst_element_get_factory (child);
+
+  if (factory == NULL)
+    return !wanted_categories && !blacklist;
+
+  if (strv_find_str (blacklist, GST_OBJECT_NAME (factory))) {
+    GST_DEBUG ("%s blacklisted", GST_OBJECT_NAME (factory));
+
+    return FALSE;
+  }
+
+  if (!wanted_categories)
+    return TRUE;
+
+  klass = gst_element_factory_get_metadata (factory,
+      GST_ELEMENT_METADATA_KLASS);
+  categories = g_strsplit (klass, "/", 0);
+  for (i = 0; categories[i] && !wanted; i++)
+    wanted = strv_find_str (wanted_categories, categories[i]);
+  g_strfreev (categories);
+
+  return wanted;
+}
+
+static void
+add_child_prop_name (ChildPropsTable * table, const gchar * name,
+    GParamSpec * pspec)
+{
+  GQuark quark = g_quark_from_string (name);
+
+  if (!g_hash_table_contains (table->names, GUINT_TO_POINTER (quark)))
+    g_hash_table_insert (table->names, GUINT_TO_POINTER (quark), pspec);
+}
+
+static void
+child_props_table_add_child (ChildPropsTable * table, GstElement * child,
+    guint child_index, gboolean recurse, const gchar ** whitelist)
+{
+  guint i, n_specs, pos;
+  GParamSpec **specs;
+  gchar *fullname;
+  GObjectClass *class = G_OBJECT_GET_CLASS (child);
+
+  /* Only warned about once per layout */
+  for (i = 0; !recurse && whitelist && whitelist[i]; i++) {
+    GParamSpec *pspec = g_object_class_find_property (class, whitelist[i]);
+
+    if (!pspec)
+      GST_WARNING ("no such property : %s in element : %s", whitelist[i],
+          GST_ELEMENT_NAME (child));
+    else if (!(pspec->flags & G_PARAM_WRITABLE))
+      GST_WARNING ("the property %s for element %s exists but is not writable",
+          whitelist[i], GST_ELEMENT_NAME (child));
+  }
+
+  specs = g_object_class_list_properties (class, &n_specs);
+  for (i = 0; i < n_specs; i++) {
+    if (!(specs[i]->flags & G_PARAM_WRITABLE) ||
+        (whitelist && !strv_find_str (whitelist, specs[i]->name)))
+      continue;
+
+    /* With several children of the same type, the last one wins */
+    pos = GPOINTER_TO_UINT (g_hash_table_lookup (table->index, specs[i]));
+    if (pos) {
+      g_array_index (table->children, guint, pos - 1) = child_index;
+      continue;
+    }
+
+    g_ptr_array_add (table->specs, g_param_spec_ref (specs[i]));
+    g_array_append_val (table->children, child_index);
+    g_hash_table_insert (table->index, specs[i],
+        GUINT_TO_POINTER (table->specs->len));
+
+    add_child_prop_name (table, specs[i]->name, specs[i]);
+    fullname = g_strdup_printf ("%s::%s", G_OBJECT_TYPE_NAME (child),
+        specs[i]->name);
+    add_child_prop_name (table, fullname, specs[i]);
+    g_free (fullname);
+  }
+  g_free (specs);
+}
+
+static ChildPropsTable *
+child_props_table_new (GPtrArray * children, gboolean recurse,
+    const gchar ** wanted_categories, const gchar ** blacklist,
+    const gchar ** whitelist)
+{
+  guint i;
+  ChildPropsTable *table = g_slice_new0 (ChildPropsTable);
+
+  table->refcount = 1;
+  table->n_children = children->len;
+  table->specs = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      g_param_spec_unref);
+  table->children = g_array_new (FALSE, FALSE, sizeof (guint));
+  table->index = g_hash_table_new ((GHashFunc) ges_pspec_hash,
+      ges_pspec_equal);
+  table->names = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  for (i = 0; i < children->len; i++) {
+    if (!recurse || child_is_wanted (children->pdata[i], wanted_categories,
+            blacklist))
+      child_props_table_add_child (table, children->pdata[i], i, recurse,
+          whitelist);
+  }
+
+  GST_DEBUG ("%d configurable properties found in %d elements",
+      table->specs->len, children->len);
+
+  return table;
+}
+
+/* Returns: (transfer full): The table for the layout of @children */
+static ChildPropsTable *
+get_child_props_table (GPtrArray * children, gboolean recurse,
+    const gchar ** wanted_categories, const gchar ** blacklist,
+    const gchar ** whitelist)
+{
+  ChildPropsTable *table;
+  gchar *key = child_props_key (recurse, wanted_categories, blacklist,
+      whitelist, children);
+
+  G_LOCK (child_props_tables);
+  if (G_UNLIKELY (child_props_tables == NULL))
+    child_props_tables = g_hash_table_new_full (g_str_hash, g_str_equal,
+        g_free, (GDestroyNotify) child_props_table_unref);
+
+  table = g_hash_table_lookup (child_props_tables, key);
+  if (table == NULL) {
+    table = child_props_table_new (children, recurse, wanted_categories,
+        blacklist, whitelist);
+    g_hash_table_insert (child_props_tables, key, table);
+  } else
+    g_free (key);
+  child_props_table_ref (table);
+  G_UNLOCK (child_props_tables);
+
+  return table;
+}
+
+/* Returns: (transfer none): The child of @object that @pspec is a property
+ * of, or %NULL */
+static GstElement *
+lookup_child_by_pspec (GESTrackElement * object, GParamSpec * pspec)
+{
+  GList *tmp;
+  guint pos;
+
+  for (tmp = object->priv->children_props; tmp; tmp = tmp->next) {
+    ChildProps *props = tmp->data;
+
+    pos = GPOINTER_TO_UINT (g_hash_table_lookup (props->table->index, pspec));
+    if (pos)
+      return child_props_get_child (props, pos - 1);
+  }
+
+  return NULL;
+}
+
+static void
+connect_properties_signals (GESTrackElement * object, ChildProps * props)
+{
+  guint i;
+  gchar *signame;
+  GParamSpec *pspec;
+
+  for (i = 0; i < props->table->specs->len; i++) {
+    pspec = g_ptr_array_index (props->table->specs, i);
+    signame = g_strconcat ("notify::", pspec->name, NULL);
+    g_signal_connect (child_props_get_child (props, i), signame,
+        G_CALLBACK (gst_element_prop_changed_cb), object);
+    g_free (signame);
+  }
+}
+
 /**
  * ges_track_element_add_children_props:
  * @self: The #GESTrackElement to set chidlren props on
@@ -748,99 +1088,26 @@ ges_track_element_add_children_props (GESTrackElement * self,
 {
   GValue item = { 0, };
   GstIterator *it;
-  GParamSpec **parray;
-  GObjectClass *class;
-  const gchar *klass;
-  GstElementFactory *factory;
-  gboolean done = FALSE;
-
-  if (!GST_IS_BIN (element)) {
-    guint i;
-    GParamSpec *pspec;
+  ChildProps *props;
+  GPtrArray *children = g_ptr_array_new ();
+  gboolean done = FALSE, recurse = GST_IS_BIN (element);
 
-    GObjectClass *class = G_OBJECT_GET_CLASS (element);
-
-    for (i = 0; whitelist[i]; i++) {
-
-      pspec = g_object_class_find_property (class, whitelist[i]);
-      if (!pspec) {
-        GST_WARNING ("no such property : %s in element : %s", whitelist[i],
-            gst_element_get_name (element));
-        continue;
-      }
-
-      if (pspec->flags & G_PARAM_WRITABLE) {
-        g_hash_table_insert (self->priv->children_props,
-            g_param_spec_ref (pspec), gst_object_ref (element));
-        GST_LOG_OBJECT (self,
-            "added property %s to controllable properties successfully !",
-            whitelist[i]);
-      } else
-        GST_WARNING
-            ("the property %s for element %s exists but is not writable",
-            whitelist[i], gst_element_get_name (element));
-
-    }
-
-    connect_properties_signals (self);
-    return;
-  }
+  if (!recurse)
+    g_ptr_array_add (children, gst_object_ref (element));
 
-  /*  We go over child elements recursivly, and add writable properties to the
-   *  hashtable */
-  it = gst_bin_iterate_recurse (GST_BIN (element));
-  while (!done) {
+  /*  We go over child elements recursivly, the layout they make is what
+   *  the shared table is looked up with */
+  it = recurse ? gst_bin_iterate_recurse (GST_BIN (element)) : NULL;
+  while (it && !done) {
     switch (gst_iterator_next (it, &item)) {
       case GST_ITERATOR_OK:
-      {
-        gchar **categories;
-        guint i;
-        GstElement *child = g_value_get_object (&item);
-
-        factory = gst_element_get_factory (child);
-        klass = gst_element_factory_get_metadata (factory,
-            GST_ELEMENT_METADATA_KLASS);
-
-        if (strv_find_str (blacklist, GST_OBJECT_NAME (factory))) {
-          GST_DEBUG_OBJECT (self, "%s blacklisted", GST_OBJECT_NAME (factory));
-          continue;
-        }
-
-        GST_DEBUG ("Looking at element '%s' of klass '%s'",
-            GST_ELEMENT_NAME (child), klass);
-
-        categories = g_strsplit (klass, "/", 0);
-
-        for (i = 0; categories[i]; i++) {
-          if ((!wanted_categories ||
-                  strv_find_str (wanted_categories, categories[i]))) {
-            guint i, nb_specs;
-
-            class = G_OBJECT_GET_CLASS (child);
-            parray = g_object_class_list_properties (class, &nb_specs);
-            for (i = 0; i < nb_specs; i++) {
-              if ((parray[i]->flags & G_PARAM_WRITABLE) &&
-                  (!whitelist || strv_find_str (whitelist, parray[i]->name))) {
-                g_hash_table_insert (self->priv->children_props,
-                    g_param_spec_ref (parray[i]), gst_object_ref (child));
-              }
-            }
-            g_free (parray);
-
-            GST_DEBUG
-                ("%d configurable properties of '%s' added to property hashtable",
-                nb_specs, GST_ELEMENT_NAME (child));
-            break;
-          }
-        }
-
-        g_strfreev (categories);
+        g_ptr_array_add (children, g_value_dup_object (&item));
         g_value_reset (&item);
         break;
-      }
       case GST_ITERATOR_RESYNC:
-        /* FIXME, properly restart the process */
         GST_DEBUG ("iterator resync");
+        g_ptr_array_foreach (children, (GFunc) gst_object_unref, NULL);
+        g_ptr_array_set_size (children, 0);
         gst_iterator_resync (it);
         break;
 
@@ -854,9 +1121,17 @@ ges_track_element_add_children_props (GESTrackElement * self,
     }
     g_value_unset (&item);
   }
-  gst_iterator_free (it);
+  if (it)
+    gst_iterator_free (it);
 
-  connect_properties_signals (self);
+  props = g_slice_new (ChildProps);
+  props->table = get_child_props_table (children, recurse, wanted_categories,
+      blacklist, whitelist);
+  props->children = (GstElement **) g_ptr_array_free (children, FALSE);
+  self->priv->children_props = g_list_prepend (self->priv->children_props,
+      props);
+
+  connect_properties_signals (self, props);
 }
 
 /* INTERNAL USAGE */
@@ -880,30 +1155,315 @@ ges_track_element_set_track (GESTrackElement * object, GESTrack * track)
       g_object_set (object->priv->gnlobject,
           "caps", ges_track_get_caps (object->priv->track), NULL);
     } else {
+      object->priv->lazy = GES_IS_SOURCE (object) &&
+          GST_CLOCK_TIME_IS_VALID (ges_track_get_instantiation_window (track));
       ret = ensure_gnl_object (object);
 
-      /* if we had pending control bindings, add them and free them */
-      if (ret && object->priv->pending_bindings) {
-        GList *tmp;
-        PendingBinding *pbinding;
+      /* if we had pending control bindings, add them and free them */
+      if (ret && object->priv->pending_bindings) {
+        GList *tmp;
+        PendingBinding *pbinding;
+
+        GST_INFO_OBJECT (object, "Asynchronously adding bindings");
+        for (tmp = object->priv->pending_bindings; tmp; tmp = tmp->next) {
+          pbinding = tmp->data;
+          ges_track_element_set_control_source (pbinding->element,
+              pbinding->source, pbinding->propname, pbinding->binding_type);
+          g_free (pbinding->propname);
+          g_free (pbinding->binding_type);
+        }
+        g_list_free_full (object->priv->pending_bindings,
+            (GDestroyNotify) _free_pending_binding);
+        object->priv->pending_bindings = NULL;
+      }
+    }
+  }
+
+  g_object_notify_by_pspec (G_OBJECT (object), properties[PROP_TRACK]);
+  return ret;
+}
+
+/* Whether the content of the gnlobject of @element exists */
+gboolean
+_ges_track_element_is_instantiated (GESTrackElement * element)
+{
+  return !element->priv->lazy || element->priv->element != NULL;
+}
+
+/* Whether the content of the gnlobject of @element is only created when
+ * needed, see ges_track_set_instantiation_window */
+gboolean
+_ges_track_element_is_lazy (GESTrackElement * element)
+{
+  return element->priv->lazy;
+}
+
+/* Creates the content of the gnlobject of a lazy @element, and sets back
+ * the values its children properties had when it was released */
+gboolean
+_ges_track_element_instantiate (GESTrackElement * element)
+{
+  GList *tmp;
+  GstElement *child;
+  GParamSpec *pspec;
+  GstElement *prop_element;
+  GESTrackElementPrivate *priv = element->priv;
+  GESTrackElementClass *klass = GES_TRACK_ELEMENT_GET_CLASS (element);
+
+  if (_ges_track_element_is_instantiated (element) || !priv->gnlobject)
+    return TRUE;
+
+  if (G_UNLIKELY (!klass->create_element ||
+          !(child = klass->create_element (element)))) {
+    GST_ERROR_OBJECT (element, "Could not create the content");
+
+    return FALSE;
+  }
+
+  if (!gst_bin_add (GST_BIN (priv->gnlobject), child)) {
+    GST_ERROR_OBJECT (element, "Could not add the content to the gnlobject");
+    gst_object_unref (child);
+
+    return FALSE;
+  }
+
+  priv->element = child;
+  gst_element_sync_state_with_parent (child);
+
+  for (tmp = priv->released_props; tmp; tmp = tmp->next) {
+    ReleasedProp *prop = tmp->data;
+
+    if (ges_track_element_lookup_child (element, prop->name, &prop_element,
+            &pspec)) {
+      g_object_set_property (G_OBJECT (prop_element), pspec->name,
+          &prop->value);
+      gst_object_unref (prop_element);
+      g_param_spec_unref (pspec);
+    }
+  }
+  g_list_free_full (priv->released_props, (GDestroyNotify) free_released_prop);
+  priv->released_props = NULL;
+
+  GST_DEBUG_OBJECT (element, "Instantiated");
+
+  return TRUE;
+}
+
+/* Destroys the content of the gnlobject of a lazy @element, keeping the
+ * values of its children properties. Elements with keyframes are kept */
+gboolean
+_ges_track_element_release (GESTrackElement * element)
+{
+  guint i;
+  GList *tmp;
+  GParamSpec *pspec;
+  GstElement *prop_element, *child;
+  GESTrackElementPrivate *priv = element->priv;
+
+  if (!priv->lazy || !priv->element ||
+      g_hash_table_size (priv->bindings_hashtable))
+    return FALSE;
+
+  for (tmp = priv->children_props; tmp; tmp = tmp->next) {
+    ChildProps *props = tmp->data;
+
+    for (i = 0; i < props->table->specs->len; i++) {
+      ReleasedProp *prop;
+
+      pspec = g_ptr_array_index (props->table->specs, i);
+      prop_element = child_props_get_child (props, i);
+      g_signal_handlers_disconnect_by_func (prop_element,
+          gst_element_prop_changed_cb, element);
+
+      /* Properties shadowed by a table added after this one are skipped */
+      if ((pspec->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+          lookup_child_by_pspec (element, pspec) != prop_element)
+        continue;
+
+      prop = g_slice_new0 (ReleasedProp);
+      prop->name = g_strdup_printf ("%s::%s",
+          G_OBJECT_TYPE_NAME (prop_element), pspec->name);
+      g_value_init (&prop->value, pspec->value_type);
+      g_object_get_property (G_OBJECT (prop_element), pspec->name,
+          &prop->value);
+      priv->released_props = g_list_prepend (priv->released_props, prop);
+    }
+  }
+  g_list_free_full (priv->children_props, (GDestroyNotify) free_child_props);
+  priv->children_props = NULL;
+
+  child = priv->element;
+  priv->element = NULL;
+  if (GES_IS_SOURCE (element))
+    _ges_source_recycle (GES_SOURCE (element));
+  gst_element_set_state (child, GST_STATE_NULL);
+  gst_bin_remove (GST_BIN (priv->gnlobject), child);
+
+  GST_DEBUG_OBJECT (element, "Released");
+
+  return TRUE;
+}
+
+/* Puts the original binding back on the child */
+static void
+restore_baked_binding (BakedBinding * baked)
+{
+  GstObject *child = gst_object_get_parent (GST_OBJECT (baked->baked));
+
+  if (child) {
+    gst_object_add_control_binding (child, baked->binding);
+    gst_object_unref (child);
+  }
+}
+
+/* The keyframe stores and baked bindings are keyed by the name of the
+ * property itself, so that "ClassName::property" and "property" match */
+static inline const gchar *
+property_key (const gchar * property_name)
+{
+  const gchar *name = g_strrstr (property_name, "::");
+
+  return name ? name + 2 : property_name;
+}
+
+static void
+unbake_binding (GESTrackElement * self, const gchar * property_name)
+{
+  BakedBinding *baked;
+  const gchar *key = property_key (property_name);
+
+  baked = g_hash_table_lookup (self->priv->baked_bindings, key);
+  if (baked) {
+    GST_DEBUG_OBJECT (self, "Unbaking %s", property_name);
+    restore_baked_binding (baked);
+    g_hash_table_remove (self->priv->baked_bindings, key);
+  }
+}
+
+static void
+bake_binding (GESTrackElement * self, const gchar * property_name,
+    GstControlBinding * binding, GstClockTime interval)
+{
+  guint64 n_values;
+  GstObject *child;
+  GstControlSource *source, *baked_source;
+  GstControlBinding *baked_binding;
+  GstClockTime inpoint = _INPOINT (self), duration = _DURATION (self);
+  BakedBinding *baked = g_hash_table_lookup (self->priv->baked_bindings,
+      property_key (property_name));
+
+  if (baked && baked->binding != binding) {
+    unbake_binding (self, property_name);
+    baked = NULL;
+  }
+
+  g_object_get (binding, "control_source", &source, NULL);
+  if (!GST_IS_TIMED_VALUE_CONTROL_SOURCE (source) ||
+      !GST_CLOCK_TIME_IS_VALID (duration) || duration == 0 ||
+      (n_values = duration / interval + 1) > MAX_BAKED_VALUES) {
+    unbake_binding (self, property_name);
+    goto done;
+  }
+
+  if (baked && baked->interval == interval && baked->inpoint == inpoint &&
+      baked->duration == duration && baked->n_keyframes ==
+      gst_timed_value_control_source_get_count (GST_TIMED_VALUE_CONTROL_SOURCE
+          (source)))
+    goto done;
+
+  baked_source = ges_baked_control_source_new (source, inpoint, interval,
+      n_values);
+  if (baked_source == NULL) {
+    GST_DEBUG_OBJECT (self, "Could not sample %s", property_name);
+    unbake_binding (self, property_name);
+    goto done;
+  }
+
+  child = gst_object_get_parent (GST_OBJECT (baked ? baked->baked : binding));
+  if (child == NULL) {
+    gst_object_unref (gst_object_ref_sink (baked_source));
+    goto done;
+  }
+
+  gst_object_ref_sink (baked_source);
+  baked_binding = gst_direct_control_binding_new (child, binding->name,
+      baked_source);
+  gst_object_unref (baked_source);
+
+  if (baked == NULL) {
+    baked = g_slice_new0 (BakedBinding);
+    baked->binding = gst_object_ref (binding);
+    g_hash_table_insert (self->priv->baked_bindings,
+        g_strdup (property_key (property_name)), baked);
+  } else {
+    gst_object_unref (baked->baked);
+  }
+  baked->baked = gst_object_ref (baked_binding);
+  baked->interval = interval;
+  baked->inpoint = inpoint;
+  baked->duration = duration;
+  baked->n_keyframes =
+      gst_timed_value_control_source_get_count (GST_TIMED_VALUE_CONTROL_SOURCE
+      (source));
+
+  /* Replaces @binding, or the previous baked binding */
+  gst_object_add_control_binding (child, baked_binding);
+  gst_object_unref (child);
+
+  GST_DEBUG_OBJECT (self, "Baked %s into %" G_GUINT64_FORMAT " values",
+      property_name, n_values);
 
-        GST_INFO_OBJECT (object, "Asynchronously adding bindings");
-        for (tmp = object->priv->pending_bindings; tmp; tmp = tmp->next) {
-          pbinding = tmp->data;
-          ges_track_element_set_control_source (pbinding->element,
-              pbinding->source, pbinding->propname, pbinding->binding_type);
-          g_free (pbinding->propname);
-          g_free (pbinding->binding_type);
-        }
-        g_list_free_full (object->priv->pending_bindings,
-            (GDestroyNotify) _free_pending_binding);
-        object->priv->pending_bindings = NULL;
-      }
+done:
+  gst_object_unref (source);
+}
+
+/* Makes the bindings of @element driven from tables of their values every
+ * @interval, resampling the ones whose keyframes, in-point or duration
+ * changed since. %GST_CLOCK_TIME_NONE puts the original bindings back.
+ *
+ * Returns: %TRUE if @element has bindings, so needs to be baked again on
+ * next changes */
+gboolean
+_ges_track_element_bake_controls (GESTrackElement * element,
+    GstClockTime interval)
+{
+  GHashTableIter iter;
+  const gchar *name;
+  GstControlBinding *binding;
+  GESTrackElementPrivate *priv = element->priv;
+
+  if (!GST_CLOCK_TIME_IS_VALID (interval) || interval == 0) {
+    BakedBinding *baked;
+
+    g_hash_table_iter_init (&iter, priv->baked_bindings);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & baked)) {
+      restore_baked_binding (baked);
+      g_hash_table_iter_remove (&iter);
     }
+
+    return g_hash_table_size (priv->bindings_hashtable) > 0;
   }
 
-  g_object_notify_by_pspec (G_OBJECT (object), properties[PROP_TRACK]);
-  return ret;
+  g_hash_table_iter_init (&iter, priv->bindings_hashtable);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & name,
+          (gpointer *) & binding))
+    bake_binding (element, name, binding, interval);
+
+  return g_hash_table_size (priv->bindings_hashtable) > 0;
+}
+
+/* Only accessing the children properties instantiates a lazy element, the
+ * track has to know about it to release it again */
+static void
+ensure_instantiated (GESTrackElement * object)
+{
+  if (G_LIKELY (_ges_track_element_is_instantiated (object)))
+    return;
+
+  if (object->priv->track)
+    ges_track_instantiate_element (object->priv->track, object);
+  else
+    _ges_track_element_instantiate (object);
 }
 
 GHashTable *
@@ -914,13 +1474,21 @@ ges_track_element_get_bindings_hashtable (GESTrackElement * trackelement)
   return priv->bindings_hashtable;
 }
 
+/* The gnonlin priority space of the layers is sparse, so the layer can
+ * not be deduced from the priority, we look at the one of our clip */
 guint32
 _ges_track_element_get_layer_priority (GESTrackElement * element)
 {
-  if (_PRIORITY (element) < LAYER_HEIGHT + MIN_GNL_PRIO)
+  guint32 layer_prio;
+  GESTimelineElement *parent = GES_TIMELINE_ELEMENT_PARENT (element);
+
+  if (parent == NULL || !GES_IS_CLIP (parent))
     return 0;
 
-  return (_PRIORITY (element) - MIN_GNL_PRIO) / LAYER_HEIGHT;
+  /* G_MAXUINT32 when the clip is in no layer */
+  layer_prio = ges_clip_get_layer_priority (GES_CLIP (parent));
+
+  return layer_prio == G_MAXUINT32 ? 0 : layer_prio;
 }
 
 /**
@@ -963,7 +1531,8 @@ ges_track_element_get_gnlobject (GESTrackElement * object)
  * Get the #GstElement this track element is controlling within GNonLin.
  *
  * Returns: (transfer none): the #GstElement this track element is controlling
- * within GNonLin.
+ * within GNonLin, %NULL if its content is not instantiated, see
+ * #ges_track_set_instantiation_window.
  */
 GstElement *
 ges_track_element_get_element (GESTrackElement * object)
@@ -1018,41 +1587,33 @@ gboolean
 ges_track_element_lookup_child (GESTrackElement * object,
     const gchar * prop_name, GstElement ** element, GParamSpec ** pspec)
 {
-  GHashTableIter iter;
-  gpointer key, value;
-  gchar **names, *name, *classename;
-  gboolean res;
+  GList *tmp;
+  GQuark quark;
+  GParamSpec *found = NULL;
+  GstElement *child;
 
   g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
 
-  classename = NULL;
-  res = FALSE;
+  /* The tables intern all the names of the children properties */
+  quark = g_quark_try_string (prop_name);
+  if (quark == 0)
+    return FALSE;
 
-  names = g_strsplit (prop_name, "::", 2);
-  if (names[1] != NULL) {
-    classename = names[0];
-    name = names[1];
-  } else
-    name = names[0];
-
-  g_hash_table_iter_init (&iter, object->priv->children_props);
-  while (g_hash_table_iter_next (&iter, &key, &value)) {
-    if (g_strcmp0 (G_PARAM_SPEC (key)->name, name) == 0) {
-      if (classename == NULL ||
-          g_strcmp0 (G_OBJECT_TYPE_NAME (G_OBJECT (value)), classename) == 0) {
-        GST_DEBUG ("The %s property from %s has been found", name, classename);
-        if (element)
-          *element = gst_object_ref (value);
-
-        *pspec = g_param_spec_ref (key);
-        res = TRUE;
-        break;
-      }
-    }
-  }
-  g_strfreev (names);
+  for (tmp = object->priv->children_props; tmp && !found; tmp = tmp->next)
+    found = g_hash_table_lookup (((ChildProps *) tmp->data)->table->names,
+        GUINT_TO_POINTER (quark));
+  if (found == NULL)
+    return FALSE;
 
-  return res;
+  child = lookup_child_by_pspec (object, found);
+  GST_DEBUG ("The %s property has been found in %" GST_PTR_FORMAT, prop_name,
+      child);
+  if (element)
+    *element = gst_object_ref (child);
+
+  *pspec = g_param_spec_ref (found);
+
+  return TRUE;
 }
 
 /**
@@ -1070,8 +1631,8 @@ ges_track_element_set_child_property_by_pspec (GESTrackElement * object,
   GstElement *element;
   g_return_if_fail (GES_IS_TRACK_ELEMENT (object));
 
-
-  element = g_hash_table_lookup (object->priv->children_props, pspec);
+  ensure_instantiated (object);
+  element = lookup_child_by_pspec (object, pspec);
   if (!element)
     goto not_found;
 
@@ -1111,6 +1672,7 @@ ges_track_element_set_child_property_valist (GESTrackElement * object,
 
   g_return_if_fail (GES_IS_TRACK_ELEMENT (object));
 
+  ensure_instantiated (object);
   name = first_property_name;
 
   /* Note: This part is in big part copied from the gst_child_object_set_valist
@@ -1205,6 +1767,7 @@ ges_track_element_get_child_property_valist (GESTrackElement * object,
 
   g_return_if_fail (G_IS_OBJECT (object));
 
+  ensure_instantiated (object);
   name = first_property_name;
 
   /* This part is in big part copied from the gst_child_object_get_valist method */
@@ -1257,6 +1820,7 @@ ges_track_element_list_children_properties (GESTrackElement * object,
 
   g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), NULL);
 
+  ensure_instantiated (object);
   class = GES_TRACK_ELEMENT_GET_CLASS (object);
 
   return class->list_children_properties (object, n_properties);
@@ -1301,7 +1865,8 @@ ges_track_element_get_child_property_by_pspec (GESTrackElement * object,
 
   g_return_if_fail (GES_IS_TRACK_ELEMENT (object));
 
-  element = g_hash_table_lookup (object->priv->children_props, pspec);
+  ensure_instantiated (object);
+  element = lookup_child_by_pspec (object, pspec);
   if (!element)
     goto not_found;
 
@@ -1339,6 +1904,7 @@ ges_track_element_set_child_property (GESTrackElement * object,
 
   g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
 
+  ensure_instantiated (object);
   if (!ges_track_element_lookup_child (object, property_name, &element, &pspec))
     goto not_found;
 
@@ -1385,6 +1951,7 @@ ges_track_element_get_child_property (GESTrackElement * object,
 
   g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
 
+  ensure_instantiated (object);
   if (!ges_track_element_lookup_child (object, property_name, &element, &pspec))
     goto not_found;
 
@@ -1406,25 +1973,310 @@ not_found:
   }
 }
 
+/* A handle is the GParamSpec of the property in its element class, which
+ * is also the key of the index of the children props tables */
+#define HANDLE_PSPEC(handle) ((GParamSpec *) (handle))
+
+/**
+ * ges_track_element_get_child_property_handle:
+ * @object: a #GESTrackElement
+ * @prop_name: The name of the property, with the same syntax as for
+ * #ges_track_element_lookup_child
+ *
+ * Resolves @prop_name to a handle, through which the property can then be
+ * set and read without looking its name up each time. The handle stays
+ * valid for the lifetime of the program, and can be used with any
+ * #GESTrackElement containing the same type of child element.
+ *
+ * Returns: (transfer none): The handle of @prop_name, or %NULL if @object
+ * has no such child property
+ */
+GESChildPropertyHandle *
+ges_track_element_get_child_property_handle (GESTrackElement * object,
+    const gchar * prop_name)
+{
+  GParamSpec *pspec;
+
+  g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), NULL);
+  g_return_val_if_fail (prop_name != NULL, NULL);
+
+  ensure_instantiated (object);
+  if (!ges_track_element_lookup_child (object, prop_name, NULL, &pspec))
+    return NULL;
+
+  /* Owned by the class of the child element */
+  g_param_spec_unref (pspec);
+
+  return (GESChildPropertyHandle *) pspec;
+}
+
+static inline GstElement *
+lookup_child_by_handle (GESTrackElement * object,
+    const GESChildPropertyHandle * handle)
+{
+  ensure_instantiated (object);
+
+  return lookup_child_by_pspec (object, HANDLE_PSPEC (handle));
+}
+
+/**
+ * ges_track_element_set_child_property_by_handle:
+ * @object: a #GESTrackElement
+ * @handle: The handle of the property, see
+ * #ges_track_element_get_child_property_handle
+ * @value: The value to set
+ *
+ * Sets the child property of @object identified by @handle.
+ *
+ * Returns: %TRUE if the property was set, %FALSE if @object has no such
+ * child property
+ */
+gboolean
+ges_track_element_set_child_property_by_handle (GESTrackElement * object,
+    const GESChildPropertyHandle * handle, const GValue * value)
+{
+  GstElement *element;
+
+  g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
+  g_return_val_if_fail (handle != NULL, FALSE);
+  g_return_val_if_fail (G_IS_VALUE (value), FALSE);
+
+  element = lookup_child_by_handle (object, handle);
+  if (element == NULL)
+    return FALSE;
+
+  g_object_set_property (G_OBJECT (element), HANDLE_PSPEC (handle)->name,
+      value);
+
+  return TRUE;
+}
+
+/**
+ * ges_track_element_get_child_property_by_handle:
+ * @object: a #GESTrackElement
+ * @handle: The handle of the property, see
+ * #ges_track_element_get_child_property_handle
+ * @value: (out): A #GValue to put the value in, it is initialized if it
+ * was not
+ *
+ * Gets the child property of @object identified by @handle.
+ *
+ * Returns: %TRUE if the property was read, %FALSE if @object has no such
+ * child property
+ */
+gboolean
+ges_track_element_get_child_property_by_handle (GESTrackElement * object,
+    const GESChildPropertyHandle * handle, GValue * value)
+{
+  GstElement *element;
+
+  g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
+  g_return_val_if_fail (handle != NULL, FALSE);
+  g_return_val_if_fail (value != NULL, FALSE);
+
+  element = lookup_child_by_handle (object, handle);
+  if (element == NULL)
+    return FALSE;
+
+  if (G_VALUE_TYPE (value) == G_TYPE_INVALID)
+    g_value_init (value, HANDLE_PSPEC (handle)->value_type);
+
+  g_object_get_property (G_OBJECT (element), HANDLE_PSPEC (handle)->name,
+      value);
+
+  return TRUE;
+}
+
+/* The notifications of the children are only emitted once all the
+ * properties are set, once per property */
+static void
+freeze_child (GPtrArray * frozen, GstElement * element)
+{
+  guint i;
+
+  for (i = 0; i < frozen->len; i++) {
+    if (g_ptr_array_index (frozen, i) == element)
+      return;
+  }
+
+  g_object_freeze_notify (G_OBJECT (element));
+  g_ptr_array_add (frozen, element);
+}
+
+static void
+thaw_children (GPtrArray * frozen)
+{
+  guint i;
+
+  for (i = 0; i < frozen->len; i++)
+    g_object_thaw_notify (g_ptr_array_index (frozen, i));
+
+  g_ptr_array_free (frozen, TRUE);
+}
+
+/**
+ * ges_track_element_set_child_properties_by_handle_valist:
+ * @object: a #GESTrackElement
+ * @first_handle: The handle of the first property to set
+ * @var_args: The value of the first property, followed optionally by more
+ * handle/value pairs, followed by %NULL
+ *
+ * Sets several child properties of @object at once, see
+ * #ges_track_element_set_child_properties_by_handle.
+ *
+ * Returns: %TRUE if all the properties were set, %FALSE otherwise
+ */
+gboolean
+ges_track_element_set_child_properties_by_handle_valist (GESTrackElement *
+    object, const GESChildPropertyHandle * first_handle, va_list var_args)
+{
+  GPtrArray *frozen;
+  GstElement *element;
+  GParamSpec *pspec;
+  const GESChildPropertyHandle *handle;
+  gchar *error = NULL;
+  GValue value = { 0, };
+  gboolean ret = TRUE;
+
+  g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
+
+  frozen = g_ptr_array_new ();
+  for (handle = first_handle; handle;
+      handle = va_arg (var_args, const GESChildPropertyHandle *)) {
+    pspec = HANDLE_PSPEC (handle);
+
+    /* The value has to be collected anyway to get to the next handle */
+    G_VALUE_COLLECT_INIT (&value, pspec->value_type, var_args,
+        G_VALUE_NOCOPY_CONTENTS, &error);
+    if (error) {
+      GST_WARNING_OBJECT (object, "error copying value %s: %s", pspec->name,
+          error);
+      g_free (error);
+      ret = FALSE;
+
+      /* The position in @var_args is unknown from there */
+      break;
+    }
+
+    element = lookup_child_by_handle (object, handle);
+    if (element) {
+      freeze_child (frozen, element);
+      g_object_set_property (G_OBJECT (element), pspec->name, &value);
+    } else {
+      GST_WARNING_OBJECT (object, "No child property %s", pspec->name);
+      ret = FALSE;
+    }
+    g_value_unset (&value);
+  }
+  thaw_children (frozen);
+
+  return ret;
+}
+
+/**
+ * ges_track_element_set_child_properties_by_handle:
+ * @object: a #GESTrackElement
+ * @first_handle: The handle of the first property to set
+ * @...: The value of the first property, followed optionally by more
+ * handle/value pairs, followed by %NULL
+ *
+ * Sets several child properties of @object at once, identified by the
+ * handles returned by #ges_track_element_get_child_property_handle. The
+ * notifications of the changes are only emitted once all the properties
+ * are set.
+ *
+ * Returns: %TRUE if all the properties were set, %FALSE otherwise
+ */
+gboolean
+ges_track_element_set_child_properties_by_handle (GESTrackElement * object,
+    const GESChildPropertyHandle * first_handle, ...)
+{
+  va_list var_args;
+  gboolean ret;
+
+  g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
+
+  va_start (var_args, first_handle);
+  ret = ges_track_element_set_child_properties_by_handle_valist (object,
+      first_handle, var_args);
+  va_end (var_args);
+
+  return ret;
+}
+
+/**
+ * ges_track_element_set_child_properties_array:
+ * @object: a #GESTrackElement
+ * @handles: (array length=n_properties): The handles of the properties to
+ * set, see #ges_track_element_get_child_property_handle
+ * @values: (array length=n_properties): The values to set
+ * @n_properties: The number of properties to set
+ *
+ * Sets several child properties of @object at once, as
+ * #ges_track_element_set_child_properties_by_handle does.
+ *
+ * Returns: %TRUE if all the properties were set, %FALSE otherwise
+ */
+gboolean
+ges_track_element_set_child_properties_array (GESTrackElement * object,
+    GESChildPropertyHandle ** handles, const GValue * values,
+    guint n_properties)
+{
+  guint i;
+  GPtrArray *frozen;
+  GstElement *element;
+  gboolean ret = TRUE;
+
+  g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
+  g_return_val_if_fail (n_properties == 0 || (handles && values), FALSE);
+
+  frozen = g_ptr_array_new ();
+  for (i = 0; i < n_properties; i++) {
+    element = lookup_child_by_handle (object, handles[i]);
+    if (element == NULL) {
+      GST_WARNING_OBJECT (object, "No child property %s",
+          HANDLE_PSPEC (handles[i])->name);
+      ret = FALSE;
+      continue;
+    }
+
+    freeze_child (frozen, element);
+    g_object_set_property (G_OBJECT (element), HANDLE_PSPEC (handles[i])->name,
+        &values[i]);
+  }
+  thaw_children (frozen);
+
+  return ret;
+}
+
 static GParamSpec **
 default_list_children_properties (GESTrackElement * object,
     guint * n_properties)
 {
   GParamSpec **pspec, *spec;
-  GHashTableIter iter;
-  gpointer key, value;
+  GList *tmp, *prev;
+  guint j, n = 0, i = 0;
+
+  for (tmp = object->priv->children_props; tmp; tmp = tmp->next)
+    n += ((ChildProps *) tmp->data)->table->specs->len;
+  pspec = g_new (GParamSpec *, n);
 
-  guint i = 0;
+  for (tmp = object->priv->children_props; tmp; tmp = tmp->next) {
+    ChildProps *props = tmp->data;
 
-  *n_properties = g_hash_table_size (object->priv->children_props);
-  pspec = g_new (GParamSpec *, *n_properties);
+    for (j = 0; j < props->table->specs->len; j++) {
+      spec = g_ptr_array_index (props->table->specs, j);
 
-  g_hash_table_iter_init (&iter, object->priv->children_props);
-  while (g_hash_table_iter_next (&iter, &key, &value)) {
-    spec = G_PARAM_SPEC (key);
-    pspec[i] = g_param_spec_ref (spec);
-    i++;
+      /* Listed once, with the table that was added last */
+      for (prev = object->priv->children_props; prev != tmp; prev = prev->next)
+        if (g_hash_table_contains (((ChildProps *) prev->data)->table->index,
+                spec))
+          break;
+      if (prev == tmp)
+        pspec[i++] = g_param_spec_ref (spec);
+    }
   }
+  *n_properties = i;
 
   return pspec;
 }
@@ -1518,6 +2370,9 @@ ges_track_element_split_bindings (GESTrackElement * element,
       last_value = value;
     }
 
+    /* The keyframes of @source have been split between both elements */
+    g_hash_table_remove (element->priv->keyframe_stores, specs[n]->name);
+
     /* We only manage direct bindings, see TODO in set_control_source */
     ges_track_element_set_control_source (new_element,
         GST_CONTROL_SOURCE (new_source), specs[n]->name, "direct");
@@ -1637,6 +2492,8 @@ ges_track_element_set_control_source (GESTrackElement * object,
     return TRUE;
   }
 
+  /* Elements with keyframes are never released */
+  ensure_instantiated (object);
   if (!ges_track_element_lookup_child (object, property_name, &element, &pspec)) {
     GST_WARNING ("You need to provide a valid and controllable property name");
     return FALSE;
@@ -1651,6 +2508,7 @@ ges_track_element_set_control_source (GESTrackElement * object,
     if (binding) {
       GST_LOG ("Removing old binding %p for property %s", binding,
           property_name);
+      unbake_binding (object, property_name);
       gst_object_remove_control_binding (GST_OBJECT (element), binding);
     }
     binding =
@@ -1659,6 +2517,7 @@ ges_track_element_set_control_source (GESTrackElement * object,
     gst_object_add_control_binding (GST_OBJECT (element), binding);
     g_hash_table_insert (priv->bindings_hashtable, g_strdup (property_name),
         binding);
+    ges_track_invalidate_baked_controls (priv->track, object);
     return TRUE;
   }
 
@@ -1694,3 +2553,161 @@ ges_track_element_get_control_binding (GESTrackElement * object,
       property_name);
   return binding;
 }
+
+/* Returns: (transfer full): The timed value control source bound to
+ * @property_name, or that will be once we are in a track. The property can
+ * be named with or without the class name, whichever was used to bind it */
+static GstTimedValueControlSource *
+get_timed_value_source (GESTrackElement * object, const gchar * property_name)
+{
+  GList *tmp;
+  GHashTableIter iter;
+  const gchar *name, *key = property_key (property_name);
+  GstControlSource *source = NULL;
+  GstControlBinding *binding = NULL, *tmp_binding;
+
+  g_hash_table_iter_init (&iter, object->priv->bindings_hashtable);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & name,
+          (gpointer *) & tmp_binding)) {
+    if (!g_strcmp0 (property_key (name), key)) {
+      binding = tmp_binding;
+      break;
+    }
+  }
+
+  if (binding) {
+    g_object_get (binding, "control_source", &source, NULL);
+  } else {
+    for (tmp = object->priv->pending_bindings; tmp; tmp = tmp->next) {
+      PendingBinding *pbinding = tmp->data;
+
+      if (!g_strcmp0 (property_key (pbinding->propname), key)) {
+        source = gst_object_ref (pbinding->source);
+        break;
+      }
+    }
+  }
+
+  if (source && !GST_IS_TIMED_VALUE_CONTROL_SOURCE (source)) {
+    gst_object_unref (source);
+    source = NULL;
+  }
+
+  return (GstTimedValueControlSource *) source;
+}
+
+/**
+ * ges_track_element_set_keyframes:
+ * @object: a #GESTrackElement
+ * @property_name: The name of a property controlled with
+ * #ges_track_element_set_control_source, with or without its class name
+ * @timestamps: (array length=n_keyframes): The timestamps of the keyframes,
+ * in the time of the media
+ * @values: (array length=n_keyframes): The values of the keyframes
+ * @n_keyframes: The number of keyframes
+ *
+ * Replaces all the keyframes of @property_name at once, which is a lot
+ * faster than setting them one by one on the #GstTimedValueControlSource.
+ * As when setting them on the control source directly, they are trimmed to
+ * the in-point and duration of @object when those change. The keyframes
+ * trimmed out are kept, for when @object is extended back.
+ *
+ * With GStreamer versions before 1.6, whose control sources do not signal
+ * their changes, values changed in place on the control source are not
+ * noticed, and have to be set with this function instead.
+ *
+ * Returns: %TRUE if the keyframes could be set, %FALSE if @property_name
+ * is not controlled by a #GstTimedValueControlSource
+ */
+gboolean
+ges_track_element_set_keyframes (GESTrackElement * object,
+    const gchar * property_name, const GstClockTime * timestamps,
+    const gdouble * values, guint n_keyframes)
+{
+  const gchar *key;
+  GESKeyframeStore *store;
+  GstTimedValueControlSource *source;
+
+  g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
+  g_return_val_if_fail (property_name != NULL, FALSE);
+  g_return_val_if_fail (n_keyframes == 0 || (timestamps && values), FALSE);
+
+  source = get_timed_value_source (object, property_name);
+  if (source == NULL) {
+    GST_WARNING_OBJECT (object, "%s has no timed value control source",
+        property_name);
+
+    return FALSE;
+  }
+
+  key = property_key (property_name);
+  store = g_hash_table_lookup (object->priv->keyframe_stores, key);
+  if (store == NULL) {
+    store = ges_keyframe_store_new ();
+    g_hash_table_insert (object->priv->keyframe_stores, g_strdup (key), store);
+  }
+
+  ges_keyframe_store_replace (store, timestamps, values, n_keyframes);
+  ges_keyframe_store_feed_all (store, source);
+  gst_object_unref (source);
+
+  /* The table sampled from the previous keyframes is outdated */
+  unbake_binding (object, property_name);
+  if (object->priv->track)
+    ges_track_invalidate_baked_controls (object->priv->track, object);
+
+  return TRUE;
+}
+
+/**
+ * ges_track_element_get_keyframes:
+ * @object: a #GESTrackElement
+ * @property_name: The name of a property controlled with
+ * #ges_track_element_set_control_source, with or without its class name
+ * @timestamps: (out) (array length=n_keyframes) (transfer full): The
+ * timestamps of the keyframes, sorted
+ * @values: (out) (array length=n_keyframes) (transfer full): The values of
+ * the keyframes
+ * @n_keyframes: (out): The number of keyframes
+ *
+ * Gets all the keyframes of @property_name at once, including the ones
+ * outside of the in-point and duration of @object, see
+ * #ges_track_element_set_keyframes.
+ *
+ * Returns: %TRUE if the keyframes could be retrieved, %FALSE if
+ * @property_name is not controlled by a #GstTimedValueControlSource
+ */
+gboolean
+ges_track_element_get_keyframes (GESTrackElement * object,
+    const gchar * property_name, GstClockTime ** timestamps,
+    gdouble ** values, guint * n_keyframes)
+{
+  guint i, n;
+  const GESKeyframe *keyframes;
+  GESKeyframeStore *store;
+  GstTimedValueControlSource *source;
+
+  g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
+  g_return_val_if_fail (property_name != NULL, FALSE);
+  g_return_val_if_fail (timestamps && values && n_keyframes, FALSE);
+
+  source = get_timed_value_source (object, property_name);
+  if (source == NULL)
+    return FALSE;
+
+  store = get_keyframe_store (object, property_key (property_name),
+      source);
+  gst_object_unref (source);
+
+  n = ges_keyframe_store_get_size (store);
+  keyframes = ges_keyframe_store_get_keyframes (store);
+  *timestamps = g_new (GstClockTime, n);
+  *values = g_new (gdouble, n);
+  for (i = 0; i < n; i++) {
+    (*timestamps)[i] = keyframes[i].timestamp;
+    (*values)[i] = keyframes[i].value;
+  }
+  *n_keyframes = n;
+
+  return TRUE;
+}
@@ -50,6 +50,14 @@ G_BEGIN_DECLS
 
 typedef struct _GESTrackElementPrivate GESTrackElementPrivate;
 
+/**
+ * GESChildPropertyHandle:
+ *
+ * An opaque handle to a property of a child of #GESTrackElement-s, see
+ * #ges_track_element_get_child_property_handle.
+ */
+typedef struct _GESChildPropertyHandle GESChildPropertyHandle;
+
 /**
  * GESTrackElement:
  *
@@ -171,6 +179,36 @@ gboolean ges_track_element_get_child_property (GESTrackElement *object,
                                               const gchar *property_name,
                                               GValue * value);
 
+GESChildPropertyHandle *
+ges_track_element_get_child_property_handle   (GESTrackElement *object,
+                                              const gchar *prop_name);
+
+gboolean
+ges_track_element_set_child_property_by_handle (GESTrackElement *object,
+                                               const GESChildPropertyHandle *handle,
+                                               const GValue *value);
+
+gboolean
+ges_track_element_get_child_property_by_handle (GESTrackElement *object,
+                                               const GESChildPropertyHandle *handle,
+                                               GValue *value);
+
+gboolean
+ges_track_element_set_child_properties_by_handle_valist (GESTrackElement *object,
+                                                        const GESChildPropertyHandle *first_handle,
+                                                        va_list var_args);
+
+gboolean
+ges_track_element_set_child_properties_by_handle (GESTrackElement *object,
+                                                 const GESChildPropertyHandle *first_handle,
+                                                 ...) G_GNUC_NULL_TERMINATED;
+
+gboolean
+ges_track_element_set_child_properties_array  (GESTrackElement *object,
+                                              GESChildPropertyHandle **handles,
+                                              const GValue *values,
+                                              guint n_properties);
+
 gboolean
 ges_track_element_edit                        (GESTrackElement * object,
                                               GList *layers, GESEditMode mode,
@@ -185,6 +223,20 @@ ges_track_element_set_control_source          (GESTrackElement *object,
 GstControlBinding *
 ges_track_element_get_control_binding         (GESTrackElement *object,
                                                const gchar *property_name);
+
+gboolean
+ges_track_element_set_keyframes               (GESTrackElement *object,
+                                               const gchar *property_name,
+                                               const GstClockTime *timestamps,
+                                               const gdouble *values,
+                                               guint n_keyframes);
+
+gboolean
+ges_track_element_get_keyframes               (GESTrackElement *object,
+                                               const gchar *property_name,
+                                               GstClockTime **timestamps,
+                                               gdouble **values,
+                                               guint *n_keyframes);
 void
 ges_track_element_add_children_props          (GESTrackElement *self,
                                                GstElement *element,
@@ -32,9 +32,13 @@
 #include "ges-internal.h"
 #include "ges-track.h"
 #include "ges-track-element.h"
+#include "ges-source.h"
+#include "ges-clip.h"
+#include "ges-layer.h"
 #include "ges-meta-container.h"
 #include "ges-video-track.h"
 #include "ges-audio-track.h"
+#include "ges-interval-tree.h"
 
 G_DEFINE_TYPE_WITH_CODE (GESTrack, ges_track, GST_TYPE_BIN,
     G_IMPLEMENT_INTERFACE (GES_TYPE_META_CONTAINER, NULL));
@@ -47,16 +51,55 @@ typedef struct
 
   GstClockTime start;
   GstClockTime duration;
+  guint32 priority;
   GESTrack *track;
+
+  /* The function that created the content of @gnlobj, if any */
+  GESCreateElementForGapFunc create_func;
 } Gap;
 
+/* Nested compositions holding the elements of one layer, see
+ * ges_track_set_layer_compositions. A nested composition covers everything
+ * from its first element to its last one, so a hole in it would hide the
+ * layers below, there is one composition per run of elements without holes */
+typedef struct
+{
+  GESLayer *layer;
+  GESTrack *track;
+
+  GPtrArray *segments;          /* GnlComposition-s sorted by start */
+  GHashTable *elements;         /* {TrackElement: TrackElement} */
+  gboolean active;
+  gboolean dirty;               /* Needs to be restacked and committed */
+  gboolean rebased;             /* The base of @layer changed */
+} LayerComposition;
+
+/* The data of the probe of the source pad of the composition, see
+ * set_instantiation_probe */
+typedef struct
+{
+  GESTrack *track;
+  GstClockTime window;
+} InstantiationProbe;
+
+/* Maximum number of unused gaps kept around to be reused */
+#define MAX_POOLED_GAPS 16
+
+/* Maximum number of released source elements kept around per asset */
+#define MAX_POOLED_SOURCES 4
+
+/* Priority of the gaps, or of the background, see ges_track_set_background */
+#define GAP_PRIORITY 1
+#define BACKGROUND_PRIORITY G_MAXUINT32
+
 struct _GESTrackPrivate
 {
   /*< private > */
   GESTimeline *timeline;
   GSequence *trackelements_by_start;
   GHashTable *trackelements_iter;
-  GList *gaps;
+  GList *gaps;                  /* Sorted by start */
+  GList *gaps_pool;             /* Gaps out of the composition, to be reused */
 
   guint64 duration;
 
@@ -68,10 +111,65 @@ struct _GESTrackPrivate
 
   gboolean updating;
 
+  /* Depth of the timeline edit transactions, the elements that changed
+   * during a transaction are only put back in place once the outermost one
+   * is over */
+  guint edit_depth;
+  GHashTable *moved_elements;   /* {TrackElement: TrackElement} */
+
   gboolean mixing;
   GstElement *mixing_operation;
+
+  /* Whether a single gap is used behind all the elements instead of one gap
+   * in each hole */
+  gboolean background;
+
+  /* Whether mixing operations are only placed where sources overlap,
+   * instead of using @mixing_operation over the whole track */
+  gboolean region_mixing;
+  GList *mixing_regions;        /* Gap-s of mixing operations sorted by start */
+
+  /* Whether the elements are in one nested composition per layer instead
+   * of being directly in @composition */
+  gboolean layer_compositions;
+  GHashTable *layer_comps;      /* {GESLayer: LayerComposition} */
+  GHashTable *element_comps;    /* {TrackElement: LayerComposition} */
+  GHashTable *dirty_comps;      /* {LayerComposition: LayerComposition} */
+
+  /* Changes since the last commit, the track is only committed if any */
+  GHashTable *dirty_elements;   /* {TrackElement: TrackElement} */
+  gboolean needs_commit;        /* Something else than the elements changed */
+  GstClockTime gaps_timeline_duration;  /* Timeline duration the gaps use */
+  GstClockTime gaps_elements_end;       /* End of the last element */
+  guint gaps_changed;
+  GstStructure *commit_stats;
   GstElement *capsfilter;
 
+  /* Only the content of the sources around the playback position is
+   * instantiated, see ges_track_set_instantiation_window. The lazy sources
+   * are instantiated from the thread of the seeks too, the following are
+   * protected by @instantiation_lock */
+  GRecMutex instantiation_lock;
+  GstClockTime instantiation_window;
+  GstClockTime instantiation_position;
+  GESIntervalTree *lazy_elements;       /* Lazy TrackElement-s */
+  GHashTable *lazy_nodes;       /* {TrackElement: GESIntervalNode} */
+  GHashTable *instantiated;     /* {TrackElement: TrackElement} */
+  GHashTable *source_pool;      /* {pool key: GQueue of GstElement} */
+
+  GstPad *instantiation_pad;    /* The source pad of @composition */
+  gulong instantiation_probe;   /* Only set while the window is valid */
+  gint instantiation_pending;   /* atomic, an update is to be done from
+                                 * the main context */
+  GstClockTime playback_position;       /* Protected by the object lock */
+  GstClockTime probed_position; /* Only used from the streaming thread */
+  GstSegment segment;           /* Only used from the streaming thread */
+
+  /* Whether the control bindings of the elements are driven from tables
+   * sampled at the framerate on commit, see ges_track_set_baked_controls */
+  gboolean baked_controls;
+  GHashTable *controlled_elements;      /* {TrackElement: TrackElement} */
+
   /* Virtual method to create GstElement that fill gaps */
   GESCreateElementForGapFunc create_element_for_gaps;
 };
@@ -86,6 +184,7 @@ enum
   ARG_LAST,
   TRACK_ELEMENT_ADDED,
   TRACK_ELEMENT_REMOVED,
+  COMMIT_STATS,
   LAST_SIGNAL
 };
 
@@ -107,6 +206,22 @@ add_trackelement_to_list_foreach (GESTrackElement * trackelement, GList ** list)
   *list = g_list_prepend (*list, trackelement);
 }
 
+/* Sets the position of @gap, only touching its gnlsource when it changed */
+static void
+gap_set_position (Gap * gap, GstClockTime start, GstClockTime duration)
+{
+  if (gap->start == start && gap->duration == duration)
+    return;
+
+  gap->start = start;
+  gap->duration = duration;
+  g_object_set (gap->gnlobj, "start", start, "duration", duration, NULL);
+
+  GST_DEBUG_OBJECT (gap->track,
+      "Gap now has start %" GST_TIME_FORMAT " duration %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (start), GST_TIME_ARGS (duration));
+}
+
 static Gap *
 gap_new (GESTrack * track, GstClockTime start, GstClockTime duration)
 {
@@ -114,6 +229,27 @@ gap_new (GESTrack * track, GstClockTime start, GstClockTime duration)
 
   Gap *new_gap;
 
+  /* Reuse a gnlsource we already built if possible */
+  if (track->priv->gaps_pool) {
+    new_gap = track->priv->gaps_pool->data;
+    track->priv->gaps_pool =
+        g_list_delete_link (track->priv->gaps_pool, track->priv->gaps_pool);
+
+    if (G_UNLIKELY (gst_bin_add (GST_BIN (track->priv->composition),
+                new_gap->gnlobj) == FALSE)) {
+      GST_WARNING_OBJECT (track, "Could not add gap to the composition");
+      gst_object_unref (new_gap->gnlobj);
+      g_slice_free (Gap, new_gap);
+
+      return NULL;
+    }
+
+    GST_DEBUG_OBJECT (track, "Reusing gap from the pool");
+    gap_set_position (new_gap, start, duration);
+
+    return new_gap;
+  }
+
   gnlsrc = gst_element_factory_make ("gnlsource", NULL);
   elem = track->priv->create_element_for_gaps (track);
   if (G_UNLIKELY (gst_bin_add (GST_BIN (gnlsrc), elem) == FALSE)) {
@@ -144,12 +280,14 @@ gap_new (GESTrack * track, GstClockTime start, GstClockTime duration)
   new_gap = g_slice_new (Gap);
   new_gap->start = start;
   new_gap->duration = duration;
+  new_gap->priority = GAP_PRIORITY;
   new_gap->track = track;
   new_gap->gnlobj = gst_object_ref (gnlsrc);
+  new_gap->create_func = track->priv->create_element_for_gaps;
 
 
   g_object_set (gnlsrc, "start", new_gap->start, "duration", new_gap->duration,
-      "priority", 1, NULL);
+      "priority", new_gap->priority, NULL);
 
   GST_DEBUG_OBJECT (track,
       "Created gap with start %" GST_TIME_FORMAT " duration %" GST_TIME_FORMAT,
@@ -159,6 +297,14 @@ gap_new (GESTrack * track, GstClockTime start, GstClockTime duration)
   return new_gap;
 }
 
+/* Frees a gap that is not in the composition anymore */
+static void
+destroy_gap (Gap * gap)
+{
+  gst_object_unref (gap->gnlobj);
+  g_slice_free (Gap, gap);
+}
+
 static void
 free_gap (Gap * gap)
 {
@@ -169,17 +315,118 @@ free_gap (Gap * gap)
       GST_TIME_ARGS (gap->duration));
   gst_bin_remove (GST_BIN (track->priv->composition), gap->gnlobj);
   gst_element_set_state (gap->gnlobj, GST_STATE_NULL);
-  gst_object_unref (gap->gnlobj);
 
-  g_slice_free (Gap, gap);
+  /* Keep a few of them around for the next gaps to be created, as long as
+   * they hold what the current function creates */
+  if (gap->create_func == track->priv->create_element_for_gaps &&
+      g_list_length (track->priv->gaps_pool) < MAX_POOLED_GAPS)
+    track->priv->gaps_pool = g_list_prepend (track->priv->gaps_pool, gap);
+  else
+    destroy_gap (gap);
+}
+
+typedef struct
+{
+  GstClockTime start;
+  GstClockTime duration;
+} GapPosition;
+
+static gint
+compare_gaps (Gap * a, Gap * b)
+{
+  if (a->start < b->start)
+    return -1;
+
+  return a->start > b->start;
+}
+
+/* Makes the gaps of @track match @positions. Gaps that did not change are
+ * not touched at all, the ones that did are moved in place and only the
+ * gaps that are left are removed from the composition or added to it */
+static void
+apply_gaps (GESTrack * track, GArray * positions, guint32 priority)
+{
+  Gap *gap;
+  guint i, j;
+  GList *old, *unmatched = NULL;
+  GESTrackPrivate *priv = track->priv;
+  GArray *missing = g_array_new (FALSE, FALSE, sizeof (GapPosition));
+
+  /* Gaps created by a previous function are replaced */
+  for (old = priv->gaps; old;) {
+    GList *next = old->next;
+
+    gap = old->data;
+    if (gap->create_func != priv->create_element_for_gaps) {
+      free_gap (gap);
+      priv->gaps = g_list_delete_link (priv->gaps, old);
+      priv->gaps_changed++;
+    }
+    old = next;
+  }
+
+  /* Both are sorted by start, find the gaps that start at the same time */
+  old = priv->gaps;
+  priv->gaps = NULL;
+  for (i = 0; i < positions->len || old;) {
+    GapPosition *position = i < positions->len ?
+        &g_array_index (positions, GapPosition, i) : NULL;
+
+    gap = old ? old->data : NULL;
+    if (gap && position && gap->start == position->start) {
+      if (gap->duration != position->duration)
+        priv->gaps_changed++;
+
+      gap_set_position (gap, position->start, position->duration);
+      priv->gaps = g_list_prepend (priv->gaps, gap);
+      old = g_list_delete_link (old, old);
+      i++;
+    } else if (gap && (!position || gap->start < position->start)) {
+      unmatched = g_list_prepend (unmatched, gap);
+      old = g_list_delete_link (old, old);
+    } else {
+      g_array_append_val (missing, *position);
+      i++;
+    }
+  }
+
+  /* Move the unmatched gaps where gaps are missing */
+  unmatched = g_list_reverse (unmatched);
+  priv->gaps_changed += MAX (missing->len, g_list_length (unmatched));
+  for (j = 0; j < missing->len; j++) {
+    GapPosition *position = &g_array_index (missing, GapPosition, j);
+
+    if (unmatched) {
+      gap = unmatched->data;
+      unmatched = g_list_delete_link (unmatched, unmatched);
+      gap_set_position (gap, position->start, position->duration);
+    } else if (!(gap = gap_new (track, position->start, position->duration)))
+      continue;
+
+    priv->gaps = g_list_prepend (priv->gaps, gap);
+  }
+
+  g_list_free_full (unmatched, (GDestroyNotify) free_gap);
+  g_array_free (missing, TRUE);
+
+  priv->gaps = g_list_sort (priv->gaps, (GCompareFunc) compare_gaps);
+
+  for (old = priv->gaps; old; old = old->next) {
+    gap = old->data;
+
+    if (gap->priority != priority) {
+      gap->priority = priority;
+      g_object_set (gap->gnlobj, "priority", priority, NULL);
+    }
+  }
 }
 
 static inline void
 update_gaps (GESTrack * track)
 {
-  Gap *gap;
-  GList *gaps;
   GSequenceIter *it;
+  GArray *positions;
+  GapPosition position;
 
   GESTrackElement *trackelement;
   GstClockTime start, end, duration = 0, timeline_duration;
@@ -189,11 +436,14 @@ update_gaps (GESTrack * track)
   if (priv->create_element_for_gaps == NULL) {
     GST_INFO ("Not filling the gaps as no create_element_for_gaps vmethod"
         " provided");
+
+    /* Those were created by a function that was unset since */
+    g_list_free_full (priv->gaps, (GDestroyNotify) free_gap);
+    priv->gaps = NULL;
     return;
   }
 
-  gaps = priv->gaps;
-  priv->gaps = NULL;
+  positions = g_array_new (FALSE, FALSE, sizeof (GapPosition));
 
   /* 1- And recalculate gaps */
   for (it = g_sequence_get_begin_iter (priv->trackelements_by_start);
@@ -203,44 +453,849 @@ update_gaps (GESTrack * track)
     start = _START (trackelement);
     end = start + _DURATION (trackelement);
 
-    if (start > duration) {
+    if (start > duration && !priv->background) {
       /* 2- Fill gap */
-      gap = gap_new (track, duration, start - duration);
-
-      if (G_LIKELY (gap != NULL))
-        priv->gaps = g_list_prepend (priv->gaps, gap);
+      position.start = duration;
+      position.duration = start - duration;
+      g_array_append_val (positions, position);
     }
 
     duration = MAX (duration, end);
   }
 
-  /* 4- Add a gap at the end of the timeline if needed */
+  /* 3- Add a gap at the end of the timeline if needed */
   if (priv->timeline) {
     g_object_get (priv->timeline, "duration", &timeline_duration, NULL);
+    priv->gaps_timeline_duration = timeline_duration;
+    priv->gaps_elements_end = duration;
 
     if (duration < timeline_duration) {
-      gap = gap_new (track, duration, timeline_duration - duration);
+      position.start = duration;
+      position.duration = timeline_duration - duration;
+      if (!priv->background)
+        g_array_append_val (positions, position);
+
+      priv->duration = duration = timeline_duration;
+    }
+  }
+
+  /* 4- Or only use one gap behind all the elements of the track */
+  if (priv->background && duration) {
+    position.start = 0;
+    position.duration = duration;
+    g_array_append_val (positions, position);
+  }
+
+  /* 5- Update the gaps we already have */
+  apply_gaps (track, positions,
+      priv->background ? BACKGROUND_PRIORITY : GAP_PRIORITY);
+  g_array_free (positions, TRUE);
+}
+
+static Gap *
+mixing_region_new (GESTrack * track, GstClockTime start,
+    GstClockTime duration)
+{
+  Gap *region;
+  GstElement *gnlobject, *mixer;
+
+  mixer = GES_TRACK_GET_CLASS (track)->get_mixing_element (track);
+  if (mixer == NULL) {
+    GST_WARNING_OBJECT (track, "Got no element fron get_mixing_element");
+
+    return NULL;
+  }
+
+  gnlobject = gst_element_factory_make ("gnloperation", NULL);
+  if (!gst_bin_add (GST_BIN (gnlobject), mixer)) {
+    GST_WARNING_OBJECT (track, "Could not add the mixer to its operation");
+    gst_object_unref (gnlobject);
+    gst_object_unref (mixer);
+
+    return NULL;
+  }
+
+  if (!gst_bin_add (GST_BIN (track->priv->composition), gnlobject)) {
+    GST_WARNING_OBJECT (track, "Could not add the mixer to our composition");
+    gst_object_unref (gnlobject);
+
+    return NULL;
+  }
+
+  region = g_slice_new (Gap);
+  region->start = start;
+  region->duration = duration;
+  region->priority = 0;
+  region->track = track;
+  region->gnlobj = gst_object_ref (gnlobject);
+  region->create_func = NULL;
+
+  g_object_set (gnlobject, "start", start, "duration", duration,
+      "priority", region->priority, NULL);
+
+  GST_DEBUG_OBJECT (track, "Created mixing region with start %"
+      GST_TIME_FORMAT " duration %" GST_TIME_FORMAT, GST_TIME_ARGS (start),
+      GST_TIME_ARGS (duration));
+
+  return region;
+}
+
+static void
+free_mixing_region (Gap * region)
+{
+  gst_bin_remove (GST_BIN (region->track->priv->composition),
+      region->gnlobj);
+  gst_element_set_state (region->gnlobj, GST_STATE_NULL);
+  destroy_gap (region);
+}
+
+static void
+clear_mixing_regions (GESTrack * track)
+{
+  g_list_free_full (track->priv->mixing_regions,
+      (GDestroyNotify) free_mixing_region);
+  track->priv->mixing_regions = NULL;
+}
+
+/* Places mixing operations over the regions where at least two sources
+ * overlap. As the sources are sorted by start, such a region is where a
+ * source starts before the end of all the previous ones. The existing
+ * operations are moved in place so that nothing changes in the composition
+ * if the regions did not */
+static void
+update_mixing_regions (GESTrack * track)
+{
+  guint i;
+  Gap *region;
+  GArray *regions;
+  GSequenceIter *it;
+  GList *tmp, *old;
+  GapPosition position, *last;
+  GESTrackElement *trackelement;
+  GstClockTime start, end, max_end = 0;
+  GESTrackPrivate *priv = track->priv;
+
+  regions = g_array_new (FALSE, FALSE, sizeof (GapPosition));
+  for (it = g_sequence_get_begin_iter (priv->trackelements_by_start);
+      g_sequence_iter_is_end (it) == FALSE; it = g_sequence_iter_next (it)) {
+    trackelement = g_sequence_get (it);
+
+    if (!GES_IS_SOURCE (trackelement) ||
+        !ges_track_element_is_active (trackelement))
+      continue;
+
+    start = _START (trackelement);
+    end = start + _DURATION (trackelement);
+
+    if (start < max_end) {
+      last = regions->len ?
+          &g_array_index (regions, GapPosition, regions->len - 1) : NULL;
+
+      if (last && last->start + last->duration >= start) {
+        last->duration = MAX (last->start + last->duration,
+            MIN (end, max_end)) - last->start;
+      } else {
+        position.start = start;
+        position.duration = MIN (end, max_end) - start;
+        g_array_append_val (regions, position);
+      }
+    }
+
+    max_end = MAX (max_end, end);
+  }
+
+  old = priv->mixing_regions;
+  priv->mixing_regions = NULL;
+  for (i = 0, tmp = old; i < regions->len; i++) {
+    GapPosition *p = &g_array_index (regions, GapPosition, i);
+
+    if (tmp) {
+      region = tmp->data;
+      tmp = g_list_delete_link (tmp, tmp);
+      gap_set_position (region, p->start, p->duration);
+    } else if (!(region = mixing_region_new (track, p->start, p->duration)))
+      continue;
+
+    priv->mixing_regions = g_list_prepend (priv->mixing_regions, region);
+  }
+  priv->mixing_regions = g_list_reverse (priv->mixing_regions);
+
+  g_list_free_full (tmp, (GDestroyNotify) free_mixing_region);
+  g_array_free (regions, TRUE);
+}
+
+static void layer_destroyed_cb (GESTrack * track, GESLayer * layer);
+
+static LayerComposition *
+layer_composition_new (GESTrack * track, GESLayer * layer)
+{
+  LayerComposition *comp;
+
+  comp = g_slice_new0 (LayerComposition);
+  comp->layer = layer;
+  comp->track = track;
+  comp->segments = g_ptr_array_new ();
+  comp->elements = g_hash_table_new (g_direct_hash, g_direct_equal);
+  comp->active = TRUE;
+
+  g_object_weak_ref (G_OBJECT (layer), (GWeakNotify) layer_destroyed_cb,
+      track);
+
+  GST_DEBUG_OBJECT (track, "Created composition for layer %p", layer);
+
+  return comp;
+}
+
+static GstElement *
+layer_segment_new (LayerComposition * comp)
+{
+  GESTrack *track = comp->track;
+  GstElement *segment = gst_element_factory_make ("gnlcomposition", NULL);
+
+  if (segment == NULL) {
+    GST_WARNING_OBJECT (track, "Could not create a layer composition");
+
+    return NULL;
+  }
+
+  if (track->priv->caps)
+    g_object_set (segment, "caps", track->priv->caps, NULL);
+  g_object_set (segment, "priority", comp->layer->min_gnl_priority,
+      "active", comp->active, NULL);
+
+  if (!gst_bin_add (GST_BIN (track->priv->composition), segment)) {
+    GST_WARNING_OBJECT (track, "Could not add the layer composition");
+    gst_object_unref (segment);
+
+    return NULL;
+  }
+
+  return gst_object_ref (segment);
+}
+
+/* The elements must have been moved out of @segment already */
+static void
+layer_segment_free (LayerComposition * comp, GstElement * segment)
+{
+  gst_bin_remove (GST_BIN (comp->track->priv->composition), segment);
+  gst_element_set_state (segment, GST_STATE_NULL);
+  gst_object_unref (segment);
+}
+
+/* The elements must have been moved out of @comp already */
+static void
+free_layer_composition (LayerComposition * comp)
+{
+  guint i;
+
+  if (comp->layer)
+    g_object_weak_unref (G_OBJECT (comp->layer),
+        (GWeakNotify) layer_destroyed_cb, comp->track);
+
+  for (i = 0; i < comp->segments->len; i++)
+    layer_segment_free (comp, g_ptr_array_index (comp->segments, i));
+  g_ptr_array_free (comp->segments, TRUE);
+  g_hash_table_unref (comp->elements);
+  g_slice_free (LayerComposition, comp);
+}
+
+/* Only the layer compositions in @dirty_comps are looked at on commit */
+static void
+set_layer_composition_dirty (GESTrack * track, LayerComposition * comp)
+{
+  comp->dirty = TRUE;
+  g_hash_table_insert (track->priv->dirty_comps, comp, comp);
+}
+
+static LayerComposition *
+get_layer_composition (GESTrack * track, GESLayer * layer)
+{
+  LayerComposition *comp = g_hash_table_lookup (track->priv->layer_comps,
+      layer);
+
+  if (comp == NULL) {
+    comp = layer_composition_new (track, layer);
+    g_hash_table_insert (track->priv->layer_comps, layer, comp);
+    set_layer_composition_dirty (track, comp);
+  }
+
+  return comp;
+}
+
+/* Returns the layer of the clip of @element, without a reference */
+static GESLayer *
+track_element_get_layer (GESTrackElement * element)
+{
+  GESLayer *layer;
+  GESTimelineElement *parent = GES_TIMELINE_ELEMENT_PARENT (element);
+
+  if (parent == NULL || !GES_IS_CLIP (parent))
+    return NULL;
+
+  layer = ges_clip_get_layer (GES_CLIP (parent));
+  if (layer)
+    g_object_unref (layer);
+
+  return layer;
+}
+
+/* Returns the composition the gnlobject of @element has to be in */
+static LayerComposition *
+track_element_get_composition (GESTrack * track, GESTrackElement * element)
+{
+  GESLayer *layer;
+
+  if (!track->priv->layer_compositions)
+    return NULL;
+
+  layer = track_element_get_layer (element);
+
+  return layer ? get_layer_composition (track, layer) : NULL;
+}
+
+/* Moves the gnlobject of @element into @bin, from wherever it is */
+static gboolean
+move_gnlobject_to_bin (GESTrack * track, GESTrackElement * element,
+    GstElement * bin)
+{
+  GstElement *gnlobject = ges_track_element_get_gnlobject (element);
+  GstObject *current = GST_OBJECT_PARENT (gnlobject);
+
+  if (current == GST_OBJECT (bin))
+    return TRUE;
+
+  gst_object_ref (gnlobject);
+  if ((current && !gst_bin_remove (GST_BIN (current), gnlobject)) ||
+      !gst_bin_add (GST_BIN (bin), gnlobject)) {
+    GST_WARNING_OBJECT (track, "Could not move %" GST_PTR_FORMAT
+        " to its composition", element);
+    gst_object_unref (gnlobject);
 
-      if (G_LIKELY (gap != NULL)) {
-        priv->gaps = g_list_prepend (priv->gaps, gap);
+    return FALSE;
+  }
+  gst_object_unref (gnlobject);
+
+  return TRUE;
+}
+
+/* Makes @element part of @comp, or of no layer composition if @comp is
+ * %NULL. Its gnlobject waits in the composition of @track until @comp is
+ * restacked, see restack_layer_composition */
+static gboolean
+move_element_to_composition (GESTrack * track, GESTrackElement * element,
+    LayerComposition * comp)
+{
+  LayerComposition *current = g_hash_table_lookup (track->priv->element_comps,
+      element);
+
+  if (current == comp)
+    return TRUE;
+
+  if (current && !move_gnlobject_to_bin (track, element,
+          track->priv->composition))
+    return FALSE;
+
+  if (current) {
+    g_hash_table_remove (current->elements, element);
+    set_layer_composition_dirty (track, current);
+    g_hash_table_remove (track->priv->element_comps, element);
+  }
+
+  if (comp) {
+    g_hash_table_insert (comp->elements, element, element);
+    set_layer_composition_dirty (track, comp);
+    g_hash_table_insert (track->priv->element_comps, element, comp);
+  }
+
+  return TRUE;
+}
+
+/* Called when @layer is finalized, with its composition still around */
+static void
+layer_destroyed_cb (GESTrack * track, GESLayer * layer)
+{
+  GList *elements, *tmp;
+  LayerComposition *comp = g_hash_table_lookup (track->priv->layer_comps,
+      layer);
+
+  comp->layer = NULL;
+  elements = g_hash_table_get_keys (comp->elements);
+  for (tmp = elements; tmp; tmp = tmp->next)
+    move_element_to_composition (track, tmp->data, NULL);
+  g_list_free (elements);
+
+  g_hash_table_remove (track->priv->dirty_comps, comp);
+  g_hash_table_remove (track->priv->layer_comps, layer);
+}
+
+/* Puts each run of overlapping or contiguous elements of @comp in its own
+ * segment, reusing the segments @comp already has in order. This is linear
+ * in the number of elements of the layer */
+static void
+restack_layer_composition (LayerComposition * comp)
+{
+  GList *elements, *tmp;
+  guint n_segments = 0;
+  GstClockTime run_end = 0;
+  GstElement *segment = NULL;
+  GESTrackElement *element;
+
+  elements = g_list_sort_with_data (g_hash_table_get_keys (comp->elements),
+      (GCompareDataFunc) element_start_compare, NULL);
+
+  for (tmp = elements; tmp; tmp = tmp->next) {
+    element = tmp->data;
+
+    if (segment == NULL || _START (element) > run_end) {
+      if (n_segments < comp->segments->len) {
+        segment = g_ptr_array_index (comp->segments, n_segments);
+      } else if ((segment = layer_segment_new (comp))) {
+        g_ptr_array_add (comp->segments, segment);
+      } else {
+        break;
       }
+      n_segments++;
+      run_end = 0;
+    }
+
+    move_gnlobject_to_bin (comp->track, element, segment);
+    run_end = MAX (run_end, _START (element) + _DURATION (element));
+  }
+  g_list_free (elements);
+
+  /* The segments that are left are empty now */
+  while (comp->segments->len > n_segments) {
+    layer_segment_free (comp, g_ptr_array_index (comp->segments,
+            comp->segments->len - 1));
+    g_ptr_array_remove_index (comp->segments, comp->segments->len - 1);
+  }
+}
+
+/* Puts the gnlobjects of the elements that changed in the composition of
+ * their layer, and moves the compositions of the layers that got a new base.
+ * Only the compositions that changed are looked at */
+static void
+update_layer_compositions (GESTrack * track)
+{
+  guint i;
+  GHashTableIter iter;
+  LayerComposition *comp;
+  GESTrackElement *element;
+  GESTrackPrivate *priv = track->priv;
+
+  g_hash_table_iter_init (&iter, priv->dirty_elements);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & element, NULL)) {
+    comp = track_element_get_composition (track, element);
+    move_element_to_composition (track, element, comp);
+    if (comp)
+      set_layer_composition_dirty (track, comp);
+  }
+
+  g_hash_table_iter_init (&iter, priv->dirty_comps);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & comp, NULL)) {
+    if (comp->dirty)
+      restack_layer_composition (comp);
+
+    if (comp->rebased) {
+      for (i = 0; i < comp->segments->len; i++)
+        g_object_set (g_ptr_array_index (comp->segments, i), "priority",
+            comp->layer->min_gnl_priority, NULL);
+      comp->rebased = FALSE;
+    }
+  }
+}
+
+/* Only the layer compositions that changed are committed, the composition
+ * of the track only contains a few objects per layer so it always is */
+static gboolean
+commit_layer_compositions (GESTrack * track)
+{
+  guint i;
+  gboolean ret = TRUE, comp_ret;
+  GHashTableIter iter;
+  LayerComposition *comp;
+
+  g_hash_table_iter_init (&iter, track->priv->dirty_comps);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & comp, NULL)) {
+    if (!comp->dirty)
+      continue;
+
+    for (i = 0; i < comp->segments->len; i++) {
+      g_signal_emit_by_name (g_ptr_array_index (comp->segments, i), "commit",
+          FALSE, &comp_ret);
+      ret &= comp_ret;
+    }
+    comp->dirty = FALSE;
+  }
+  g_hash_table_remove_all (track->priv->dirty_comps);
+
+  g_signal_emit_by_name (track->priv->composition, "commit", FALSE,
+      &comp_ret);
+
+  return ret && comp_ret;
+}
+
+/* Puts the elements that changed during the edit transactions back in
+ * place, all of them are taken out of the sequence first so that the
+ * others stay sorted while they are inserted back */
+static void
+sort_moved_elements (GESTrack * track)
+{
+  GHashTableIter iter;
+  GESTrackElement *element;
+  GESTrackPrivate *priv = track->priv;
+
+  if (g_hash_table_size (priv->moved_elements) == 0)
+    return;
+
+  g_hash_table_iter_init (&iter, priv->moved_elements);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & element, NULL))
+    g_sequence_remove (g_hash_table_lookup (priv->trackelements_iter,
+            element));
+
+  g_hash_table_iter_init (&iter, priv->moved_elements);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & element, NULL))
+    g_hash_table_insert (priv->trackelements_iter, element,
+        g_sequence_insert_sorted (priv->trackelements_by_start, element,
+            (GCompareDataFunc) element_start_compare, NULL));
+
+  g_hash_table_remove_all (priv->moved_elements);
+}
+
+static gboolean
+track_needs_commit (GESTrack * track)
+{
+  GstClockTime timeline_duration;
+  GESTrackPrivate *priv = track->priv;
+
+  if (priv->needs_commit || g_hash_table_size (priv->dirty_elements))
+    return TRUE;
+
+  /* The gap at the end follows the duration of the timeline when it goes
+   * further than the elements */
+  if (priv->timeline && priv->create_element_for_gaps) {
+    g_object_get (priv->timeline, "duration", &timeline_duration, NULL);
+
+    return MAX (timeline_duration, priv->gaps_elements_end) !=
+        MAX (priv->gaps_timeline_duration, priv->gaps_elements_end);
+  }
+
+  return FALSE;
+}
+
+typedef struct
+{
+  GstClockTime position;
+  gboolean all;
+  GHashTable *instantiated;
+} InstantiationUpdate;
+
+static void
+free_pooled_source (GstElement * element)
+{
+  gst_element_set_locked_state (element, FALSE);
+  gst_element_set_state (element, GST_STATE_NULL);
+  gst_object_unref (element);
+}
+
+static void
+free_source_pool (GQueue * pool)
+{
+  g_queue_free_full (pool, (GDestroyNotify) free_pooled_source);
+}
+
+static void
+free_instantiation_probe (InstantiationProbe * probe)
+{
+  g_slice_free (InstantiationProbe, probe);
+}
+
+static gboolean
+add_lazy_element (GESTrackElement * element, guint64 start, guint64 end,
+    InstantiationUpdate * update)
+{
+  /* The sources ending at the position are not needed anymore */
+  if (update->all || end > update->position)
+    g_hash_table_insert (update->instantiated, element, element);
+
+  return TRUE;
+}
+
+/* Instantiates the lazy sources overlapping [@position,
+ * @position + instantiation_window] and releases the other ones that were
+ * instantiated. The sources around the position are found in the interval
+ * tree of the lazy sources, so this only depends on the number of sources
+ * in the window and on the number of the ones that were instantiated.
+ *
+ * This can be called from the thread of a seek, the instantiation lock is
+ * held meanwhile. The current position is kept if @position is
+ * GST_CLOCK_TIME_NONE */
+static void
+update_instantiation (GESTrack * track, GstClockTime position)
+{
+  GHashTable *previous;
+  GHashTableIter iter;
+  GESTrackElement *element;
+  InstantiationUpdate update = { 0, FALSE, NULL };
+  GESTrackPrivate *priv = track->priv;
+
+  g_rec_mutex_lock (&priv->instantiation_lock);
+  if (GST_CLOCK_TIME_IS_VALID (position))
+    priv->instantiation_position = position;
+  update.position = position = priv->instantiation_position;
+  previous = priv->instantiated;
+  update.instantiated = priv->instantiated =
+      g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  if (GST_CLOCK_TIME_IS_VALID (priv->instantiation_window)) {
+    GST_DEBUG_OBJECT (track, "Instantiating sources from %" GST_TIME_FORMAT
+        " to %" GST_TIME_FORMAT, GST_TIME_ARGS (position),
+        GST_TIME_ARGS (position + priv->instantiation_window));
+
+    ges_interval_tree_foreach_overlapping (priv->lazy_elements, position,
+        position + priv->instantiation_window,
+        (GESIntervalTreeFunc) add_lazy_element, &update);
+  } else {
+    GST_DEBUG_OBJECT (track, "Instantiating all the sources");
+
+    update.all = TRUE;
+    ges_interval_tree_foreach (priv->lazy_elements,
+        (GESIntervalTreeFunc) add_lazy_element, &update);
+  }
+
+  /* Releasing first lets the sources that get instantiated reuse what the
+   * released ones gave to the source pool */
+  g_hash_table_iter_init (&iter, previous);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & element, NULL)) {
+    if (g_hash_table_contains (priv->instantiated, element))
+      continue;
+
+    /* Elements with keyframes are kept */
+    if (!_ges_track_element_release (element) &&
+        _ges_track_element_is_instantiated (element))
+      g_hash_table_insert (priv->instantiated, element, element);
+  }
+  g_hash_table_unref (previous);
+
+  g_hash_table_iter_init (&iter, priv->instantiated);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & element, NULL)) {
+    if (!_ges_track_element_instantiate (element))
+      g_hash_table_iter_remove (&iter);
+  }
+  g_rec_mutex_unlock (&priv->instantiation_lock);
+}
+
+/* Called when the children properties of a lazy @element are accessed, it
+ * is then released on next update if it is out of the window */
+void
+ges_track_instantiate_element (GESTrack * track, GESTrackElement * element)
+{
+  GESTrackPrivate *priv = track->priv;
+
+  g_rec_mutex_lock (&priv->instantiation_lock);
+  if (_ges_track_element_instantiate (element) &&
+      g_hash_table_lookup (priv->lazy_nodes, element))
+    g_hash_table_insert (priv->instantiated, element, element);
+  g_rec_mutex_unlock (&priv->instantiation_lock);
+}
+
+/* Keeps the prerolled @element of a released source, see
+ * _ges_source_recycle, so that the next source using the same @pool_key
+ * is instantiated from it instead of creating a new one. Called with the
+ * instantiation lock */
+void
+ges_track_pool_source (GESTrack * track, const gchar * pool_key,
+    GstElement * element)
+{
+  GQueue *pool = g_hash_table_lookup (track->priv->source_pool, pool_key);
+
+  if (pool == NULL) {
+    pool = g_queue_new ();
+    g_hash_table_insert (track->priv->source_pool, g_strdup (pool_key), pool);
+  }
+
+  if (g_queue_get_length (pool) >= MAX_POOLED_SOURCES) {
+    free_pooled_source (element);
+
+    return;
+  }
+
+  GST_DEBUG_OBJECT (track, "Pooling %" GST_PTR_FORMAT " for %s", element,
+      pool_key);
+  g_queue_push_head (pool, element);
+}
+
+/* Returns: (transfer floating): An element previously given to
+ * ges_track_pool_source for @pool_key, or %NULL. Called with the
+ * instantiation lock */
+GstElement *
+ges_track_take_pooled_source (GESTrack * track, const gchar * pool_key)
+{
+  GstElement *element;
+  GQueue *pool = g_hash_table_lookup (track->priv->source_pool, pool_key);
+
+  if (pool == NULL || (element = g_queue_pop_head (pool)) == NULL)
+    return NULL;
+
+  GST_DEBUG_OBJECT (track, "Reusing %" GST_PTR_FORMAT " for %s", element,
+      pool_key);
+
+  /* Handed over the same way a newly created element is */
+  g_object_force_floating (G_OBJECT (element));
+
+  return element;
+}
+
+static gboolean
+update_instantiation_idle_cb (GESTrack * track)
+{
+  GstClockTime position;
+
+  GST_OBJECT_LOCK (track);
+  position = track->priv->playback_position;
+  GST_OBJECT_UNLOCK (track);
+  g_atomic_int_set (&track->priv->instantiation_pending, FALSE);
+
+  update_instantiation (track, position);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Only installed while the instantiation window is valid, see
+ * set_instantiation_probe. The sources are instantiated from the main
+ * context once the playback moved by half a window. Seeks are only let
+ * through once the sources around their position are instantiated, which is
+ * done right away from the thread of the seek, as the content needs to be
+ * there before the composition seeks */
+static GstPadProbeReturn
+instantiation_probe_cb (GstPad * pad, GstPadProbeInfo * info,
+    InstantiationProbe * probe)
+{
+  GstEvent *event;
+  GstClockTime position, last;
+  GESTrack *track = probe->track;
+  GESTrackPrivate *priv = track->priv;
 
-      priv->duration = timeline_duration;
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+    if (!GST_BUFFER_PTS_IS_VALID (buffer))
+      return GST_PAD_PROBE_OK;
+
+    /* The segment and the last position are only used from the streaming
+     * thread, the buffers do not need any lock */
+    position = gst_segment_to_stream_time (&priv->segment, GST_FORMAT_TIME,
+        GST_BUFFER_PTS (buffer));
+    last = priv->probed_position;
+    if (!GST_CLOCK_TIME_IS_VALID (position) || (GST_CLOCK_TIME_IS_VALID (last)
+            && position >= last && position - last < probe->window / 2))
+      return GST_PAD_PROBE_OK;
+
+    if (g_atomic_int_compare_and_exchange (&priv->instantiation_pending,
+            FALSE, TRUE)) {
+      priv->probed_position = position;
+      GST_OBJECT_LOCK (track);
+      priv->playback_position = position;
+      GST_OBJECT_UNLOCK (track);
+      g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+          (GSourceFunc) update_instantiation_idle_cb, gst_object_ref (track),
+          gst_object_unref);
     }
+
+    return GST_PAD_PROBE_OK;
+  }
+
+  event = GST_PAD_PROBE_INFO_EVENT (info);
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT) {
+    gst_event_copy_segment (event, &priv->segment);
+  } else if (GST_EVENT_TYPE (event) == GST_EVENT_SEEK) {
+    GstFormat format;
+    GstSeekType start_type;
+    gint64 start;
+
+    gst_event_parse_seek (event, NULL, &format, NULL, &start_type, &start,
+        NULL, NULL);
+    if (format == GST_FORMAT_TIME && start_type == GST_SEEK_TYPE_SET)
+      update_instantiation (track, start);
   }
 
-  /* 4- Remove old gaps */
-  g_list_free_full (gaps, (GDestroyNotify) free_gap);
+  return GST_PAD_PROBE_OK;
+}
+
+/* Installs the probe instantiating the sources around the playback position
+ * on the source pad of the composition if the instantiation window is
+ * valid, and removes it otherwise */
+static void
+set_instantiation_probe (GESTrack * track)
+{
+  InstantiationProbe *probe;
+  GESTrackPrivate *priv = track->priv;
+
+  if (priv->instantiation_probe) {
+    gst_pad_remove_probe (priv->instantiation_pad, priv->instantiation_probe);
+    priv->instantiation_probe = 0;
+  }
+
+  if (priv->instantiation_pad == NULL ||
+      !GST_CLOCK_TIME_IS_VALID (priv->instantiation_window))
+    return;
+
+  probe = g_slice_new (InstantiationProbe);
+  probe->track = track;
+  probe->window = priv->instantiation_window;
+  priv->instantiation_probe = gst_pad_add_probe (priv->instantiation_pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM |
+      GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+      (GstPadProbeCallback) instantiation_probe_cb, probe,
+      (GDestroyNotify) free_instantiation_probe);
+}
+
+/* The duration of a frame in the restriction caps, or GST_CLOCK_TIME_NONE */
+static GstClockTime
+get_frame_duration (GESTrack * track)
+{
+  gint fps_n, fps_d;
+  GstStructure *structure;
+  GstCaps *restriction = track->priv->restriction_caps;
+
+  if (restriction == NULL || gst_caps_get_size (restriction) == 0)
+    return GST_CLOCK_TIME_NONE;
+
+  structure = gst_caps_get_structure (restriction, 0);
+  if (!gst_structure_get_fraction (structure, "framerate", &fps_n, &fps_d) ||
+      fps_n <= 0 || fps_d <= 0)
+    return GST_CLOCK_TIME_NONE;
+
+  return gst_util_uint64_scale_int (GST_SECOND, fps_d, fps_n);
+}
+
+/* Only the bindings that changed since the last commit are sampled again,
+ * and elements without any binding are forgotten until they get one */
+static void
+update_baked_controls (GESTrack * track)
+{
+  GHashTableIter iter;
+  GESTrackElement *element;
+  GstClockTime interval = get_frame_duration (track);
+
+  g_hash_table_iter_init (&iter, track->priv->controlled_elements);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & element, NULL)) {
+    if (!_ges_track_element_bake_controls (element, interval))
+      g_hash_table_iter_remove (&iter);
+  }
 }
 
 static inline void
 resort_and_fill_gaps (GESTrack * track)
 {
-  g_sequence_sort (track->priv->trackelements_by_start,
-      (GCompareDataFunc) element_start_compare, NULL);
+  sort_moved_elements (track);
 
   if (track->priv->updating == TRUE) {
     update_gaps (track);
+
+    if (track->priv->region_mixing && track->priv->mixing &&
+        track->priv->mixing_operation)
+      update_mixing_regions (track);
   }
 }
 
@@ -249,8 +1304,33 @@ static void
 sort_track_elements_cb (GESTrackElement * child,
     GParamSpec * arg G_GNUC_UNUSED, GESTrack * track)
 {
-  g_sequence_sort (track->priv->trackelements_by_start,
-      (GCompareDataFunc) element_start_compare, NULL);
+  GESTrackPrivate *priv = track->priv;
+  GESIntervalNode *node = g_hash_table_lookup (priv->lazy_nodes, child);
+
+  if (node) {
+    g_rec_mutex_lock (&priv->instantiation_lock);
+    ges_interval_tree_update (priv->lazy_elements, node, _START (child),
+        _END (child));
+    g_rec_mutex_unlock (&priv->instantiation_lock);
+  }
+
+  if (priv->edit_depth) {
+    g_hash_table_insert (priv->moved_elements, child, child);
+
+    return;
+  }
+
+  /* Only @child changed, so the rest of the sequence is sorted and it can
+   * be moved to its new place in O(log n) */
+  g_sequence_sort_changed (g_hash_table_lookup (priv->trackelements_iter,
+          child), (GCompareDataFunc) element_start_compare, NULL);
+}
+
+static void
+element_changed_cb (GESTrackElement * child, GParamSpec * arg G_GNUC_UNUSED,
+    GESTrack * track)
+{
+  g_hash_table_insert (track->priv->dirty_elements, child, child);
 }
 
 static void
@@ -267,6 +1347,9 @@ pad_added_cb (GstElement * element, GstPad * pad, GESTrack * track)
   gst_pad_link (pad, capsfilter_sink);
   gst_object_unref (capsfilter_sink);
 
+  priv->instantiation_pad = pad;
+  set_instantiation_probe (track);
+
   capsfilter_src = gst_element_get_static_pad (priv->capsfilter, "src");
   /* ghost the pad */
   priv->srcpad = gst_ghost_pad_new ("src", capsfilter_src);
@@ -284,6 +1367,12 @@ pad_removed_cb (GstElement * element, GstPad * pad, GESTrack * track)
 
   GST_DEBUG ("track:%p, pad %s:%s", track, GST_DEBUG_PAD_NAME (pad));
 
+  /* The probe goes away with @pad */
+  if (pad == priv->instantiation_pad) {
+    priv->instantiation_pad = NULL;
+    priv->instantiation_probe = 0;
+  }
+
   if (G_LIKELY (priv->srcpad)) {
     gst_pad_set_active (priv->srcpad, FALSE);
     gst_element_remove_pad (GST_ELEMENT (track), priv->srcpad);
@@ -336,18 +1425,41 @@ remove_object_internal (GESTrack * track, GESTrackElement * object)
   }
 
   if ((gnlobject = ges_track_element_get_gnlobject (object))) {
+    LayerComposition *comp = g_hash_table_lookup (priv->element_comps,
+        object);
+    GstElement *composition = GST_ELEMENT (GST_OBJECT_PARENT (gnlobject));
+
     GST_DEBUG ("Removing GnlObject '%s' from composition '%s'",
-        GST_ELEMENT_NAME (gnlobject), GST_ELEMENT_NAME (priv->composition));
+        GST_ELEMENT_NAME (gnlobject), GST_ELEMENT_NAME (composition));
 
-    if (!gst_bin_remove (GST_BIN (priv->composition), gnlobject)) {
+    if (!gst_bin_remove (GST_BIN (composition), gnlobject)) {
       GST_WARNING ("Failed to remove gnlobject from composition");
       return FALSE;
     }
 
+    if (comp) {
+      g_hash_table_remove (comp->elements, object);
+      set_layer_composition_dirty (track, comp);
+      g_hash_table_remove (priv->element_comps, object);
+    }
+
     gst_element_set_state (gnlobject, GST_STATE_NULL);
   }
 
-  g_signal_handlers_disconnect_by_func (object, sort_track_elements_cb, NULL);
+  g_signal_handlers_disconnect_by_func (object, sort_track_elements_cb, track);
+  g_signal_handlers_disconnect_by_func (object, element_changed_cb, track);
+
+  if (g_hash_table_lookup (priv->lazy_nodes, object)) {
+    g_rec_mutex_lock (&priv->instantiation_lock);
+    ges_interval_tree_remove (priv->lazy_elements,
+        g_hash_table_lookup (priv->lazy_nodes, object));
+    g_hash_table_remove (priv->lazy_nodes, object);
+    g_hash_table_remove (priv->instantiated, object);
+    g_rec_mutex_unlock (&priv->instantiation_lock);
+  }
+
+  if (g_hash_table_remove (priv->controlled_elements, object))
+    _ges_track_element_bake_controls (object, GST_CLOCK_TIME_NONE);
 
   ges_track_element_set_track (object, NULL);
   ges_timeline_element_set_timeline (GES_TIMELINE_ELEMENT (object), NULL);
@@ -423,7 +1535,16 @@ ges_track_dispose (GObject * object)
   g_sequence_foreach (track->priv->trackelements_by_start,
       (GFunc) dispose_trackelements_foreach, track);
   g_sequence_free (priv->trackelements_by_start);
+  g_hash_table_unref (priv->moved_elements);
+  g_hash_table_unref (priv->dirty_elements);
+  g_hash_table_unref (priv->controlled_elements);
+  g_hash_table_unref (priv->element_comps);
+  g_hash_table_unref (priv->dirty_comps);
+  g_hash_table_unref (priv->layer_comps);
   g_list_free_full (priv->gaps, (GDestroyNotify) free_gap);
+  g_list_free_full (priv->gaps_pool, (GDestroyNotify) destroy_gap);
+  clear_mixing_regions (track);
+  g_hash_table_remove_all (priv->source_pool);
 
   if (priv->mixing_operation)
     gst_object_unref (priv->mixing_operation);
@@ -438,12 +1559,26 @@ ges_track_dispose (GObject * object)
     priv->caps = NULL;
   }
 
+  if (priv->commit_stats) {
+    gst_structure_free (priv->commit_stats);
+    priv->commit_stats = NULL;
+  }
+
   G_OBJECT_CLASS (ges_track_parent_class)->dispose (object);
 }
 
 static void
 ges_track_finalize (GObject * object)
 {
+  GESTrackPrivate *priv = GES_TRACK (object)->priv;
+
+  /* The elements were removed on dispose */
+  ges_interval_tree_free (priv->lazy_elements);
+  g_hash_table_unref (priv->lazy_nodes);
+  g_hash_table_unref (priv->instantiated);
+  g_hash_table_unref (priv->source_pool);
+  g_rec_mutex_clear (&priv->instantiation_lock);
+
   G_OBJECT_CLASS (ges_track_parent_class)->finalize (object);
 }
 
@@ -586,6 +1721,27 @@ ges_track_class_init (GESTrackClass * klass)
       G_SIGNAL_RUN_FIRST, 0, NULL, NULL, g_cclosure_marshal_generic,
       G_TYPE_NONE, 1, GES_TYPE_TRACK_ELEMENT);
 
+  /**
+   * GESTrack::commit-stats:
+   * @object: the #GESTrack
+   * @stats: a #GstStructure describing the commit
+   *
+   * Will be emitted each time the track is committed, with statistics about
+   * what the commit did:
+   *
+   *  - "skipped" (#G_TYPE_BOOLEAN): whether nothing changed since the last
+   *    commit, in which case the composition was not committed at all
+   *  - "elements-touched" (#G_TYPE_UINT): the number of track elements that
+   *    changed since the last commit
+   *  - "gaps-changed" (#G_TYPE_UINT): the number of gaps that were added,
+   *    removed or moved since the last commit
+   *  - "time" (#G_TYPE_UINT64): the time spent committing, in nanoseconds
+   */
+  ges_track_signals[COMMIT_STATS] =
+      g_signal_new ("commit-stats", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_marshal_generic,
+      G_TYPE_NONE, 1, GST_TYPE_STRUCTURE | G_SIGNAL_TYPE_STATIC_SCOPE);
+
   klass->get_mixing_element = NULL;
 }
 
@@ -601,10 +1757,28 @@ ges_track_init (GESTrack * self)
   self->priv->trackelements_by_start = g_sequence_new (NULL);
   self->priv->trackelements_iter =
       g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->moved_elements = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->dirty_elements = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->controlled_elements =
+      g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->element_comps = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->layer_comps = g_hash_table_new_full (g_direct_hash,
+      g_direct_equal, NULL, (GDestroyNotify) free_layer_composition);
+  self->priv->dirty_comps = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->needs_commit = TRUE;
   self->priv->create_element_for_gaps = NULL;
   self->priv->gaps = NULL;
   self->priv->mixing = TRUE;
   self->priv->restriction_caps = NULL;
+  g_rec_mutex_init (&self->priv->instantiation_lock);
+  self->priv->instantiation_window = GST_CLOCK_TIME_NONE;
+  self->priv->lazy_elements = ges_interval_tree_new (NULL);
+  self->priv->lazy_nodes = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->instantiated = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->source_pool = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, (GDestroyNotify) free_source_pool);
+  self->priv->probed_position = GST_CLOCK_TIME_NONE;
+  gst_segment_init (&self->priv->segment, GST_FORMAT_TIME);
 
   g_signal_connect (G_OBJECT (self->priv->composition), "notify::duration",
       G_CALLBACK (composition_duration_cb), self);
@@ -678,6 +1852,7 @@ ges_track_set_timeline (GESTrack * track, GESTimeline * timeline)
   GST_DEBUG ("track:%p, timeline:%p", track, timeline);
 
   track->priv->timeline = timeline;
+  track->priv->needs_commit = TRUE;
   resort_and_fill_gaps (track);
 }
 
@@ -691,6 +1866,9 @@ ges_track_set_timeline (GESTrack * track, GESTimeline * timeline)
 void
 ges_track_set_caps (GESTrack * track, const GstCaps * caps)
 {
+  guint i;
+  GHashTableIter iter;
+  LayerComposition *comp;
   GESTrackPrivate *priv;
 
   g_return_if_fail (GES_IS_TRACK (track));
@@ -705,6 +1883,12 @@ ges_track_set_caps (GESTrack * track, const GstCaps * caps)
   priv->caps = gst_caps_copy (caps);
 
   g_object_set (priv->composition, "caps", caps, NULL);
+  g_hash_table_iter_init (&iter, priv->layer_comps);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & comp)) {
+    for (i = 0; i < comp->segments->len; i++)
+      g_object_set (g_ptr_array_index (comp->segments, i), "caps", caps,
+          NULL);
+  }
   /* FIXME : update all trackelements ? */
 }
 
@@ -758,6 +1942,16 @@ ges_track_set_mixing (GESTrack * track, gboolean mixing)
     GST_DEBUG_OBJECT (track, "Mixing is already set to the same value");
   }
 
+  /* The mixing regions are placed on next commit */
+  if (track->priv->region_mixing) {
+    if (!mixing)
+      clear_mixing_regions (track);
+    track->priv->mixing = mixing;
+    track->priv->needs_commit = TRUE;
+
+    return;
+  }
+
   if (mixing) {
     // increase ref count to hold the object
     gst_object_ref (track->priv->mixing_operation);
@@ -815,17 +2009,31 @@ ges_track_add_element (GESTrack * track, GESTrackElement * object)
       GST_OBJECT_NAME (ges_track_element_get_gnlobject (object)),
       GST_OBJECT_NAME (track->priv->composition));
 
+  /* It goes to the composition of its layer when that one is restacked */
   if (G_UNLIKELY (!gst_bin_add (GST_BIN (track->priv->composition),
               ges_track_element_get_gnlobject (object)))) {
     GST_WARNING ("Couldn't add object to the GnlComposition");
     return FALSE;
   }
 
+  move_element_to_composition (track, object,
+      track_element_get_composition (track, object));
+
   gst_object_ref_sink (object);
+  sort_moved_elements (track);
   g_hash_table_insert (track->priv->trackelements_iter, object,
       g_sequence_insert_sorted (track->priv->trackelements_by_start, object,
           (GCompareDataFunc) element_start_compare, NULL));
 
+  /* Its content is created on next update if it is in the window */
+  if (_ges_track_element_is_lazy (object)) {
+    g_rec_mutex_lock (&track->priv->instantiation_lock);
+    g_hash_table_insert (track->priv->lazy_nodes, object,
+        ges_interval_tree_insert (track->priv->lazy_elements, object,
+            _START (object), _END (object)));
+    g_rec_mutex_unlock (&track->priv->instantiation_lock);
+  }
+
   ges_timeline_element_set_timeline (GES_TIMELINE_ELEMENT (object),
       track->priv->timeline);
   g_signal_emit (track, ges_track_signals[TRACK_ELEMENT_ADDED], 0,
@@ -840,6 +2048,11 @@ ges_track_add_element (GESTrack * track, GESTrackElement * object)
   g_signal_connect (GES_TRACK_ELEMENT (object), "notify::priority",
       G_CALLBACK (sort_track_elements_cb), track);
 
+  g_signal_connect (GES_TRACK_ELEMENT (object), "notify",
+      G_CALLBACK (element_changed_cb), track);
+  g_hash_table_insert (track->priv->dirty_elements, object, object);
+  ges_track_invalidate_baked_controls (track, object);
+
   return TRUE;
 }
 
@@ -892,8 +2105,13 @@ ges_track_remove_element (GESTrack * track, GESTrackElement * object)
 
   GST_DEBUG_OBJECT (track, "Removing %" GST_PTR_FORMAT, object);
 
+  /* Make sure @object is in place before looking for it */
+  sort_moved_elements (track);
   it = g_hash_table_lookup (priv->trackelements_iter, object);
   g_sequence_remove (it);
+  g_hash_table_remove (priv->trackelements_iter, object);
+  g_hash_table_remove (priv->dirty_elements, object);
+  priv->needs_commit = TRUE;
   resort_and_fill_gaps (track);
 
   if (remove_object_internal (track, object) == TRUE) {
@@ -941,6 +2159,398 @@ ges_track_get_timeline (GESTrack * track)
   return track->priv->timeline;
 }
 
+/**
+ * ges_track_set_background:
+ * @track: a #GESTrack
+ * @background: %TRUE to fill @track with a single background source
+ *
+ * Sets whether @track should fill the periods of time where it contains no
+ * source with a single background source, instead of using one source for
+ * each of them. The background covers the whole track with the lowest
+ * priority so that it shows through wherever no element is present, and it
+ * only needs its duration to be updated when the track grows, which is a
+ * lot cheaper than keeping track of the gaps in sparse timelines.
+ *
+ * The change is taken into account on next #ges_track_commit.
+ */
+void
+ges_track_set_background (GESTrack * track, gboolean background)
+{
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  track->priv->background = background;
+  track->priv->needs_commit = TRUE;
+}
+
+/**
+ * ges_track_get_background:
+ * @track: a #GESTrack
+ *
+ * Gets whether @track uses a single background source to fill its gaps, see
+ * #ges_track_set_background.
+ *
+ * Returns: %TRUE if @track uses a background source, %FALSE otherwise
+ */
+gboolean
+ges_track_get_background (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
+
+  return track->priv->background;
+}
+
+/**
+ * ges_track_set_region_mixing:
+ * @track: a #GESTrack
+ * @region_mixing: %TRUE to only mix where sources overlap
+ *
+ * Sets whether a mixing #GESTrack should only mix the regions where two or
+ * more of its sources overlap. By default, a single mixing operation spans
+ * the whole track so that every buffer goes through the mixer, even where
+ * only one source is present. With region mixing, the track places one
+ * mixing operation over each region where sources overlap on each commit,
+ * and lets the sources through directly everywhere else.
+ */
+void
+ges_track_set_region_mixing (GESTrack * track, gboolean region_mixing)
+{
+  GESTrackPrivate *priv;
+
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  priv = track->priv;
+  if (priv->region_mixing == region_mixing)
+    return;
+
+  if (priv->mixing && priv->mixing_operation) {
+    if (region_mixing) {
+      if (!gst_bin_remove (GST_BIN (priv->composition),
+              priv->mixing_operation)) {
+        GST_WARNING_OBJECT (track,
+            "Could not remove the mixer from our composition");
+        return;
+      }
+    } else {
+      clear_mixing_regions (track);
+
+      gst_object_ref (priv->mixing_operation);
+      if (!gst_bin_add (GST_BIN (priv->composition),
+              priv->mixing_operation)) {
+        GST_WARNING_OBJECT (track,
+            "Could not add the mixer to our composition");
+        return;
+      }
+    }
+  }
+
+  priv->region_mixing = region_mixing;
+  priv->needs_commit = TRUE;
+}
+
+/**
+ * ges_track_get_region_mixing:
+ * @track: a #GESTrack
+ *
+ * Gets whether @track only mixes the regions where its sources overlap, see
+ * #ges_track_set_region_mixing.
+ *
+ * Returns: %TRUE if @track only mixes where sources overlap, %FALSE
+ * otherwise
+ */
+gboolean
+ges_track_get_region_mixing (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
+
+  return track->priv->region_mixing;
+}
+
+/**
+ * ges_track_set_layer_compositions:
+ * @track: a #GESTrack
+ * @layer_compositions: %TRUE to use one nested composition per layer
+ *
+ * Sets whether the elements of @track are put in one nested #GnlComposition
+ * per #GESLayer, instead of all being in the composition of @track. When a
+ * commit only concerns elements of some layers, only the compositions of
+ * those layers are restacked, and a whole layer can be activated or
+ * deactivated at once with #ges_track_set_layer_active.
+ *
+ * Each layer composition only spans runs of elements without holes, so
+ * that the layers below show through the holes of a layer.
+ *
+ * The change is taken into account on next #ges_track_commit. Going back to
+ * a single composition forgets which layers were deactivated, they all are
+ * active again.
+ */
+void
+ges_track_set_layer_compositions (GESTrack * track,
+    gboolean layer_compositions)
+{
+  GSequenceIter *it;
+  GESTrackElement *element;
+  GESTrackPrivate *priv;
+
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  priv = track->priv;
+  if (priv->layer_compositions == layer_compositions)
+    return;
+
+  priv->layer_compositions = layer_compositions;
+  for (it = g_sequence_get_begin_iter (priv->trackelements_by_start);
+      g_sequence_iter_is_end (it) == FALSE; it = g_sequence_iter_next (it)) {
+    element = g_sequence_get (it);
+    move_element_to_composition (track, element,
+        track_element_get_composition (track, element));
+  }
+
+  if (!layer_compositions) {
+    g_hash_table_remove_all (priv->dirty_comps);
+    g_hash_table_remove_all (priv->layer_comps);
+
+    /* The track elements of the layers that got a new base while nested
+     * are back in the same composition */
+    if (priv->timeline) {
+      GList *tmp;
+
+      for (tmp = priv->timeline->layers; tmp; tmp = tmp->next)
+        _ges_layer_sync_clips_base (tmp->data);
+    }
+  }
+
+  priv->needs_commit = TRUE;
+}
+
+/**
+ * ges_track_get_layer_compositions:
+ * @track: a #GESTrack
+ *
+ * Gets whether @track uses one nested composition per layer, see
+ * #ges_track_set_layer_compositions.
+ *
+ * Returns: %TRUE if @track uses one composition per layer, %FALSE
+ * otherwise
+ */
+gboolean
+ges_track_get_layer_compositions (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
+
+  return track->priv->layer_compositions;
+}
+
+/**
+ * ges_track_set_layer_active:
+ * @track: a #GESTrack
+ * @layer: a #GESLayer
+ * @active: %FALSE to mute @layer in @track
+ *
+ * Activates or deactivates all the elements of @layer in @track at once, by
+ * toggling the composition of @layer. Muting a layer is deactivating it, and
+ * soloing a layer is deactivating all the other ones. This does not change
+ * the #GESTrackElement:active property of the elements.
+ *
+ * This is only possible when @track uses one composition per layer, see
+ * #ges_track_set_layer_compositions. The change is taken into account on
+ * next #ges_track_commit.
+ *
+ * Returns: %TRUE if @layer could be (de)activated, %FALSE otherwise
+ */
+gboolean
+ges_track_set_layer_active (GESTrack * track, GESLayer * layer,
+    gboolean active)
+{
+  guint i;
+  LayerComposition *comp;
+
+  g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
+  g_return_val_if_fail (GES_IS_LAYER (layer), FALSE);
+
+  if (!track->priv->layer_compositions) {
+    GST_WARNING_OBJECT (track, "Layers can only be (de)activated when using "
+        "one composition per layer");
+
+    return FALSE;
+  }
+
+  comp = get_layer_composition (track, layer);
+
+  /* Only the composition of @track needs to be restacked */
+  comp->active = active;
+  for (i = 0; i < comp->segments->len; i++)
+    g_object_set (g_ptr_array_index (comp->segments, i), "active", active,
+        NULL);
+  track->priv->needs_commit = TRUE;
+
+  return TRUE;
+}
+
+/**
+ * ges_track_get_layer_active:
+ * @track: a #GESTrack
+ * @layer: a #GESLayer
+ *
+ * Gets whether the elements of @layer are active in @track, see
+ * #ges_track_set_layer_active.
+ *
+ * Returns: %FALSE if @layer has been deactivated in @track, %TRUE otherwise
+ */
+gboolean
+ges_track_get_layer_active (GESTrack * track, GESLayer * layer)
+{
+  LayerComposition *comp;
+
+  g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
+  g_return_val_if_fail (GES_IS_LAYER (layer), FALSE);
+
+  comp = g_hash_table_lookup (track->priv->layer_comps, layer);
+
+  return comp ? comp->active : TRUE;
+}
+
+/**
+ * ges_track_set_instantiation_window:
+ * @track: a #GESTrack
+ * @window: The duration after the playback position where the content of
+ * the sources is needed, or #GST_CLOCK_TIME_NONE
+ *
+ * Sets how far ahead of the playback position the sources of @track are
+ * instantiated. Sources that are not between the playback position and
+ * @window after it have their content destroyed, and created again when
+ * the playback gets close to them, which keeps the number of elements
+ * alive low in long timelines.
+ *
+ * The values of the children properties of the sources are kept while they
+ * are not instantiated, and accessing them instantiates the source again.
+ * Sources with keyframes are never released.
+ *
+ * Only the sources added to @track after setting a valid @window are
+ * instantiated lazily. Setting #GST_CLOCK_TIME_NONE instantiates all of
+ * them back. The default is #GST_CLOCK_TIME_NONE.
+ */
+void
+ges_track_set_instantiation_window (GESTrack * track, GstClockTime window)
+{
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  /* Also read from the thread of the seeks */
+  g_rec_mutex_lock (&track->priv->instantiation_lock);
+  track->priv->instantiation_window = window;
+  g_rec_mutex_unlock (&track->priv->instantiation_lock);
+
+  set_instantiation_probe (track);
+
+  /* When disabled, there is no window to update on commit anymore */
+  if (!GST_CLOCK_TIME_IS_VALID (window))
+    update_instantiation (track, GST_CLOCK_TIME_NONE);
+
+  track->priv->needs_commit = TRUE;
+}
+
+/**
+ * ges_track_set_baked_controls:
+ * @track: a #GESTrack
+ * @baked: Whether to bake the control bindings
+ *
+ * Sets whether the #GstControlBinding-s of the elements of @track are
+ * baked. When they are, each #GstTimedValueControlSource is sampled once
+ * per frame of the framerate of the restriction caps of @track when
+ * committing, and the property is then driven from that table instead of
+ * interpolating between the keyframes each time a value is needed.
+ *
+ * A binding is sampled again on commit after its keyframes were changed
+ * with #ges_track_element_set_keyframes, or after the in-point or the
+ * duration of its element changed. Keyframes changed directly in the
+ * control source are only taken into account if their number changed.
+ * Tracks without a framerate in their restriction caps never bake their
+ * bindings.
+ *
+ * The default is %FALSE.
+ */
+void
+ges_track_set_baked_controls (GESTrack * track, gboolean baked)
+{
+  GHashTableIter iter;
+  GESTrackElement *element;
+  GESTrackPrivate *priv;
+
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  priv = track->priv;
+  if (priv->baked_controls == baked)
+    return;
+
+  priv->baked_controls = baked;
+  if (baked) {
+    /* They are baked on next commit */
+    g_hash_table_iter_init (&iter, priv->trackelements_iter);
+    while (g_hash_table_iter_next (&iter, (gpointer *) & element, NULL))
+      g_hash_table_insert (priv->controlled_elements, element, element);
+  } else {
+    g_hash_table_iter_init (&iter, priv->controlled_elements);
+    while (g_hash_table_iter_next (&iter, (gpointer *) & element, NULL))
+      _ges_track_element_bake_controls (element, GST_CLOCK_TIME_NONE);
+    g_hash_table_remove_all (priv->controlled_elements);
+  }
+}
+
+/**
+ * ges_track_get_baked_controls:
+ * @track: a #GESTrack
+ *
+ * Gets whether the control bindings of the elements of @track are baked,
+ * see #ges_track_set_baked_controls.
+ *
+ * Returns: %TRUE if the control bindings are baked, %FALSE otherwise
+ */
+gboolean
+ges_track_get_baked_controls (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
+
+  return track->priv->baked_controls;
+}
+
+/**
+ * ges_track_get_instantiation_window:
+ * @track: a #GESTrack
+ *
+ * Gets how far ahead of the playback position the sources of @track are
+ * instantiated, see #ges_track_set_instantiation_window.
+ *
+ * Returns: The instantiation window of @track, #GST_CLOCK_TIME_NONE if all
+ * the sources are always instantiated
+ */
+GstClockTime
+ges_track_get_instantiation_window (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), GST_CLOCK_TIME_NONE);
+
+  return track->priv->instantiation_window;
+}
+
+/**
+ * ges_track_update_instantiation:
+ * @track: a #GESTrack
+ * @position: The position around which the sources must be instantiated
+ *
+ * Instantiates the sources of @track that are within the instantiation
+ * window after @position and releases the other ones, see
+ * #ges_track_set_instantiation_window.
+ *
+ * This is done automatically while @track is playing and when seeking it,
+ * applications only need it to prepare a position ahead of time.
+ */
+void
+ges_track_update_instantiation (GESTrack * track, GstClockTime position)
+{
+  g_return_if_fail (GES_IS_TRACK (track));
+  g_return_if_fail (GST_CLOCK_TIME_IS_VALID (position));
+
+  update_instantiation (track, position);
+}
+
 /**
  * ges_track_get_mixing:
  * @track: a #GESTrack
@@ -969,22 +2579,117 @@ ges_track_get_mixing (GESTrack * track)
  * on a clip contained in the timeline actually happen at the media
  * processing level.
  *
+ * If nothing changed in @track since it was last committed, the underlying
+ * #GnlComposition is not committed at all, which does not change what is
+ * returned. See #GESTrack::commit-stats to know what each commit did.
+ *
  * Returns: %TRUE if something as been commited %FALSE if nothing needed
  * to be commited
  */
 gboolean
 ges_track_commit (GESTrack * track)
 {
-  gboolean ret;
+  GESTrackPrivate *priv;
+  gboolean ret = TRUE, skipped;
+  guint n_touched;
+  GstClockTime start;
 
   g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
 
-  resort_and_fill_gaps (track);
-  g_signal_emit_by_name (track->priv->composition, "commit", TRUE, &ret);
+  priv = track->priv;
+  start = gst_util_get_timestamp ();
+  n_touched = g_hash_table_size (priv->dirty_elements);
+  skipped = !track_needs_commit (track);
+
+  /* Keyframes can change without anything else changing */
+  if (priv->baked_controls)
+    update_baked_controls (track);
+
+  if (skipped) {
+    GST_DEBUG_OBJECT (track, "Nothing changed since last commit");
+  } else {
+    resort_and_fill_gaps (track);
+
+    if (GST_CLOCK_TIME_IS_VALID (priv->instantiation_window))
+      update_instantiation (track, GST_CLOCK_TIME_NONE);
+
+    if (priv->layer_compositions) {
+      update_layer_compositions (track);
+      ret = commit_layer_compositions (track);
+    } else {
+      g_signal_emit_by_name (priv->composition, "commit", TRUE, &ret);
+    }
+
+    g_hash_table_remove_all (priv->dirty_elements);
+    priv->needs_commit = FALSE;
+  }
+
+  if (priv->commit_stats)
+    gst_structure_free (priv->commit_stats);
+  priv->commit_stats = gst_structure_new ("ges-commit-stats",
+      "skipped", G_TYPE_BOOLEAN, skipped,
+      "elements-touched", G_TYPE_UINT, n_touched,
+      "gaps-changed", G_TYPE_UINT, priv->gaps_changed,
+      "time", G_TYPE_UINT64, gst_util_get_timestamp () - start, NULL);
+  priv->gaps_changed = 0;
+
+  g_signal_emit (track, ges_track_signals[COMMIT_STATS], 0,
+      priv->commit_stats);
 
   return ret;
 }
 
+/* Statistics of the last commit of @track, see GESTrack::commit-stats */
+const GstStructure *
+ges_track_get_commit_stats (GESTrack * track)
+{
+  return track->priv->commit_stats;
+}
+
+/* Makes the control bindings of @element baked again on next commit, if
+ * they are baked */
+void
+ges_track_invalidate_baked_controls (GESTrack * track,
+    GESTrackElement * element)
+{
+  if (track->priv->baked_controls)
+    g_hash_table_insert (track->priv->controlled_elements, element, element);
+}
+
+void
+ges_track_begin_edit (GESTrack * track)
+{
+  track->priv->edit_depth++;
+}
+
+void
+ges_track_end_edit (GESTrack * track)
+{
+  GESTrackPrivate *priv = track->priv;
+
+  g_return_if_fail (priv->edit_depth > 0);
+
+  if (--priv->edit_depth > 0)
+    return;
+
+  sort_moved_elements (track);
+}
+
+/* Called when the base gnonlin priority of @layer changed, see
+ * _ges_layer_set_gnl_priority_base, the compositions of @layer are moved on
+ * next commit */
+void
+ges_track_layer_rebased (GESTrack * track, GESLayer * layer)
+{
+  LayerComposition *comp = g_hash_table_lookup (track->priv->layer_comps,
+      layer);
+
+  if (comp) {
+    comp->rebased = TRUE;
+    g_hash_table_insert (track->priv->dirty_comps, comp, comp);
+  }
+  track->priv->needs_commit = TRUE;
+}
 
 /**
  * ges_track_set_create_element_for_gap_func:
@@ -1002,5 +2707,11 @@ ges_track_set_create_element_for_gap_func (GESTrack * track,
 {
   g_return_if_fail (GES_IS_TRACK (track));
 
+  /* The pooled gaps were created by the previous function, the active ones
+   * are replaced on the next commit, see apply_gaps */
+  g_list_free_full (track->priv->gaps_pool, (GDestroyNotify) destroy_gap);
+  track->priv->gaps_pool = NULL;
+
   track->priv->create_element_for_gaps = func;
+  track->priv->needs_commit = TRUE;
 }
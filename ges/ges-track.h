@@ -91,6 +91,19 @@ gboolean           ges_track_remove_element                  (GESTrack *track, G
 void               ges_track_set_create_element_for_gap_func (GESTrack *track, GESCreateElementForGapFunc func);
 void               ges_track_set_mixing                      (GESTrack *track, gboolean mixing);
 gboolean           ges_track_get_mixing                      (GESTrack *track);
+void               ges_track_set_background                  (GESTrack *track, gboolean background);
+gboolean           ges_track_get_background                  (GESTrack *track);
+void               ges_track_set_region_mixing               (GESTrack *track, gboolean region_mixing);
+gboolean           ges_track_get_region_mixing               (GESTrack *track);
+void               ges_track_set_layer_compositions          (GESTrack *track, gboolean layer_compositions);
+gboolean           ges_track_get_layer_compositions          (GESTrack *track);
+gboolean           ges_track_set_layer_active                (GESTrack *track, GESLayer *layer, gboolean active);
+gboolean           ges_track_get_layer_active                (GESTrack *track, GESLayer *layer);
+void               ges_track_set_instantiation_window        (GESTrack *track, GstClockTime window);
+GstClockTime       ges_track_get_instantiation_window        (GESTrack *track);
+void               ges_track_update_instantiation            (GESTrack *track, GstClockTime position);
+void               ges_track_set_baked_controls              (GESTrack *track, gboolean baked);
+gboolean           ges_track_get_baked_controls              (GESTrack *track);
 void               ges_track_set_restriction_caps            (GESTrack *track, const GstCaps *caps);
 
 /* standard methods */
@@ -46,6 +46,10 @@ static void
 layer_priority_changed_cb (GESLayer * layer, GParamSpec * arg G_GNUC_UNUSED,
     GESVideoSource * self)
 {
+  /* The positionner only exists while we are instantiated */
+  if (self->priv->positionner == NULL)
+    return;
+
   g_object_set (self->priv->positionner, "zorder",
       10000 - ges_layer_get_priority (layer), NULL);
 }
@@ -72,6 +76,9 @@ layer_changed_cb (GESClip * clip, GParamSpec * arg G_GNUC_UNUSED,
   g_signal_connect (self->priv->layer, "notify::priority",
       G_CALLBACK (layer_priority_changed_cb), self);
 
+  if (priv->positionner == NULL)
+    return;
+
   g_object_set (self->priv->positionner, "zorder",
       10000 - ges_layer_get_priority (self->priv->layer), NULL);
 }
@@ -142,7 +149,16 @@ ges_video_source_create_element (GESTrackElement * trksrc)
 
   parent = ges_timeline_element_get_parent (GES_TIMELINE_ELEMENT (trksrc));
   if (parent) {
+    /* The positionner goes away when our content is released, see
+     * ges_track_set_instantiation_window */
+    if (self->priv->positionner)
+      g_object_remove_weak_pointer (G_OBJECT (self->priv->positionner),
+          (gpointer *) & self->priv->positionner);
     self->priv->positionner = GST_FRAME_POSITIONNER (positionner);
+    g_object_add_weak_pointer (G_OBJECT (positionner),
+        (gpointer *) & self->priv->positionner);
+    /* We might be instantiated again after having been released */
+    g_signal_handlers_disconnect_by_func (parent, layer_changed_cb, trksrc);
     g_signal_connect (parent, "notify::layer",
         (GCallback) layer_changed_cb, trksrc);
     layer_changed_cb (GES_CLIP (parent), NULL, self);
@@ -178,15 +194,31 @@ _set_parent (GESTimelineElement * self, GESTimelineElement * parent)
   return TRUE;
 }
 
+static void
+ges_video_source_dispose (GObject * object)
+{
+  GESVideoSourcePrivate *priv = GES_VIDEO_SOURCE (object)->priv;
+
+  if (priv->positionner) {
+    g_object_remove_weak_pointer (G_OBJECT (priv->positionner),
+        (gpointer *) & priv->positionner);
+    priv->positionner = NULL;
+  }
+
+  G_OBJECT_CLASS (ges_video_source_parent_class)->dispose (object);
+}
+
 static void
 ges_video_source_class_init (GESVideoSourceClass * klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GESTrackElementClass *track_class = GES_TRACK_ELEMENT_CLASS (klass);
   GESTimelineElementClass *element_class = GES_TIMELINE_ELEMENT_CLASS (klass);
   GESVideoSourceClass *video_source_class = GES_VIDEO_SOURCE_CLASS (klass);
 
   g_type_class_add_private (klass, sizeof (GESVideoSourcePrivate));
 
+  object_class->dispose = ges_video_source_dispose;
   element_class->set_parent = _set_parent;
   track_class->gnlobject_factorytype = "gnlsource";
   track_class->create_element = ges_video_source_create_element;
@@ -94,7 +94,9 @@ ges_video_test_source_set_pattern (GESVideoTestSource
 
   self->priv->pattern = pattern;
 
-  if (element) {
+  /* Also when released, so that the new pattern is kept */
+  if (element ||
+      !_ges_track_element_is_instantiated (GES_TRACK_ELEMENT (self))) {
     GValue val = { 0 };
 
     g_value_init (&val, GES_VIDEO_TEST_PATTERN_TYPE);
@@ -55,10 +55,15 @@ ges_video_uri_source_create_source (GESTrackElement * trksrc)
 
   track = ges_track_element_get_track (trksrc);
 
-  decodebin = gst_element_factory_make ("uridecodebin", NULL);
-
-  g_object_set (decodebin, "caps", ges_track_get_caps (track),
-      "expose-all-streams", FALSE, "uri", self->uri, NULL);
+  /* Sources of the same asset are usually not all playing at once, so
+   * they reuse each other's prerolled uridecodebin once released */
+  decodebin = _ges_source_take_recycled (GES_SOURCE (trksrc), self->uri);
+  if (decodebin == NULL) {
+    decodebin = gst_element_factory_make ("uridecodebin", NULL);
+    g_object_set (decodebin, "caps", ges_track_get_caps (track),
+        "expose-all-streams", FALSE, "uri", self->uri, NULL);
+  }
+  _ges_source_set_recyclable (GES_SOURCE (trksrc), decodebin, self->uri);
 
   return decodebin;
 }
@@ -511,7 +511,7 @@ _parse_binding (GMarkupParseContext * context, const gchar * element_name,
       NULL, *property_name = NULL, *mode = NULL, *track_id = NULL;
   gchar **pairs, **tmp;
   gchar *pair;
-  GSList *list = NULL;
+  GArray *timestamps, *values;
 
   if (!g_markup_collect_attributes (element_name, attribute_names,
           attribute_values, error,
@@ -526,21 +526,26 @@ _parse_binding (GMarkupParseContext * context, const gchar * element_name,
   }
 
   pairs = g_strsplit (timed_values, " ", 0);
+  timestamps = g_array_sized_new (FALSE, FALSE, sizeof (GstClockTime),
+      g_strv_length (pairs));
+  values = g_array_sized_new (FALSE, FALSE, sizeof (gdouble),
+      g_strv_length (pairs));
   for (tmp = pairs; tmp != NULL; tmp += 1) {
-    gchar **value_pair;
+    gchar *end;
+    GstClockTime timestamp;
+    gdouble value;
 
     pair = *tmp;
     if (pair == NULL)
       break;
     if (strlen (pair)) {
-      GstTimedValue *value;
-
-      value = g_slice_new (GstTimedValue);
-      value_pair = g_strsplit (pair, ":", 0);
-      value->timestamp = g_ascii_strtoull (value_pair[0], NULL, 10);
-      value->value = g_ascii_strtod (value_pair[1], NULL);
-      list = g_slist_append (list, value);
-      g_strfreev (value_pair);
+      timestamp = g_ascii_strtoull (pair, &end, 10);
+      if (*end != ':')
+        continue;
+
+      value = g_ascii_strtod (end + 1, NULL);
+      g_array_append_val (timestamps, timestamp);
+      g_array_append_val (values, value);
     }
   }
 
@@ -549,7 +554,12 @@ _parse_binding (GMarkupParseContext * context, const gchar * element_name,
   ges_base_xml_formatter_add_control_binding (GES_BASE_XML_FORMATTER (self),
       type,
       source_type,
-      property_name, (gint) g_ascii_strtoll (mode, NULL, 10), track_id, list);
+      property_name, (gint) g_ascii_strtoll (mode, NULL, 10), track_id,
+      (GstClockTime *) timestamps->data, (gdouble *) values->data,
+      timestamps->len);
+
+  g_array_free (timestamps, TRUE);
+  g_array_free (values, TRUE);
 }
 
 static inline void
@@ -836,7 +846,9 @@ _save_keyframes (GString * str, GESTrackElement * trackelement, gint index)
       g_object_get (binding, "control-source", &source, NULL);
 
       if (GST_IS_INTERPOLATION_CONTROL_SOURCE (source)) {
-        GList *timed_values, *tmp;
+        guint i, n_keyframes = 0;
+        GstClockTime *timestamps = NULL;
+        gdouble *values = NULL;
         GstInterpolationMode mode;
 
         append_escaped (str,
@@ -847,18 +859,18 @@ _save_keyframes (GString * str, GESTrackElement * trackelement, gint index)
         append_escaped (str, g_markup_printf_escaped (" mode='%d'", mode));
         append_escaped (str, g_markup_printf_escaped (" track_id='%d'", index));
         append_escaped (str, g_markup_printf_escaped (" values ='"));
-        timed_values =
-            gst_timed_value_control_source_get_all
-            (GST_TIMED_VALUE_CONTROL_SOURCE (source));
-        for (tmp = timed_values; tmp; tmp = tmp->next) {
+        /* Also saves the keyframes out of the element in-point and duration */
+        ges_track_element_get_keyframes (trackelement, key, &timestamps,
+            &values, &n_keyframes);
+        for (i = 0; i < n_keyframes; i++) {
           gchar strbuf[G_ASCII_DTOSTR_BUF_SIZE];
-          GstTimedValue *value;
 
-          value = (GstTimedValue *) tmp->data;
           append_escaped (str, g_markup_printf_escaped (" %" G_GUINT64_FORMAT
-                  ":%s ", value->timestamp, g_ascii_dtostr (strbuf,
-                      G_ASCII_DTOSTR_BUF_SIZE, value->value)));
+                  ":%s ", timestamps[i], g_ascii_dtostr (strbuf,
+                      G_ASCII_DTOSTR_BUF_SIZE, values[i])));
         }
+        g_free (timestamps);
+        g_free (values);
         append_escaped (str, g_markup_printf_escaped ("'/>\n"));
       } else
         GST_DEBUG ("control source not in [interpolation]");
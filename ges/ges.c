@@ -108,6 +108,22 @@ ges_init (void)
   return TRUE;
 }
 
+/**
+ * ges_deinit:
+ *
+ * Frees the caches GES fills for the whole process, like the children
+ * properties tables shared by the track elements, so that they do not show
+ * up as leaks. Call this once done with GES. The objects still alive keep
+ * what they use, and the caches are filled again if GES keeps being used.
+ */
+void
+ges_deinit (void)
+{
+  ges_track_element_children_props_deinit ();
+
+  GST_DEBUG ("GStreamer Editing Services caches freed");
+}
+
 
 /**
  * ges_version:
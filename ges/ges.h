@@ -88,6 +88,8 @@ G_BEGIN_DECLS
 
 gboolean ges_init    (void);
 
+void     ges_deinit  (void);
+
 void     ges_version (guint * major, guint * minor, guint * micro,
                       guint * nano);
 
@@ -22,6 +22,209 @@
 
 
 #define NUM_OBJECTS 1000
+#define NUM_COMMITS 100
+
+/* Ripples the end of @container back and forth and commits @timeline
+ * after each edit. With @full_rescan, the transitions of the whole @layer
+ * are looked for before each commit, as every commit used to do, which
+ * gives the baseline to compare the dirty set based commits with */
+static void
+time_auto_transition_commits (GESTimeline * timeline, GESLayer * layer,
+    GESContainer * container, guint num_objects, gboolean full_rescan)
+{
+  guint i;
+  GstClockTime start, end, commit_time = 0, max_commit_time = 0,
+      min_commit_time = GST_CLOCK_TIME_NONE;
+
+  for (i = 0; i < NUM_COMMITS; i++) {
+    ges_container_edit (container, NULL, -1, GES_EDIT_MODE_RIPPLE,
+        GES_EDGE_END,
+        GES_TIMELINE_ELEMENT_END (container) + (i % 2 ? -100 : 100));
+
+    start = gst_util_get_timestamp ();
+    if (full_rescan) {
+      /* Enabling auto-transitions looks for them on the whole layer */
+      ges_layer_set_auto_transition (layer, FALSE);
+      ges_layer_set_auto_transition (layer, TRUE);
+    }
+    ges_timeline_commit (timeline);
+    end = gst_util_get_timestamp ();
+
+    commit_time += end - start;
+    max_commit_time = MAX (max_commit_time, end - start);
+    min_commit_time = MIN (min_commit_time, end - start);
+  }
+  g_print ("%" GST_TIME_FORMAT " - commiting %d times with %d clips and "
+      "auto-transition on, max: %" GST_TIME_FORMAT " min: %" GST_TIME_FORMAT
+      " (%s)\n", GST_TIME_ARGS (commit_time), i, num_objects,
+      GST_TIME_ARGS (max_commit_time), GST_TIME_ARGS (min_commit_time),
+      full_rescan ? "rescanning the whole layer" : "only around moved clips");
+}
+
+/* Commits after rippling the end of a clip close to the end of a layer
+ * containing @num_objects overlapping clips, so that only a few clips
+ * (and their transitions) are touched by each edit */
+static void
+benchmark_auto_transition_commit (GESAsset * asset, guint num_objects)
+{
+  guint i;
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESContainer *container = NULL;
+  GstClockTime start, end;
+
+  layer = ges_layer_new ();
+  ges_layer_set_auto_transition (layer, TRUE);
+  timeline = ges_timeline_new_audio_video ();
+  ges_timeline_add_layer (timeline, layer);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_objects; i++) {
+    GESClip *clip = ges_layer_add_asset (layer, asset, i * 1000, 0,
+        1500, GES_TRACK_TYPE_UNKNOWN);
+
+    if (i == num_objects - 10)
+      container = GES_CONTAINER (clip);
+  }
+  ges_timeline_commit (timeline);
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - adding %d overlapping clips and "
+      "commiting\n", GST_TIME_ARGS (end - start), i);
+
+  time_auto_transition_commits (timeline, layer, container, num_objects,
+      TRUE);
+  time_auto_transition_commits (timeline, layer, container, num_objects,
+      FALSE);
+
+  gst_object_unref (timeline);
+}
+
+static gint
+compare_starts (GESTimelineElement * a, GESTimelineElement * b)
+{
+  if (a->start != b->start)
+    return a->start < b->start ? -1 : 1;
+  if (a->priority != b->priority)
+    return a->priority < b->priority ? -1 : 1;
+  if (a->duration != b->duration)
+    return a->duration < b->duration ? -1 : 1;
+
+  return 0;
+}
+
+/* What the tracks used to do on each change of one of their elements */
+static void
+sort_all_cb (GESTimelineElement * element, GParamSpec * arg,
+    GSequence * sequence)
+{
+  g_sequence_sort (sequence, (GCompareDataFunc) compare_starts, NULL);
+}
+
+/* Keeps a copy of the elements of the tracks of @timeline fully sorted on
+ * each change, as the tracks used to, or stops doing so with %NULL */
+static GList *
+sort_tracks_fully (GESTimeline * timeline, GList * sequences)
+{
+  GList *tracks, *elements, *tmp, *tmpel;
+
+  if (sequences) {
+    for (tmp = sequences; tmp; tmp = tmp->next) {
+      GSequenceIter *iter = g_sequence_get_begin_iter (tmp->data);
+
+      for (; !g_sequence_iter_is_end (iter);
+          iter = g_sequence_iter_next (iter))
+        g_signal_handlers_disconnect_by_func (g_sequence_get (iter),
+            sort_all_cb, tmp->data);
+      g_sequence_free (tmp->data);
+    }
+    g_list_free (sequences);
+
+    return NULL;
+  }
+
+  tracks = ges_timeline_get_tracks (timeline);
+  for (tmp = tracks; tmp; tmp = tmp->next) {
+    GSequence *sequence = g_sequence_new (NULL);
+
+    elements = ges_track_get_elements (tmp->data);
+    for (tmpel = elements; tmpel; tmpel = tmpel->next) {
+      g_sequence_append (sequence, tmpel->data);
+      g_signal_connect (tmpel->data, "notify::start",
+          G_CALLBACK (sort_all_cb), sequence);
+      g_signal_connect (tmpel->data, "notify::duration",
+          G_CALLBACK (sort_all_cb), sequence);
+      g_signal_connect (tmpel->data, "notify::priority",
+          G_CALLBACK (sort_all_cb), sequence);
+    }
+    g_list_free_full (elements, gst_object_unref);
+
+    sequences = g_list_prepend (sequences, sequence);
+  }
+  g_list_free_full (tracks, gst_object_unref);
+
+  return sequences;
+}
+
+/* Moves @num_moved of the @num_objects clips of a layer, one at a time and
+ * then all at once in an edit transaction, to see how the cost of keeping
+ * the tracks sorted scales with the number of clips. The baseline moves them
+ * one at a time while also sorting all the elements of the tracks on each
+ * change, as the tracks used to */
+static void
+benchmark_bulk_edit (GESAsset * asset, guint num_objects, guint num_moved)
+{
+  guint i;
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESTimelineElement **clips;
+  GList *sequences;
+  GstClockTime start, end;
+
+  layer = ges_layer_new ();
+  timeline = ges_timeline_new_audio_video ();
+  ges_timeline_add_layer (timeline, layer);
+
+  clips = g_new (GESTimelineElement *, num_objects);
+  for (i = 0; i < num_objects; i++)
+    clips[i] = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset,
+            i * 1000, 0, 1000, GES_TRACK_TYPE_UNKNOWN));
+
+  sequences = sort_tracks_fully (timeline, NULL);
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_moved; i++)
+    ges_timeline_element_set_start (clips[i * num_objects / num_moved],
+        (num_objects + i) * 1000);
+  end = gst_util_get_timestamp ();
+  sort_tracks_fully (timeline, sequences);
+  g_print ("%" GST_TIME_FORMAT " - moving %d of %d clips one at a time, "
+      "sorting the whole tracks on each change\n",
+      GST_TIME_ARGS (end - start), num_moved, num_objects);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_moved; i++)
+    ges_timeline_element_set_start (clips[i * num_objects / num_moved],
+        (i * num_objects / num_moved) * 1000);
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - moving %d of %d clips one at a time\n",
+      GST_TIME_ARGS (end - start), num_moved, num_objects);
+
+  for (i = 0; i < num_moved; i++)
+    ges_timeline_element_set_start (clips[i * num_objects / num_moved],
+        (num_objects + i) * 1000);
+
+  start = gst_util_get_timestamp ();
+  ges_timeline_begin_edit (timeline);
+  for (i = 0; i < num_moved; i++)
+    ges_timeline_element_set_start (clips[i * num_objects / num_moved],
+        (i * num_objects / num_moved) * 1000);
+  ges_timeline_end_edit (timeline);
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - moving %d of %d clips in a transaction\n",
+      GST_TIME_ARGS (end - start), num_moved, num_objects);
+
+  g_free (clips);
+  gst_object_unref (timeline);
+}
 
 gint
 main (gint argc, gchar * argv[])
@@ -93,5 +296,14 @@ main (gint argc, gchar * argv[])
   g_print ("%" GST_TIME_FORMAT " - freeing the timeline\n",
       GST_TIME_ARGS (end - start));
 
+  benchmark_auto_transition_commit (asset, 1000);
+  benchmark_auto_transition_commit (asset, 10000);
+  benchmark_auto_transition_commit (asset, 100000);
+
+  benchmark_bulk_edit (asset, 1000, 100);
+  benchmark_bulk_edit (asset, 10000, 100);
+  benchmark_bulk_edit (asset, 100000, 100);
+  benchmark_bulk_edit (asset, 10000, 10000);
+
   return 0;
 }
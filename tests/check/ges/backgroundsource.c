@@ -396,6 +396,249 @@ GST_START_TEST (test_gap_filling_empty_track)
 
 GST_END_TEST;
 
+static GstElement *
+find_gap (GstElement * composition, GstElement * gnlsrc, GstElement * gnlsrc1)
+{
+  GList *tmp;
+  GstElement *gap = NULL;
+
+  for (tmp = GST_BIN_CHILDREN (composition); tmp; tmp = tmp->next) {
+    guint prio;
+    GstElement *tmp_gnlobj = GST_ELEMENT (tmp->data);
+
+    g_object_get (tmp_gnlobj, "priority", &prio, NULL);
+    if (tmp_gnlobj != gnlsrc && tmp_gnlobj != gnlsrc1 && prio == 1)
+      gap = tmp_gnlobj;
+  }
+
+  return gap;
+}
+
+static GstElement *
+create_custom_gap (GESTrack * track)
+{
+  return gst_element_factory_make ("audiotestsrc", "custom-gap");
+}
+
+static GstElement *
+create_other_gap (GESTrack * track)
+{
+  return gst_element_factory_make ("audiotestsrc", "other-gap");
+}
+
+GST_START_TEST (test_gap_filling_reuse)
+{
+  GESAsset *asset;
+  GESTrack *track;
+  GESTimeline *timeline;
+  GstElement *composition;
+  GESLayer *layer;
+  GESClip *clip, *clip1;
+  GstElement *gnlsrc, *gnlsrc1, *gap, *filler;
+
+  ges_init ();
+
+  track = GES_TRACK (ges_audio_track_new ());
+  composition = find_composition (track);
+  layer = ges_layer_new ();
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = ges_layer_add_asset (layer, asset, 0, 0, 5, GES_TRACK_TYPE_UNKNOWN);
+  clip1 = ges_layer_add_asset (layer, asset, 15, 0, 5, GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+  ges_timeline_commit (timeline);
+
+  gnlsrc =
+      ges_track_element_get_gnlobject (GES_CONTAINER_CHILDREN (clip)->data);
+  gnlsrc1 =
+      ges_track_element_get_gnlobject (GES_CONTAINER_CHILDREN (clip1)->data);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 4);
+  gap = find_gap (composition, gnlsrc, gnlsrc1);
+  fail_unless (gap != NULL);
+  gap_object_check (gap, 5, 10, 1);
+
+  /* Nothing changed, the gap is kept as is */
+  ges_timeline_commit (timeline);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 4);
+  fail_unless (find_gap (composition, gnlsrc, gnlsrc1) == gap);
+  gap_object_check (gap, 5, 10, 1);
+
+  /* The gap grows, it is updated in place */
+  ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (clip1), 25);
+  ges_timeline_commit (timeline);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 4);
+  fail_unless (find_gap (composition, gnlsrc, gnlsrc1) == gap);
+  gap_object_check (gap, 5, 20, 1);
+
+  /* The gap disappears and then comes back, it is taken from the pool */
+  ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (clip1), 5);
+  ges_timeline_commit (timeline);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 3);
+  ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (clip1), 15);
+  ges_timeline_commit (timeline);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 4);
+  fail_unless (find_gap (composition, gnlsrc, gnlsrc1) == gap);
+  gap_object_check (gap, 5, 10, 1);
+
+  /* Changing the function replaces the gaps made by the previous one */
+  ges_track_set_create_element_for_gap_func (track, create_custom_gap);
+  ges_timeline_commit (timeline);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 4);
+  gap = find_gap (composition, gnlsrc, gnlsrc1);
+  gap_object_check (gap, 5, 10, 1);
+  filler = gst_bin_get_by_name (GST_BIN (gap), "custom-gap");
+  fail_unless (filler != NULL);
+  gst_object_unref (filler);
+
+  /* And the pooled gaps are not reused either */
+  ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (clip1), 5);
+  ges_timeline_commit (timeline);
+  ges_track_set_create_element_for_gap_func (track, create_other_gap);
+  ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (clip1), 15);
+  ges_timeline_commit (timeline);
+  gap = find_gap (composition, gnlsrc, gnlsrc1);
+  gap_object_check (gap, 5, 10, 1);
+  filler = gst_bin_get_by_name (GST_BIN (gap), "other-gap");
+  fail_unless (filler != NULL);
+  gst_object_unref (filler);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gap_filling_background)
+{
+  GList *tmp;
+  guint prio;
+  guint64 start, duration;
+  GESAsset *asset;
+  GESTrack *track;
+  GESTimeline *timeline;
+  GstElement *composition;
+  GESLayer *layer;
+  GESClip *clip, *clip1;
+  GstElement *gnlsrc, *gnlsrc1, *background;
+
+  ges_init ();
+
+  track = GES_TRACK (ges_audio_track_new ());
+  ges_track_set_background (track, TRUE);
+  fail_unless (ges_track_get_background (track));
+  composition = find_composition (track);
+  layer = ges_layer_new ();
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = ges_layer_add_asset (layer, asset, 0, 0, 5, GES_TRACK_TYPE_UNKNOWN);
+  clip1 = ges_layer_add_asset (layer, asset, 15, 0, 5, GES_TRACK_TYPE_UNKNOWN);
+  ges_layer_add_asset (layer, asset, 35, 0, 5, GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+  ges_timeline_commit (timeline);
+
+  /* 3 sources, the mixer and a single background for the 2 gaps */
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 5);
+  gnlsrc =
+      ges_track_element_get_gnlobject (GES_CONTAINER_CHILDREN (clip)->data);
+  gnlsrc1 =
+      ges_track_element_get_gnlobject (GES_CONTAINER_CHILDREN (clip1)->data);
+  background = NULL;
+  for (tmp = GST_BIN_CHILDREN (composition); tmp; tmp = tmp->next) {
+    g_object_get (tmp->data, "priority", &prio, NULL);
+    if (prio == G_MAXUINT32)
+      background = tmp->data;
+  }
+  fail_unless (background != NULL);
+  fail_if (background == gnlsrc || background == gnlsrc1);
+  g_object_get (background, "start", &start, "duration", &duration, NULL);
+  assert_equals_uint64 (start, 0);
+  assert_equals_uint64 (duration, 40);
+
+  /* Moving clips around only changes the duration of the background */
+  ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (clip1), 50);
+  ges_timeline_commit (timeline);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 5);
+  g_object_get (background, "priority", &prio, "start", &start,
+      "duration", &duration, NULL);
+  fail_unless (prio == G_MAXUINT32);
+  assert_equals_uint64 (start, 0);
+  assert_equals_uint64 (duration, 55);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_lazy_instantiation)
+{
+  gdouble freq;
+  GESAsset *asset;
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESClip *clip, *clip1;
+  GESTrackElement *source, *source1;
+  GstElement *gnlsrc, *gnlsrc1;
+
+  ges_init ();
+
+  track = GES_TRACK (ges_audio_track_new ());
+  ges_track_set_instantiation_window (track, 10);
+  assert_equals_uint64 (ges_track_get_instantiation_window (track), 10);
+  layer = ges_layer_new ();
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = ges_layer_add_asset (layer, asset, 0, 0, 5, GES_TRACK_TYPE_UNKNOWN);
+  clip1 = ges_layer_add_asset (layer, asset, 100, 0, 5,
+      GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+  ges_timeline_commit (timeline);
+
+  source = GES_CONTAINER_CHILDREN (clip)->data;
+  source1 = GES_CONTAINER_CHILDREN (clip1)->data;
+  gnlsrc = ges_track_element_get_gnlobject (source);
+  gnlsrc1 = ges_track_element_get_gnlobject (source1);
+
+  /* Only the source close to the playback position has its content */
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (gnlsrc)), 1);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (gnlsrc1)), 0);
+  ges_track_element_set_child_properties (source, "freq", 880.0, NULL);
+
+  ges_track_update_instantiation (track, 95);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (gnlsrc)), 0);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (gnlsrc1)), 1);
+
+  /* Getting the element does not instantiate the source */
+  fail_unless (ges_track_element_get_element (source) == NULL);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (gnlsrc)), 0);
+
+  /* Accessing the children properties instantiates the source back, with
+   * the values it had when released */
+  ges_track_element_get_child_properties (source, "freq", &freq, NULL);
+  assert_equals_float (freq, 880.0);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (gnlsrc)), 1);
+
+  /* Disabling the window instantiates everything */
+  ges_track_update_instantiation (track, 200);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (gnlsrc)), 0);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (gnlsrc1)), 0);
+  ges_track_set_instantiation_window (track, GST_CLOCK_TIME_NONE);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (gnlsrc)), 1);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (gnlsrc1)), 1);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -409,6 +652,9 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_test_source_in_layer);
   tcase_add_test (tc_chain, test_gap_filling_basic);
   tcase_add_test (tc_chain, test_gap_filling_empty_track);
+  tcase_add_test (tc_chain, test_gap_filling_reuse);
+  tcase_add_test (tc_chain, test_gap_filling_background);
+  tcase_add_test (tc_chain, test_lazy_instantiation);
 
   return s;
 }
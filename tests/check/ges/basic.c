@@ -706,6 +706,309 @@ GST_START_TEST (test_ges_pipeline_change_state)
 
 GST_END_TEST;
 
+static gint snapshot_reader_started;
+
+static gpointer
+snapshot_reader (GESTimeline * timeline)
+{
+  guint n_clips;
+  guint64 version = 0;
+  GESTimelineSnapshot *snapshot;
+
+  while (version < 50) {
+    snapshot = ges_timeline_acquire_snapshot (timeline);
+    g_atomic_int_set (&snapshot_reader_started, TRUE);
+    fail_unless (ges_timeline_snapshot_get_version (snapshot) >= version);
+    version = ges_timeline_snapshot_get_version (snapshot);
+    ges_timeline_snapshot_get_clips (snapshot, &n_clips);
+    fail_unless (version <= 1 || n_clips == 2);
+    ges_timeline_snapshot_unref (snapshot);
+  }
+
+  return NULL;
+}
+
+static gpointer
+acquire_snapshot (GESTimeline * timeline)
+{
+  return ges_timeline_acquire_snapshot (timeline);
+}
+
+/* Acquires a snapshot from another thread while @timeline is committing */
+static void
+commit_stats_acquire_cb (GESTimeline * timeline, const GstStructure * stats,
+    GESTimelineSnapshot ** snapshot)
+{
+  GThread *thread;
+
+  thread = g_thread_new ("snapshot-acquirer", (GThreadFunc) acquire_snapshot,
+      timeline);
+  *snapshot = g_thread_join (thread);
+}
+
+GST_START_TEST (test_ges_timeline_snapshot)
+{
+  guint i, n;
+  GThread *reader;
+  GESAsset *asset;
+  GESLayer *layer;
+  GESTimeline *timeline;
+  GESTimelineElement *clip, *clip1;
+  GESTimelineSnapshot *snapshot, *snapshot1;
+  const GESTimelineSnapshotLayer *layers;
+  const GESTimelineSnapshotClip *clips;
+  const GESTimelineSnapshotElement *elements;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 10, 0, 10,
+          GES_TRACK_TYPE_UNKNOWN));
+  clip1 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 0, 0, 10,
+          GES_TRACK_TYPE_UNKNOWN));
+  gst_object_unref (asset);
+
+  /* Nothing was committed yet */
+  snapshot = ges_timeline_acquire_snapshot (timeline);
+  ges_timeline_snapshot_get_clips (snapshot, &n);
+  assert_equals_int (n, 0);
+
+  ges_timeline_commit (timeline);
+  snapshot1 = ges_timeline_acquire_snapshot (timeline);
+  fail_unless (ges_timeline_snapshot_get_version (snapshot1) >
+      ges_timeline_snapshot_get_version (snapshot));
+  ges_timeline_snapshot_get_clips (snapshot, &n);
+  assert_equals_int (n, 0);
+  ges_timeline_snapshot_unref (snapshot);
+
+  layers = ges_timeline_snapshot_get_layers (snapshot1, &n);
+  assert_equals_int (n, 1);
+  fail_unless (layers[0].layer == layer);
+  assert_equals_int (layers[0].first_clip, 0);
+  assert_equals_int (layers[0].n_clips, 2);
+
+  clips = ges_timeline_snapshot_get_clips (snapshot1, &n);
+  assert_equals_int (n, 2);
+  fail_unless (clips[0].clip == clip1);
+  fail_unless (clips[1].clip == clip);
+  assert_equals_uint64 (clips[1].start, 10);
+  assert_equals_uint64 (clips[1].duration, 10);
+  assert_equals_int (clips[1].track_types,
+      GES_TRACK_TYPE_AUDIO | GES_TRACK_TYPE_VIDEO);
+  assert_equals_int (clips[1].n_elements, 2);
+
+  elements = ges_timeline_snapshot_get_elements (snapshot1, &n);
+  assert_equals_int (n, 4);
+  for (i = 0; i < clips[1].n_elements; i++) {
+    const GESTimelineSnapshotElement *element =
+        &elements[clips[1].first_element + i];
+
+    assert_equals_int (element->clip_index, 1);
+    fail_unless (g_list_find (GES_CONTAINER_CHILDREN (clip),
+            element->element));
+    assert_equals_uint64 (element->start, 10);
+  }
+
+  /* A snapshot never changes */
+  fail_if (ges_timeline_snapshot_is_outdated (snapshot1));
+  ges_timeline_element_set_start (clip, 20);
+  ges_timeline_commit (timeline);
+  assert_equals_uint64 (clips[1].start, 10);
+  fail_unless (ges_timeline_snapshot_is_outdated (snapshot1));
+
+  /* Snapshots are only built when acquired after a commit */
+  ges_timeline_commit (timeline);
+  snapshot = ges_timeline_acquire_snapshot (timeline);
+  assert_equals_uint64 (ges_timeline_snapshot_get_version (snapshot),
+      ges_timeline_snapshot_get_version (snapshot1) + 1);
+  ges_timeline_snapshot_unref (snapshot1);
+  snapshot1 = ges_timeline_acquire_snapshot (timeline);
+  fail_unless (snapshot1 == snapshot);
+  ges_timeline_snapshot_unref (snapshot1);
+
+  clips = ges_timeline_snapshot_get_clips (snapshot, &n);
+  assert_equals_uint64 (clips[1].start, 20);
+  snapshot1 = g_boxed_copy (GES_TYPE_TIMELINE_SNAPSHOT, snapshot);
+  fail_unless (snapshot1 == snapshot);
+  g_boxed_free (GES_TYPE_TIMELINE_SNAPSHOT, snapshot1);
+  ges_timeline_snapshot_unref (snapshot);
+
+  /* Snapshots can be read while the timeline is being edited, they are
+   * then built on each commit */
+  reader = g_thread_new ("snapshot-reader", (GThreadFunc) snapshot_reader,
+      timeline);
+  while (!g_atomic_int_get (&snapshot_reader_started))
+    g_thread_yield ();
+  for (i = 0; i < 50; i++) {
+    ges_timeline_element_set_start (clip, 20 + i);
+    ges_timeline_commit (timeline);
+  }
+  g_thread_join (reader);
+
+  /* Acquiring from another thread while committing does not block, and gets
+   * the snapshot of that commit as it is published before it returns */
+  g_signal_connect (timeline, "commit-stats",
+      G_CALLBACK (commit_stats_acquire_cb), &snapshot);
+  ges_timeline_element_set_start (clip, 100);
+  ges_timeline_commit (timeline);
+  fail_unless (snapshot != NULL);
+  fail_if (ges_timeline_snapshot_is_outdated (snapshot));
+  clips = ges_timeline_snapshot_get_clips (snapshot, &n);
+  assert_equals_uint64 (clips[1].start, 100);
+  ges_timeline_snapshot_unref (snapshot);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+static void
+commit_stats_cb (GObject * object, const GstStructure * stats,
+    GstStructure ** last_stats)
+{
+  if (*last_stats)
+    gst_structure_free (*last_stats);
+  *last_stats = gst_structure_copy (stats);
+}
+
+GST_START_TEST (test_ges_commit_stats)
+{
+  guint val;
+  gboolean skipped;
+  GESAsset *asset;
+  GESLayer *layer;
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESTimelineElement *clip;
+  GstStructure *track_stats = NULL, *stats = NULL;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = GES_TRACK (ges_video_track_new ());
+  fail_unless (ges_timeline_add_track (timeline, track));
+  g_signal_connect (track, "commit-stats", G_CALLBACK (commit_stats_cb),
+      &track_stats);
+  g_signal_connect (timeline, "commit-stats", G_CALLBACK (commit_stats_cb),
+      &stats);
+
+  layer = ges_timeline_append_layer (timeline);
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  ges_layer_add_asset (layer, asset, 0, 0, 10, GES_TRACK_TYPE_UNKNOWN);
+  clip = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 20, 0, 10,
+          GES_TRACK_TYPE_UNKNOWN));
+  gst_object_unref (asset);
+
+  ges_timeline_commit (timeline);
+  fail_unless (gst_structure_get (track_stats, "skipped", G_TYPE_BOOLEAN,
+          &skipped, "elements-touched", G_TYPE_UINT, &val, NULL));
+  fail_if (skipped);
+  assert_equals_int (val, 2);
+  fail_unless (gst_structure_get_uint (track_stats, "gaps-changed", &val));
+  assert_equals_int (val, 1);
+  fail_unless (gst_structure_get_uint (stats, "tracks-committed", &val));
+  assert_equals_int (val, 1);
+
+  /* Nothing changed, the track is not committed */
+  ges_timeline_commit (timeline);
+  fail_unless (gst_structure_get (track_stats, "skipped", G_TYPE_BOOLEAN,
+          &skipped, "elements-touched", G_TYPE_UINT, &val, NULL));
+  fail_unless (skipped);
+  assert_equals_int (val, 0);
+  fail_unless (gst_structure_get_uint (stats, "tracks-skipped", &val));
+  assert_equals_int (val, 1);
+  fail_unless (gst_structure_get_uint (stats, "tracks-committed", &val));
+  assert_equals_int (val, 0);
+  fail_unless (gst_structure_get_boolean (stats, "skipped", &skipped));
+  fail_unless (skipped);
+  fail_unless (gst_structure_has_field (stats, "time"));
+
+  /* Moving a clip only touches it and the gap in front of it */
+  ges_timeline_element_set_start (clip, 15);
+  ges_timeline_commit (timeline);
+  fail_unless (gst_structure_get (track_stats, "skipped", G_TYPE_BOOLEAN,
+          &skipped, "elements-touched", G_TYPE_UINT, &val, NULL));
+  fail_if (skipped);
+  assert_equals_int (val, 1);
+  fail_unless (gst_structure_get_uint (stats, "gaps-changed", &val));
+  assert_equals_int (val, 1);
+
+  gst_structure_free (track_stats);
+  gst_structure_free (stats);
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+static void
+commit_done_cb (GESTimeline * timeline, GAsyncResult * result,
+    guint * n_done)
+{
+  GError *error = NULL;
+
+  ges_timeline_commit_finish (timeline, result, &error);
+  fail_unless (error == NULL);
+  (*n_done)++;
+}
+
+static void
+count_commits_cb (GESTimeline * timeline, const GstStructure * stats,
+    guint * n_commits)
+{
+  (*n_commits)++;
+}
+
+GST_START_TEST (test_ges_timeline_commit_async)
+{
+  GESAsset *asset;
+  GESLayer *layer;
+  GESTimeline *timeline;
+  GESTimelineElement *clip;
+  guint n_done = 0, n_commits = 0;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  g_signal_connect (timeline, "commit-stats", G_CALLBACK (count_commits_cb),
+      &n_commits);
+  layer = ges_timeline_append_layer (timeline);
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 0, 0, 10,
+          GES_TRACK_TYPE_UNKNOWN));
+  gst_object_unref (asset);
+
+  /* A burst of edits only leads to a single commit */
+  ges_timeline_commit_async (timeline, NULL,
+      (GAsyncReadyCallback) commit_done_cb, &n_done);
+  ges_timeline_element_set_start (clip, 10);
+  ges_timeline_commit_async (timeline, NULL,
+      (GAsyncReadyCallback) commit_done_cb, &n_done);
+  ges_timeline_element_set_start (clip, 20);
+  ges_timeline_commit_async (timeline, NULL,
+      (GAsyncReadyCallback) commit_done_cb, &n_done);
+  assert_equals_int (n_commits, 0);
+
+  while (n_done < 3)
+    g_main_context_iteration (NULL, TRUE);
+  assert_equals_int (n_commits, 1);
+
+  /* A synchronous commit completes the queued ones */
+  ges_timeline_commit_async (timeline, NULL,
+      (GAsyncReadyCallback) commit_done_cb, &n_done);
+  ges_timeline_commit (timeline);
+  assert_equals_int (n_commits, 2);
+  while (n_done < 4)
+    g_main_context_iteration (NULL, TRUE);
+  while (g_main_context_iteration (NULL, FALSE));
+  assert_equals_int (n_commits, 2);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -721,6 +1024,9 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_ges_timeline_remove_track);
   tcase_add_test (tc_chain, test_ges_timeline_multiple_tracks);
   tcase_add_test (tc_chain, test_ges_pipeline_change_state);
+  tcase_add_test (tc_chain, test_ges_timeline_snapshot);
+  tcase_add_test (tc_chain, test_ges_commit_stats);
+  tcase_add_test (tc_chain, test_ges_timeline_commit_async);
 
   return s;
 }
@@ -20,6 +20,7 @@
 #include "test-utils.h"
 #include <ges/ges.h>
 #include <gst/check/gstcheck.h>
+#include <gst/controller/gstinterpolationcontrolsource.h>
 
 void
 deep_prop_changed_cb (GESTrackElement * track_element, GstElement * element,
@@ -492,6 +493,386 @@ GST_START_TEST (test_clip_signals)
 }
 
 GST_END_TEST;
+static void
+check_keyframes (GstControlSource * source, guint n_values,
+    GstClockTime first_timestamp, gdouble first_value,
+    GstClockTime last_timestamp, gdouble last_value)
+{
+  GList *values;
+  GstTimedValue *value;
+
+  values = gst_timed_value_control_source_get_all
+      (GST_TIMED_VALUE_CONTROL_SOURCE (source));
+  assert_equals_int (g_list_length (values), n_values);
+
+  value = values->data;
+  assert_equals_uint64 (value->timestamp, first_timestamp);
+  assert_equals_float (value->value, first_value);
+  value = g_list_last (values)->data;
+  assert_equals_uint64 (value->timestamp, last_timestamp);
+  assert_equals_float (value->value, last_value);
+
+  g_list_free (values);
+}
+
+GST_START_TEST (test_effect_keyframes_trimming)
+{
+  guint i;
+  gdouble value;
+  gboolean in_place;
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESTrack *track_video;
+  GESEffect *effect;
+  GESTestClip *clip;
+  GstControlSource *source;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_layer_new ();
+  track_video = GES_TRACK (ges_video_track_new ());
+
+  ges_timeline_add_track (timeline, track_video);
+  ges_timeline_add_layer (timeline, layer);
+
+  clip = ges_test_clip_new ();
+  g_object_set (clip, "duration", 10 * GST_SECOND, NULL);
+  ges_layer_add_clip (layer, (GESClip *) clip);
+
+  effect = ges_effect_new ("agingtv");
+  fail_unless (ges_container_add (GES_CONTAINER (clip),
+          GES_TIMELINE_ELEMENT (effect)));
+
+  source = gst_interpolation_control_source_new ();
+  g_object_set (source, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+  fail_unless (ges_track_element_set_control_source (GES_TRACK_ELEMENT
+          (effect), source, "scratch-lines", "direct"));
+  for (i = 0; i <= 10; i++)
+    gst_timed_value_control_source_set (GST_TIMED_VALUE_CONTROL_SOURCE
+        (source), i * GST_SECOND, i / 10.0);
+
+  /* Keyframes outside of the window are removed from the control source,
+   * and interpolated ones are added on the edges */
+  g_object_set (clip, "in-point", 2 * GST_SECOND, NULL);
+  check_keyframes (source, 10, 2 * GST_SECOND, 0.2, 12 * GST_SECOND, 1.0);
+  g_object_set (clip, "duration", 5 * GST_SECOND, NULL);
+  check_keyframes (source, 6, 2 * GST_SECOND, 0.2, 7 * GST_SECOND, 0.7);
+  g_object_set (clip, "in-point", 2 * GST_SECOND + GST_SECOND / 2, NULL);
+  check_keyframes (source, 7, 2 * GST_SECOND + GST_SECOND / 2, 0.25,
+      7 * GST_SECOND + GST_SECOND / 2, 0.75);
+
+  /* Extending the clip back gives the removed keyframes back */
+  g_object_set (clip, "in-point", (guint64) 0, NULL);
+  g_object_set (clip, "duration", 10 * GST_SECOND, NULL);
+  check_keyframes (source, 11, 0, 0.0, 10 * GST_SECOND, 1.0);
+
+  /* Keyframes added directly to the control source are kept as well */
+  gst_timed_value_control_source_set (GST_TIMED_VALUE_CONTROL_SOURCE
+      (source), GST_SECOND / 2, 0.9);
+  g_object_set (clip, "in-point", GST_SECOND, NULL);
+  check_keyframes (source, 11, GST_SECOND, 0.1, 11 * GST_SECOND, 1.0);
+  g_object_set (clip, "in-point", (guint64) 0, NULL);
+  check_keyframes (source, 12, 0, 0.0, 10 * GST_SECOND, 1.0);
+
+  /* So are values changed directly, even when the number of keyframes does
+   * not change if the control source has the signals to notice it, and
+   * reloading the window keeps the keyframes outside of it without turning
+   * its interpolated edges into keyframes */
+  in_place = g_signal_lookup ("value-changed", G_OBJECT_TYPE (source)) != 0;
+  if (in_place)
+    gst_timed_value_control_source_set (GST_TIMED_VALUE_CONTROL_SOURCE
+        (source), 5 * GST_SECOND, 0.3);
+  g_object_set (clip, "in-point", 6 * GST_SECOND, NULL);
+  check_keyframes (source, 6, 6 * GST_SECOND, 0.6, 16 * GST_SECOND, 1.0);
+  gst_timed_value_control_source_set (GST_TIMED_VALUE_CONTROL_SOURCE
+      (source), 7 * GST_SECOND + GST_SECOND / 2, 0.1);
+  g_object_set (clip, "in-point", (guint64) 0, NULL);
+  check_keyframes (source, 13, 0, 0.0, 10 * GST_SECOND, 1.0);
+  fail_unless (gst_control_source_get_value (source, 5 * GST_SECOND, &value));
+  assert_equals_float (value, in_place ? 0.3 : 0.5);
+  fail_unless (gst_control_source_get_value (source,
+          7 * GST_SECOND + GST_SECOND / 2, &value));
+  assert_equals_float (value, 0.1);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_effect_set_keyframes)
+{
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESEffect *effect;
+  GESTestClip *clip;
+  GstControlSource *source;
+  GstClockTime *timestamps;
+  gdouble *values;
+  guint n_keyframes;
+  GstClockTime set_timestamps[] = { 4 * GST_SECOND, 0, 8 * GST_SECOND,
+    4 * GST_SECOND
+  };
+  gdouble set_values[] = { 0.1, 0.0, 0.8, 0.4 };
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_layer_new ();
+  ges_timeline_add_track (timeline, GES_TRACK (ges_video_track_new ()));
+  ges_timeline_add_layer (timeline, layer);
+
+  clip = ges_test_clip_new ();
+  g_object_set (clip, "duration", 10 * GST_SECOND, NULL);
+  ges_layer_add_clip (layer, (GESClip *) clip);
+
+  effect = ges_effect_new ("agingtv");
+  fail_unless (ges_container_add (GES_CONTAINER (clip),
+          GES_TIMELINE_ELEMENT (effect)));
+
+  /* The property needs to be bound first */
+  fail_if (ges_track_element_set_keyframes (GES_TRACK_ELEMENT (effect),
+          "scratch-lines", set_timestamps, set_values, 4));
+  source = gst_interpolation_control_source_new ();
+  fail_unless (ges_track_element_set_control_source (GES_TRACK_ELEMENT
+          (effect), source, "scratch-lines", "direct"));
+
+  /* Sorted, the last value of a timestamp wins */
+  fail_unless (ges_track_element_set_keyframes (GES_TRACK_ELEMENT (effect),
+          "scratch-lines", set_timestamps, set_values, 4));
+  check_keyframes (source, 3, 0, 0.0, 8 * GST_SECOND, 0.8);
+  fail_unless (ges_track_element_get_keyframes (GES_TRACK_ELEMENT (effect),
+          "scratch-lines", &timestamps, &values, &n_keyframes));
+  assert_equals_int (n_keyframes, 3);
+  assert_equals_uint64 (timestamps[1], 4 * GST_SECOND);
+  assert_equals_float (values[1], 0.4);
+  g_free (timestamps);
+  g_free (values);
+
+  /* The getter also returns the keyframes trimmed out */
+  g_object_set (clip, "duration", 4 * GST_SECOND, NULL);
+  check_keyframes (source, 2, 0, 0.0, 4 * GST_SECOND, 0.4);
+  fail_unless (ges_track_element_get_keyframes (GES_TRACK_ELEMENT (effect),
+          "scratch-lines", &timestamps, &values, &n_keyframes));
+  assert_equals_int (n_keyframes, 3);
+  assert_equals_uint64 (timestamps[2], 8 * GST_SECOND);
+  g_free (timestamps);
+  g_free (values);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+/* Checks the value the child property of @effect gets at @timestamp, and
+ * whether the binding driving it is the one set on @effect */
+static void
+check_child_control_value (GESEffect * effect, GstClockTime timestamp,
+    gdouble expected, gboolean original)
+{
+  gdouble value;
+  GstElement *child;
+  GParamSpec *pspec;
+  GstControlSource *source;
+  GstControlBinding *binding;
+
+  fail_unless (ges_track_element_lookup_child (GES_TRACK_ELEMENT (effect),
+          "scratch-lines", &child, &pspec));
+  binding = gst_object_get_control_binding (GST_OBJECT (child),
+      "scratch-lines");
+  fail_unless (binding != NULL);
+  fail_unless ((binding ==
+          ges_track_element_get_control_binding (GES_TRACK_ELEMENT (effect),
+              "scratch-lines")) == original);
+
+  g_object_get (binding, "control-source", &source, NULL);
+  fail_unless (gst_control_source_get_value (source, timestamp, &value));
+  fail_unless (ABS (value - expected) < 0.0001, "Got %f instead of %f",
+      value, expected);
+
+  gst_object_unref (source);
+  gst_object_unref (binding);
+  gst_object_unref (child);
+  g_param_spec_unref (pspec);
+}
+
+GST_START_TEST (test_effect_baked_controls)
+{
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESTrack *track;
+  GESEffect *effect;
+  GESTestClip *clip;
+  GstCaps *caps;
+  GstControlSource *source;
+  GstClockTime timestamps[] = { 0, 10 * GST_SECOND };
+  gdouble rising[] = { 0.0, 1.0 }, falling[] = { 1.0, 0.0 };
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_layer_new ();
+  track = GES_TRACK (ges_video_track_new ());
+  caps = gst_caps_from_string ("video/x-raw,framerate=10/1");
+  ges_track_set_restriction_caps (track, caps);
+  gst_caps_unref (caps);
+  ges_timeline_add_track (timeline, track);
+  ges_timeline_add_layer (timeline, layer);
+
+  clip = ges_test_clip_new ();
+  g_object_set (clip, "duration", 10 * GST_SECOND, NULL);
+  ges_layer_add_clip (layer, (GESClip *) clip);
+
+  effect = ges_effect_new ("agingtv");
+  fail_unless (ges_container_add (GES_CONTAINER (clip),
+          GES_TIMELINE_ELEMENT (effect)));
+
+  source = gst_interpolation_control_source_new ();
+  g_object_set (source, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+  fail_unless (ges_track_element_set_control_source (GES_TRACK_ELEMENT
+          (effect), source, "scratch-lines", "direct"));
+  fail_unless (ges_track_element_set_keyframes (GES_TRACK_ELEMENT (effect),
+          "scratch-lines", timestamps, rising, 2));
+
+  /* Not baked, the value is interpolated at any timestamp */
+  fail_unless (ges_timeline_commit (timeline));
+  check_child_control_value (effect, GST_SECOND + GST_SECOND / 20, 0.105,
+      TRUE);
+
+  /* Baked, the value is the one of the frame containing the timestamp */
+  ges_track_set_baked_controls (track, TRUE);
+  fail_unless (ges_track_get_baked_controls (track));
+  fail_unless (ges_timeline_commit (timeline));
+  check_child_control_value (effect, GST_SECOND + GST_SECOND / 20, 0.1,
+      FALSE);
+
+  /* Changing the keyframes gives the control source back until the next
+   * commit bakes them again */
+  fail_unless (ges_track_element_set_keyframes (GES_TRACK_ELEMENT (effect),
+          "scratch-lines", timestamps, falling, 2));
+  check_child_control_value (effect, GST_SECOND + GST_SECOND / 20, 0.895,
+      TRUE);
+  fail_unless (ges_timeline_commit (timeline));
+  check_child_control_value (effect, GST_SECOND + GST_SECOND / 20, 0.9,
+      FALSE);
+
+  /* Also when the property is named with its class name */
+  fail_unless (ges_track_element_set_keyframes (GES_TRACK_ELEMENT (effect),
+          "GstAgingTV::scratch-lines", timestamps, rising, 2));
+  check_child_control_value (effect, GST_SECOND + GST_SECOND / 20, 0.105,
+      TRUE);
+  fail_unless (ges_timeline_commit (timeline));
+  check_child_control_value (effect, GST_SECOND + GST_SECOND / 20, 0.1,
+      FALSE);
+
+  ges_track_set_baked_controls (track, FALSE);
+  check_child_control_value (effect, 0, 1.0, TRUE);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+static void
+deep_notify_cb (GESTrackElement * element, GstElement * child,
+    GParamSpec * pspec, guint * n_notifies)
+{
+  (*n_notifies)++;
+}
+
+GST_START_TEST (test_effect_child_property_handles)
+{
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESTestClip *clip;
+  GESTrackElement *effect, *effect2;
+  GESChildPropertyHandle *lines, *aging, *handles[2];
+  guint scratch_lines, n_notifies = 0;
+  gboolean color_aging;
+  GValue value = { 0 }, values[2] = { {0}, {0} };
+  GstElement *child;
+  GParamSpec *pspec;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_layer_new ();
+  ges_timeline_add_track (timeline, GES_TRACK (ges_video_track_new ()));
+  ges_timeline_add_layer (timeline, layer);
+
+  clip = ges_test_clip_new ();
+  g_object_set (clip, "duration", 10 * GST_SECOND, NULL);
+  ges_layer_add_clip (layer, (GESClip *) clip);
+
+  effect = GES_TRACK_ELEMENT (ges_effect_new ("agingtv"));
+  effect2 = GES_TRACK_ELEMENT (ges_effect_new ("agingtv"));
+  fail_unless (ges_container_add (GES_CONTAINER (clip),
+          GES_TIMELINE_ELEMENT (effect)));
+  fail_unless (ges_container_add (GES_CONTAINER (clip),
+          GES_TIMELINE_ELEMENT (effect2)));
+
+  /* Names with the class name are found before any other lookup */
+  fail_unless (ges_track_element_lookup_child (effect2,
+          "GstAgingTV::color-aging", &child, &pspec));
+  assert_equals_string (pspec->name, "color-aging");
+  gst_object_unref (child);
+  g_param_spec_unref (pspec);
+
+  fail_if (ges_track_element_get_child_property_handle (effect, "nothing"));
+  fail_if (ges_track_element_get_child_property_handle (effect,
+          "GstVideoTestSrc::scratch-lines"));
+  lines = ges_track_element_get_child_property_handle (effect,
+      "GstAgingTV::scratch-lines");
+  fail_unless (lines != NULL);
+  fail_unless (lines == ges_track_element_get_child_property_handle (effect,
+          "scratch-lines"));
+  aging = ges_track_element_get_child_property_handle (effect, "color-aging");
+  fail_unless (aging != NULL);
+
+  /* Handles can be used with any element of the same type */
+  g_value_init (&value, G_TYPE_UINT);
+  g_value_set_uint (&value, 12);
+  fail_unless (ges_track_element_set_child_property_by_handle (effect2, lines,
+          &value));
+  g_value_unset (&value);
+  fail_unless (ges_track_element_get_child_property_by_handle (effect2, lines,
+          &value));
+  assert_equals_int (g_value_get_uint (&value), 12);
+  g_value_unset (&value);
+
+  /* Each property is notified once, after all of them are set */
+  g_signal_connect (effect, "deep-notify", G_CALLBACK (deep_notify_cb),
+      &n_notifies);
+  fail_unless (ges_track_element_set_child_properties_by_handle (effect,
+          lines, 3, lines, 5, aging, FALSE, NULL));
+  assert_equals_int (n_notifies, 2);
+  ges_track_element_get_child_properties (effect, "scratch-lines",
+      &scratch_lines, "color-aging", &color_aging, NULL);
+  assert_equals_int (scratch_lines, 5);
+  fail_if (color_aging);
+
+  handles[0] = lines;
+  handles[1] = aging;
+  g_value_init (&values[0], G_TYPE_UINT);
+  g_value_set_uint (&values[0], 7);
+  g_value_init (&values[1], G_TYPE_BOOLEAN);
+  g_value_set_boolean (&values[1], TRUE);
+  n_notifies = 0;
+  fail_unless (ges_track_element_set_child_properties_array (effect, handles,
+          values, 2));
+  assert_equals_int (n_notifies, 2);
+  ges_track_element_get_child_properties (effect, "scratch-lines",
+      &scratch_lines, "color-aging", &color_aging, NULL);
+  assert_equals_int (scratch_lines, 7);
+  fail_unless (color_aging);
+  g_value_unset (&values[0]);
+  g_value_unset (&values[1]);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -507,6 +888,10 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_priorities_clip);
   tcase_add_test (tc_chain, test_effect_set_properties);
   tcase_add_test (tc_chain, test_clip_signals);
+  tcase_add_test (tc_chain, test_effect_keyframes_trimming);
+  tcase_add_test (tc_chain, test_effect_set_keyframes);
+  tcase_add_test (tc_chain, test_effect_baked_controls);
+  tcase_add_test (tc_chain, test_effect_child_property_handles);
 
   return s;
 }
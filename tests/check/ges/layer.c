@@ -77,13 +77,15 @@ GST_START_TEST (test_layer_properties)
   gnl_object_check (ges_track_element_get_gnlobject (trackelement), 42, 51, 12,
       51, MIN_GNL_PRIO, TRUE);
 
-  /* Change the priority of the layer */
+  /* Change the priority of the layer, it is alone in the timeline so it
+   * keeps its gnonlin priorities */
   g_object_set (layer, "priority", 1, NULL);
   assert_equals_int (ges_layer_get_priority (layer), 1);
   assert_equals_uint64 (_PRIORITY (clip), 0);
   ges_timeline_commit (timeline);
+  assert_equals_int (layer->min_gnl_priority, MIN_GNL_PRIO);
   gnl_object_check (ges_track_element_get_gnlobject (trackelement), 42, 51, 12,
-      51, LAYER_HEIGHT + MIN_GNL_PRIO, TRUE);
+      51, MIN_GNL_PRIO, TRUE);
 
   /* Change it to an insanely high value */
   g_object_set (layer, "priority", 31, NULL);
@@ -91,7 +93,7 @@ GST_START_TEST (test_layer_properties)
   assert_equals_uint64 (_PRIORITY (clip), 0);
   ges_timeline_commit (timeline);
   gnl_object_check (ges_track_element_get_gnlobject (trackelement), 42, 51, 12,
-      51, MIN_GNL_PRIO + LAYER_HEIGHT * 31, TRUE);
+      51, MIN_GNL_PRIO, TRUE);
 
   /* and back to 0 */
   g_object_set (layer, "priority", 0, NULL);
@@ -209,15 +211,20 @@ GST_START_TEST (test_layer_priorities)
   assert_equals_int (ges_layer_get_priority (layer1), 2);
   assert_equals_int (ges_layer_get_priority (layer2), 0);
   assert_equals_int (ges_layer_get_priority (layer3), 1);
+  fail_unless (g_list_nth_data (timeline->layers, 0) == layer2);
+  fail_unless (g_list_nth_data (timeline->layers, 1) == layer3);
+  fail_unless (g_list_nth_data (timeline->layers, 2) == layer1);
   assert_equals_int (_PRIORITY (clip1), 0);
   assert_equals_int (_PRIORITY (clip2), 1);
   assert_equals_int (_PRIORITY (clip3), LAYER_HEIGHT - 1);
   g_object_get (gnlobj1, "priority", &prio1, NULL);
   g_object_get (gnlobj2, "priority", &prio2, NULL);
   g_object_get (gnlobj3, "priority", &prio3, NULL);
-  assert_equals_int (prio1, 2 * LAYER_HEIGHT + MIN_GNL_PRIO);
-  assert_equals_int (prio2, MIN_GNL_PRIO + 1);
-  assert_equals_int (prio3, LAYER_HEIGHT * 2 - 1 + MIN_GNL_PRIO);
+  assert_equals_int (prio1, layer1->min_gnl_priority);
+  assert_equals_int (prio2, layer2->min_gnl_priority + 1);
+  assert_equals_int (prio3, layer3->min_gnl_priority + LAYER_HEIGHT - 1);
+  fail_unless (prio2 < prio3);
+  fail_unless (prio3 < prio1);
 
   /* And move objects around */
   fail_unless (ges_clip_move_to_layer (clip2, layer1));
@@ -241,9 +248,9 @@ GST_START_TEST (test_layer_priorities)
   g_object_get (gnlobj1, "priority", &prio1, NULL);
   g_object_get (gnlobj2, "priority", &prio2, NULL);
   g_object_get (gnlobj3, "priority", &prio3, NULL);
-  assert_equals_int (prio1, 2 * LAYER_HEIGHT + MIN_GNL_PRIO);
-  assert_equals_int (prio2, 2 * LAYER_HEIGHT + 1 + MIN_GNL_PRIO);
-  assert_equals_int (prio3, LAYER_HEIGHT * 3 - 1 + MIN_GNL_PRIO);
+  assert_equals_int (prio1, layer1->min_gnl_priority);
+  assert_equals_int (prio2, layer1->min_gnl_priority + 1);
+  assert_equals_int (prio3, layer1->min_gnl_priority + LAYER_HEIGHT - 1);
 
   /* And change TrackElement-s priorities and check that changes are not
    * refected on it containing Clip
@@ -264,6 +271,253 @@ GST_START_TEST (test_layer_priorities)
 
 GST_END_TEST;
 
+static GESLayer *
+insert_layer_on_top (GESTimeline * timeline)
+{
+  GList *layers, *tmp;
+  GESLayer *layer = ges_layer_new ();
+
+  layers = ges_timeline_get_layers (timeline);
+  for (tmp = g_list_last (layers); tmp; tmp = tmp->prev)
+    ges_layer_set_priority (tmp->data,
+        ges_layer_get_priority (tmp->data) + 1);
+  g_list_free_full (layers, gst_object_unref);
+
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  return layer;
+}
+
+GST_START_TEST (test_layer_priorities_sparse)
+{
+  gint i;
+  GESClip *clip;
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESLayer *layers[3], *top;
+  GESTrackElement *element;
+  GstElement *gnlobjs[3];
+  guint prios[3], prio;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = GES_TRACK (ges_video_track_new ());
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  for (i = 0; i < 3; i++) {
+    layers[i] = ges_timeline_append_layer (timeline);
+    clip = GES_CLIP (ges_test_clip_new ());
+    g_object_set (clip, "duration", 10, NULL);
+    fail_unless (ges_layer_add_clip (layers[i], clip));
+    element = ges_clip_find_track_element (clip, track, G_TYPE_NONE);
+    fail_unless (element != NULL);
+    gnlobjs[i] = ges_track_element_get_gnlobject (element);
+    gst_object_unref (element);
+  }
+
+  /* There is no room above the first layer, the layers are spread */
+  top = insert_layer_on_top (timeline);
+  ges_timeline_commit (timeline);
+  for (i = 0; i < 3; i++) {
+    g_object_get (gnlobjs[i], "priority", &prios[i], NULL);
+    assert_equals_int (prios[i], layers[i]->min_gnl_priority);
+    assert_equals_int (ges_layer_get_priority (layers[i]), i + 1);
+    if (i > 0)
+      fail_unless (prios[i - 1] + LAYER_HEIGHT <= prios[i]);
+  }
+  fail_unless (top->min_gnl_priority + LAYER_HEIGHT <= prios[0]);
+
+  /* Now inserting layers on top does not move any existing clip */
+  for (i = 0; i < 10; i++) {
+    GESLayer *new_top = insert_layer_on_top (timeline);
+
+    fail_unless (new_top->min_gnl_priority + LAYER_HEIGHT <=
+        top->min_gnl_priority);
+    top = new_top;
+  }
+  ges_timeline_commit (timeline);
+  for (i = 0; i < 3; i++) {
+    g_object_get (gnlobjs[i], "priority", &prio, NULL);
+    assert_equals_int (prio, prios[i]);
+  }
+
+  /* Moving a layer only moves its own clips */
+  ges_layer_set_priority (layers[0], ges_layer_get_priority (layers[2]) + 1);
+  ges_timeline_commit (timeline);
+  g_object_get (gnlobjs[0], "priority", &prio, NULL);
+  fail_unless (prios[2] + LAYER_HEIGHT <= prio);
+  g_object_get (gnlobjs[1], "priority", &prio, NULL);
+  assert_equals_int (prio, prios[1]);
+  g_object_get (gnlobjs[2], "priority", &prio, NULL);
+  assert_equals_int (prio, prios[2]);
+  fail_unless (g_list_last (timeline->layers)->data == layers[0]);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+/* Returns the source of @composition that is used at @position, as the
+ * composition would stack it, its operations being ignored */
+static GstObject *
+object_at (GstObject * composition, GstClockTime position)
+{
+  GList *tmp;
+  guint priority, best_priority = G_MAXUINT;
+  guint64 start, duration;
+  GstObject *object = NULL;
+
+  for (tmp = GST_BIN_CHILDREN (composition); tmp; tmp = tmp->next) {
+    GstElementFactory *factory = gst_element_get_factory (tmp->data);
+
+    if (!g_strcmp0 (GST_OBJECT_NAME (factory), "gnloperation"))
+      continue;
+
+    g_object_get (tmp->data, "start", &start, "duration", &duration,
+        "priority", &priority, NULL);
+    if (start <= position && position < start + duration &&
+        priority < best_priority) {
+      object = tmp->data;
+      best_priority = priority;
+    }
+  }
+
+  return object;
+}
+
+GST_START_TEST (test_layer_compositions)
+{
+  GESAsset *asset;
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESLayer *layer, *layer1;
+  GESClip *clip, *clip1, *clip2;
+  GESTrackElement *element, *element1, *element2;
+  GstObject *composition, *layer_comp, *layer_comp1, *layer_comp2;
+  gboolean active;
+  guint priority, element_priority;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = GES_TRACK (ges_video_track_new ());
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+  layer1 = ges_timeline_append_layer (timeline);
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = ges_layer_add_asset (layer, asset, 0, 0, 10, GES_TRACK_TYPE_UNKNOWN);
+  clip1 = ges_layer_add_asset (layer1, asset, 5, 0, 10,
+      GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+  element = ges_clip_find_track_element (clip, track, G_TYPE_NONE);
+  element1 = ges_clip_find_track_element (clip1, track, G_TYPE_NONE);
+  ges_timeline_commit (timeline);
+
+  /* By default everything is in the composition of the track */
+  fail_if (ges_track_get_layer_compositions (track));
+  composition = GST_OBJECT_PARENT (ges_track_element_get_gnlobject (element));
+  fail_unless (GST_OBJECT_PARENT (ges_track_element_get_gnlobject (element1))
+      == composition);
+  fail_if (ges_track_set_layer_active (track, layer, FALSE));
+
+  /* One composition per layer, in the composition of the track */
+  ges_track_set_layer_compositions (track, TRUE);
+  fail_unless (ges_track_get_layer_compositions (track));
+  ges_timeline_commit (timeline);
+  layer_comp = GST_OBJECT_PARENT (ges_track_element_get_gnlobject (element));
+  layer_comp1 = GST_OBJECT_PARENT (ges_track_element_get_gnlobject (element1));
+  fail_if (layer_comp == composition);
+  fail_if (layer_comp == layer_comp1);
+  fail_unless (GST_OBJECT_PARENT (layer_comp) == composition);
+  fail_unless (GST_OBJECT_PARENT (layer_comp1) == composition);
+
+  /* The priorities of the compositions follow the ones of the layers */
+  g_object_get (layer_comp, "priority", &priority, NULL);
+  assert_equals_int (priority, layer->min_gnl_priority);
+  g_object_get (layer_comp1, "priority", &priority, NULL);
+  assert_equals_int (priority, layer1->min_gnl_priority);
+
+  /* Reordering the layers only moves their compositions */
+  g_object_get (ges_track_element_get_gnlobject (element), "priority",
+      &element_priority, NULL);
+  ges_layer_set_priority (layer, 1);
+  ges_layer_set_priority (layer1, 0);
+  ges_timeline_commit (timeline);
+  fail_unless (layer1->min_gnl_priority < layer->min_gnl_priority);
+  g_object_get (layer_comp, "priority", &priority, NULL);
+  assert_equals_int (priority, layer->min_gnl_priority);
+  g_object_get (layer_comp1, "priority", &priority, NULL);
+  assert_equals_int (priority, layer1->min_gnl_priority);
+  g_object_get (ges_track_element_get_gnlobject (element), "priority",
+      &priority, NULL);
+  assert_equals_int (priority, element_priority);
+
+  /* Muting a layer only toggles its composition */
+  fail_unless (ges_track_set_layer_active (track, layer1, FALSE));
+  fail_if (ges_track_get_layer_active (track, layer1));
+  fail_unless (ges_track_get_layer_active (track, layer));
+  g_object_get (layer_comp1, "active", &active, NULL);
+  fail_if (active);
+  fail_unless (ges_track_element_is_active (element1));
+  fail_unless (ges_track_set_layer_active (track, layer1, TRUE));
+  fail_unless (ges_track_get_layer_active (track, layer1));
+
+  /* A hole in a layer does not hide the layers below it */
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip2 = ges_layer_add_asset (layer, asset, 20, 0, 10,
+      GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+  element2 = ges_clip_find_track_element (clip2, track, G_TYPE_NONE);
+  ges_timeline_commit (timeline);
+  layer_comp2 = GST_OBJECT_PARENT (ges_track_element_get_gnlobject (element2));
+  fail_if (layer_comp2 == layer_comp);
+  fail_unless (GST_OBJECT_PARENT (layer_comp2) == composition);
+  fail_unless (object_at (composition, 2) == layer_comp);
+  fail_unless (object_at (composition, 12) == layer_comp1);
+  fail_unless (object_at (composition, 22) == layer_comp2);
+
+  /* Filling the hole puts the whole layer back in one composition */
+  ges_timeline_element_set_duration (GES_TIMELINE_ELEMENT (clip), 20);
+  ges_timeline_commit (timeline);
+  fail_unless (GST_OBJECT_PARENT (ges_track_element_get_gnlobject (element))
+      == layer_comp);
+  fail_unless (GST_OBJECT_PARENT (ges_track_element_get_gnlobject (element2))
+      == layer_comp);
+  fail_unless (object_at (composition, 12) == layer_comp);
+  fail_unless (object_at (composition, 22) == layer_comp);
+  gst_object_unref (element2);
+
+  /* Moving a clip moves its element to the composition of its new layer */
+  fail_unless (ges_clip_move_to_layer (clip1, layer));
+  ges_timeline_commit (timeline);
+  fail_unless (GST_OBJECT_PARENT (ges_track_element_get_gnlobject (element1))
+      == layer_comp);
+
+  /* And everything goes back to the composition of the track, all the
+   * layers being active again */
+  fail_unless (ges_track_set_layer_active (track, layer, FALSE));
+  ges_track_set_layer_compositions (track, FALSE);
+  fail_unless (ges_track_get_layer_active (track, layer));
+  ges_timeline_commit (timeline);
+  fail_unless (GST_OBJECT_PARENT (ges_track_element_get_gnlobject (element))
+      == composition);
+  fail_unless (GST_OBJECT_PARENT (ges_track_element_get_gnlobject (element1))
+      == composition);
+
+  /* The elements then follow the base of their layer again */
+  g_object_get (ges_track_element_get_gnlobject (element), "priority",
+      &priority, NULL);
+  assert_equals_int (priority, layer->min_gnl_priority);
+
+  gst_object_unref (element);
+  gst_object_unref (element1);
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_timeline_auto_transition)
 {
   GESAsset *asset;
@@ -1789,6 +2043,8 @@ ges_suite (void)
 
   tcase_add_test (tc_chain, test_layer_properties);
   tcase_add_test (tc_chain, test_layer_priorities);
+  tcase_add_test (tc_chain, test_layer_priorities_sparse);
+  tcase_add_test (tc_chain, test_layer_compositions);
   tcase_add_test (tc_chain, test_timeline_auto_transition);
   tcase_add_test (tc_chain, test_single_layer_automatic_transition);
   tcase_add_test (tc_chain, test_multi_layer_automatic_transition);
@@ -194,6 +194,121 @@ done:
 
 GST_END_TEST;
 
+static gint
+compare_gnl_start (GstElement * a, GstElement * b)
+{
+  guint64 start_a, start_b;
+
+  g_object_get (a, "start", &start_a, NULL);
+  g_object_get (b, "start", &start_b, NULL);
+
+  return start_a < start_b ? -1 : start_a > start_b;
+}
+
+/* Returns the mixing operations of the composition of @track sorted by
+ * start */
+static GList *
+get_mixing_operations (GESTrack * track)
+{
+  GList *tmp, *ret = NULL;
+  GstElement *composition = NULL;
+
+  for (tmp = GST_BIN_CHILDREN (track); tmp; tmp = tmp->next) {
+    GstElementFactory *fac = gst_element_get_factory (tmp->data);
+
+    if (!g_strcmp0 (gst_plugin_feature_get_name (fac), "gnlcomposition"))
+      composition = tmp->data;
+  }
+  fail_unless (composition != NULL);
+
+  for (tmp = GST_BIN_CHILDREN (composition); tmp; tmp = tmp->next) {
+    GstElementFactory *fac = gst_element_get_factory (tmp->data);
+
+    if (!g_strcmp0 (gst_plugin_feature_get_name (fac), "gnloperation"))
+      ret = g_list_insert_sorted (ret, tmp->data,
+          (GCompareFunc) compare_gnl_start);
+  }
+
+  return ret;
+}
+
+GST_START_TEST (region_mixing_test)
+{
+  GList *operations;
+  GESAsset *asset;
+  GESTrack *track;
+  GESLayer *layer, *layer1;
+  GESTimeline *timeline;
+  GESClip *clip;
+  guint64 start, duration;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = GES_TRACK (ges_video_track_new ());
+  ges_track_set_region_mixing (track, TRUE);
+  fail_unless (ges_track_get_region_mixing (track));
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+  layer1 = ges_timeline_append_layer (timeline);
+
+  /* No mixing over the whole track anymore */
+  operations = get_mixing_operations (track);
+  assert_equals_int (g_list_length (operations), 0);
+  g_list_free (operations);
+
+  /**
+   * Our timeline:
+   *
+   * layer:  |__clip__|                |_________|
+   * layer1:      |__clip1__|     |_________|
+   *         0    5   10    15    20   25   30   35
+   */
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  ges_layer_add_asset (layer, asset, 0, 0, 10, GES_TRACK_TYPE_UNKNOWN);
+  ges_layer_add_asset (layer, asset, 25, 0, 10, GES_TRACK_TYPE_UNKNOWN);
+  clip = ges_layer_add_asset (layer1, asset, 5, 0, 10,
+      GES_TRACK_TYPE_UNKNOWN);
+  ges_layer_add_asset (layer1, asset, 20, 0, 10, GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+  ges_timeline_commit (timeline);
+
+  operations = get_mixing_operations (track);
+  assert_equals_int (g_list_length (operations), 2);
+  g_object_get (operations->data, "start", &start, "duration", &duration,
+      NULL);
+  assert_equals_uint64 (start, 5);
+  assert_equals_uint64 (duration, 5);
+  g_object_get (operations->next->data, "start", &start, "duration",
+      &duration, NULL);
+  assert_equals_uint64 (start, 25);
+  assert_equals_uint64 (duration, 5);
+  g_list_free (operations);
+
+  /* clip1 does not overlap anything anymore */
+  ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (clip), 40);
+  ges_timeline_commit (timeline);
+  operations = get_mixing_operations (track);
+  assert_equals_int (g_list_length (operations), 1);
+  g_object_get (operations->data, "start", &start, "duration", &duration,
+      NULL);
+  assert_equals_uint64 (start, 25);
+  assert_equals_uint64 (duration, 5);
+  g_list_free (operations);
+
+  /* Going back to mixing the whole track */
+  ges_track_set_region_mixing (track, FALSE);
+  operations = get_mixing_operations (track);
+  assert_equals_int (g_list_length (operations), 1);
+  g_object_get (operations->data, "start", &start, NULL);
+  assert_equals_uint64 (start, 0);
+  g_list_free (operations);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -206,6 +321,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, simple_smart_adder_test);
   tcase_add_test (tc_chain, simple_audio_mixed_with_pipeline);
   tcase_add_test (tc_chain, audio_video_mixed_with_pipeline);
+  tcase_add_test (tc_chain, region_mixing_test);
 
   return s;
 }
@@ -1481,6 +1481,337 @@ GST_START_TEST (test_scaling)
 
 GST_END_TEST;
 
+GST_START_TEST (test_edit_transaction)
+{
+  GList *clips;
+  GESAsset *asset;
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESTimelineElement *clip, *clip1;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_layer_new ();
+  ges_layer_set_auto_transition (layer, TRUE);
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 0, 0,
+          1000, GES_TRACK_TYPE_UNKNOWN));
+  clip1 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 2000, 0,
+          1000, GES_TRACK_TYPE_UNKNOWN));
+  gst_object_unref (asset);
+  assert_equals_uint64 (ges_timeline_get_duration (timeline), 3000);
+
+  /* Transactions can be nested, nothing happens before the outermost one
+   * is over */
+  ges_timeline_begin_edit (timeline);
+  ges_timeline_begin_edit (timeline);
+  ges_timeline_element_set_start (clip1, 500);
+  DEEP_CHECK (clip1, 500, 0, 1000);
+  ges_timeline_end_edit (timeline);
+
+  clips = ges_layer_get_clips (layer);
+  assert_equals_int (g_list_length (clips), 2);
+  g_list_free_full (clips, gst_object_unref);
+
+  ges_timeline_element_set_duration (clip, 1200);
+  ges_timeline_end_edit (timeline);
+
+  /*
+   *       500_transitions_1200
+   * 0_____________clip______1200
+   *       500_______________clip1_________1500
+   */
+  DEEP_CHECK (clip, 0, 0, 1200);
+  DEEP_CHECK (clip1, 500, 0, 1000);
+  assert_equals_uint64 (ges_timeline_get_duration (timeline), 1500);
+
+  clips = ges_layer_get_clips (layer);
+  assert_equals_int (g_list_length (clips), 4);
+  assert_is_type (clips->next->data, GES_TYPE_TRANSITION_CLIP);
+  assert_equals_uint64 (_START (clips->next->data), 500);
+  assert_equals_uint64 (_DURATION (clips->next->data), 700);
+  g_list_free_full (clips, gst_object_unref);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_range_query)
+{
+  GList *clips;
+  GESAsset *asset;
+  GESTimeline *timeline;
+  GESLayer *layer, *layer1, *layer2;
+  GESTimelineElement *clip, *clip1, *clip2, *clip3, *element;
+  GESTimelineRangeIter iter;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  layer1 = ges_timeline_append_layer (timeline);
+  layer2 = ges_timeline_append_layer (timeline);
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 0, 0,
+          10, GES_TRACK_TYPE_UNKNOWN));
+  clip1 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 20, 0,
+          10, GES_TRACK_TYPE_UNKNOWN));
+  clip2 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer1, asset, 5, 0,
+          30, GES_TRACK_TYPE_UNKNOWN));
+  clip3 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer2, asset, 12, 0,
+          2, GES_TRACK_TYPE_UNKNOWN));
+  gst_object_unref (asset);
+
+  /**
+   * Our timeline:
+   *
+   * layer:  |__clip__|    |__clip1__|
+   *         0        10   20        30
+   * layer1:     |_______clip2_________|
+   *             5                     35
+   * layer2:            |c3|
+   *                    12 14
+   */
+  clips = ges_timeline_get_elements_in_range (timeline, 11, 19, 0, G_MAXUINT);
+  assert_equals_int (g_list_length (clips), 2);
+  fail_unless (clips->data == clip2);
+  fail_unless (clips->next->data == clip3);
+  g_list_free_full (clips, gst_object_unref);
+
+  clips = ges_timeline_get_elements_in_range (timeline, 0, 20, 0, 0);
+  assert_equals_int (g_list_length (clips), 2);
+  fail_unless (clips->data == clip);
+  fail_unless (clips->next->data == clip1);
+  g_list_free_full (clips, gst_object_unref);
+
+  clips = ges_timeline_get_elements_in_range (timeline, 36, 100, 0, 2);
+  fail_unless (clips == NULL);
+
+  /* The index follows the clips when they move */
+  ges_timeline_element_set_start (clip1, 40);
+  ges_clip_move_to_layer (GES_CLIP (clip), layer2);
+
+  ges_timeline_range_iter_init (&iter, timeline, 8, 50, 0, 1);
+  fail_unless (ges_timeline_range_iter_next (&iter, &element));
+  fail_unless (element == clip1);
+  fail_unless (ges_timeline_range_iter_next (&iter, &element));
+  fail_unless (element == clip2);
+  fail_if (ges_timeline_range_iter_next (&iter, &element));
+
+  ges_timeline_range_iter_init (&iter, timeline, 0, 12, 2, 2);
+  fail_unless (ges_timeline_range_iter_next (&iter, &element));
+  fail_unless (element == clip);
+  fail_unless (ges_timeline_range_iter_next (&iter, &element));
+  fail_unless (element == clip3);
+  fail_if (ges_timeline_range_iter_next (&iter, &element));
+
+  ges_layer_remove_clip (layer2, GES_CLIP (clip3));
+  clips = ges_timeline_get_elements_in_range (timeline, 12, 14, 2, 2);
+  assert_equals_int (g_list_length (clips), 0);
+
+  /* All the layers sharing a priority are looked into */
+  ges_layer_set_priority (layer, 1);
+  clips = ges_timeline_get_elements_in_range (timeline, 0, 100, 1, 1);
+  assert_equals_int (g_list_length (clips), 2);
+  g_list_free_full (clips, gst_object_unref);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+#define CHECK_PREVIEW_ENTRY(preview, elem, start, duration, layer_prio)     \
+{                                                                              \
+  guint i;                                                                     \
+  GESEditPreviewEntry *entry = NULL;                                           \
+                                                                               \
+  for (i = 0; i < preview->entries->len; i++) {                                \
+    if (g_array_index (preview->entries, GESEditPreviewEntry, i).element ==    \
+        GES_TIMELINE_ELEMENT (elem))                                           \
+      entry = &g_array_index (preview->entries, GESEditPreviewEntry, i);       \
+  }                                                                            \
+                                                                               \
+  fail_unless (entry != NULL);                                                 \
+  assert_equals_uint64 (entry->start, start);                                  \
+  assert_equals_uint64 (entry->duration, duration);                            \
+  assert_equals_int (entry->layer_priority, layer_prio);                       \
+}
+
+GST_START_TEST (test_edit_preview)
+{
+  GESAsset *asset;
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESEditPreview *preview, *copy;
+  GESTimelineElement *clip, *clip1, *clip2;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 0, 0,
+          10, GES_TRACK_TYPE_UNKNOWN));
+  clip1 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 10, 0,
+          10, GES_TRACK_TYPE_UNKNOWN));
+  clip2 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 30, 0,
+          10, GES_TRACK_TYPE_UNKNOWN));
+  gst_object_unref (asset);
+
+  /**
+   * Our timeline:
+   *
+   * layer:  |__clip__|__clip1__|        |__clip2__|
+   *         0        10        20       30        40
+   */
+  preview = ges_timeline_preview_edit (timeline, GES_CLIP (clip), -1,
+      GES_EDIT_MODE_RIPPLE, GES_EDGE_END, 15);
+  fail_unless (preview != NULL);
+  fail_if (preview->snapped);
+  assert_equals_int (preview->entries->len, 3);
+  CHECK_PREVIEW_ENTRY (preview, clip, 0, 15, 0);
+  CHECK_PREVIEW_ENTRY (preview, clip1, 15, 10, 0);
+  CHECK_PREVIEW_ENTRY (preview, clip2, 35, 10, 0);
+  ges_edit_preview_free (preview);
+
+  /* Nothing moved */
+  DEEP_CHECK (clip, 0, 0, 10);
+  DEEP_CHECK (clip1, 10, 0, 10);
+  DEEP_CHECK (clip2, 30, 0, 10);
+
+  preview = ges_timeline_preview_edit (timeline, GES_CLIP (clip), -1,
+      GES_EDIT_MODE_ROLL, GES_EDGE_END, 12);
+  fail_unless (preview != NULL);
+  assert_equals_int (preview->entries->len, 2);
+  CHECK_PREVIEW_ENTRY (preview, clip, 0, 12, 0);
+  CHECK_PREVIEW_ENTRY (preview, clip1, 12, 8, 0);
+  ges_edit_preview_free (preview);
+
+  /* Rolling further than the end of clip1 is not possible */
+  fail_unless (ges_timeline_preview_edit (timeline, GES_CLIP (clip), -1,
+          GES_EDIT_MODE_ROLL, GES_EDGE_END, 25) == NULL);
+
+  /* The real edit does what the preview said */
+  fail_unless (ges_container_edit (GES_CONTAINER (clip), NULL, -1,
+          GES_EDIT_MODE_RIPPLE, GES_EDGE_END, 15));
+  DEEP_CHECK (clip, 0, 0, 15);
+  DEEP_CHECK (clip1, 15, 0, 10);
+  DEEP_CHECK (clip2, 35, 0, 10);
+
+  /* Previewing in the middle of a drag does not disturb it, and previews
+   * can be copied */
+  preview = ges_timeline_preview_edit (timeline, GES_CLIP (clip1), -1,
+      GES_EDIT_MODE_ROLL, GES_EDGE_START, 18);
+  fail_unless (preview != NULL);
+  copy = ges_edit_preview_copy (preview);
+  ges_edit_preview_free (preview);
+  assert_equals_int (copy->entries->len, 2);
+  CHECK_PREVIEW_ENTRY (copy, clip, 0, 18, 0);
+  CHECK_PREVIEW_ENTRY (copy, clip1, 18, 7, 0);
+  ges_edit_preview_free (copy);
+  fail_unless (ges_container_edit (GES_CONTAINER (clip), NULL, -1,
+          GES_EDIT_MODE_RIPPLE, GES_EDGE_END, 17));
+  DEEP_CHECK (clip, 0, 0, 17);
+  DEEP_CHECK (clip1, 17, 0, 10);
+  DEEP_CHECK (clip2, 37, 0, 10);
+  fail_unless (ges_container_edit (GES_CONTAINER (clip), NULL, -1,
+          GES_EDIT_MODE_RIPPLE, GES_EDGE_END, 15));
+
+  /* Snapping and moving to another layer */
+  ges_timeline_set_snapping_distance (timeline, 3);
+  preview = ges_timeline_preview_edit (timeline, GES_CLIP (clip2), 1,
+      GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, 27);
+  fail_unless (preview != NULL);
+  fail_unless (preview->snapped);
+  assert_equals_uint64 (preview->snap_time, 25);
+  fail_unless (GES_TIMELINE_ELEMENT_PARENT (preview->snapped_element) ==
+      clip1);
+  assert_equals_int (preview->entries->len, 1);
+  CHECK_PREVIEW_ENTRY (preview, clip2, 25, 10, 1);
+  ges_edit_preview_free (preview);
+  DEEP_CHECK (clip2, 35, 0, 10);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_move_context_reuse)
+{
+  GESAsset *asset;
+  GESTimeline *timeline;
+  GESLayer *layer, *layer1;
+  GESTimelineElement *clip, *clip1, *clip2, *clip3;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  layer1 = ges_timeline_append_layer (timeline);
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 0, 0,
+          10, GES_TRACK_TYPE_UNKNOWN));
+  clip1 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 10, 0,
+          10, GES_TRACK_TYPE_UNKNOWN));
+  clip2 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 30, 0,
+          10, GES_TRACK_TYPE_UNKNOWN));
+  clip3 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer1, asset, 30, 0,
+          10, GES_TRACK_TYPE_UNKNOWN));
+  gst_object_unref (asset);
+
+  /**
+   * Our timeline:
+   *
+   * layer:  |__clip__|__clip1__|        |__clip2__|
+   * layer1:                             |__clip3__|
+   *         0        10        20       30        40
+   */
+  fail_unless (ges_container_edit (GES_CONTAINER (clip), NULL, -1,
+          GES_EDIT_MODE_RIPPLE, GES_EDGE_END, 15));
+  DEEP_CHECK (clip, 0, 0, 15);
+  DEEP_CHECK (clip1, 15, 0, 10);
+  DEEP_CHECK (clip2, 35, 0, 10);
+  DEEP_CHECK (clip3, 35, 0, 10);
+
+  /* Committing in the middle of the drag must not break it */
+  ges_timeline_commit (timeline);
+  fail_unless (ges_container_edit (GES_CONTAINER (clip), NULL, -1,
+          GES_EDIT_MODE_RIPPLE, GES_EDGE_END, 12));
+  DEEP_CHECK (clip, 0, 0, 12);
+  DEEP_CHECK (clip1, 12, 0, 10);
+  DEEP_CHECK (clip2, 32, 0, 10);
+  DEEP_CHECK (clip3, 32, 0, 10);
+
+  /* clip3 now is before the rippled edge and must not be moved anymore */
+  ges_timeline_element_set_start (clip3, 2);
+  fail_unless (ges_container_edit (GES_CONTAINER (clip), NULL, -1,
+          GES_EDIT_MODE_RIPPLE, GES_EDGE_END, 14));
+  DEEP_CHECK (clip, 0, 0, 14);
+  DEEP_CHECK (clip1, 14, 0, 10);
+  DEEP_CHECK (clip2, 34, 0, 10);
+  DEEP_CHECK (clip3, 2, 0, 10);
+
+  /* And moved again once it is back after it */
+  ges_timeline_element_set_start (clip3, 40);
+  fail_unless (ges_container_edit (GES_CONTAINER (clip), NULL, -1,
+          GES_EDIT_MODE_RIPPLE, GES_EDGE_END, 10));
+  DEEP_CHECK (clip, 0, 0, 10);
+  DEEP_CHECK (clip1, 10, 0, 10);
+  DEEP_CHECK (clip2, 30, 0, 10);
+  DEEP_CHECK (clip3, 36, 0, 10);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -1496,6 +1827,10 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_groups);
   tcase_add_test (tc_chain, test_snapping_groups);
   tcase_add_test (tc_chain, test_scaling);
+  tcase_add_test (tc_chain, test_edit_transaction);
+  tcase_add_test (tc_chain, test_range_query);
+  tcase_add_test (tc_chain, test_edit_preview);
+  tcase_add_test (tc_chain, test_move_context_reuse);
 
   return s;
 }
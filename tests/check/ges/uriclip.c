@@ -266,6 +266,77 @@ GST_START_TEST (test_filesource_images)
 GST_END_TEST;
 
 
+static GstElement *
+find_uridecodebin (GESTrackElement * source)
+{
+  GList *tmp;
+  GstElement *gnlobject = ges_track_element_get_gnlobject (source);
+
+  if (GST_BIN_CHILDREN (gnlobject) == NULL)
+    return NULL;
+
+  for (tmp = GST_BIN_CHILDREN (GST_BIN_CHILDREN (gnlobject)->data); tmp;
+      tmp = tmp->next) {
+    GstElementFactory *factory = gst_element_get_factory (tmp->data);
+
+    if (!g_strcmp0 (GST_OBJECT_NAME (factory), "uridecodebin"))
+      return tmp->data;
+  }
+
+  return NULL;
+}
+
+GST_START_TEST (test_filesource_recycling)
+{
+  GESAsset *asset;
+  GESTrack *track;
+  AssetUri asset_uri;
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESClip *clip, *clip1;
+  GstElement *decodebin;
+  GESTrackElement *source, *source1;
+
+  ges_init ();
+
+  track = GES_TRACK (ges_audio_track_new ());
+  ges_track_set_instantiation_window (track, GST_SECOND);
+  layer = ges_layer_new ();
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  mainloop = g_main_loop_new (NULL, FALSE);
+  asset_uri.uri = av_uri;
+  g_timeout_add (1, (GSourceFunc) create_asset, &asset_uri);
+  g_main_loop_run (mainloop);
+  g_main_loop_unref (mainloop);
+
+  asset = asset_uri.asset;
+  fail_unless (GES_IS_ASSET (asset));
+  clip = ges_layer_add_asset (layer, asset, 0, 0, GST_SECOND,
+      GES_TRACK_TYPE_UNKNOWN);
+  clip1 = ges_layer_add_asset (layer, asset, 100 * GST_SECOND, 0, GST_SECOND,
+      GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+  ges_timeline_commit (timeline);
+
+  source = GES_CONTAINER_CHILDREN (clip)->data;
+  source1 = GES_CONTAINER_CHILDREN (clip1)->data;
+  decodebin = find_uridecodebin (source);
+  fail_unless (decodebin != NULL);
+  fail_unless (find_uridecodebin (source1) == NULL);
+
+  /* The second clip reuses the uridecodebin released by the first one */
+  ges_track_update_instantiation (track, 100 * GST_SECOND);
+  fail_unless (find_uridecodebin (source) == NULL);
+  fail_unless (find_uridecodebin (source1) == decodebin);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -277,6 +348,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_filesource_basic);
   tcase_add_test (tc_chain, test_filesource_images);
   tcase_add_test (tc_chain, test_filesource_properties);
+  tcase_add_test (tc_chain, test_filesource_recycling);
 
   return s;
 }